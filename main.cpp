@@ -1,57 +1,204 @@
 // Necessary header files for input output functions
 #include "fsfw/objectmanager.h"
+#include "fsfw/objectmanager/frameworkObjects.h"
+#include "fsfw/pus/Service3Housekeeping.h"
 #include "fsfw/tasks/TaskFactory.h"
 
 #include "mission/ObjectFactory.h"
+#include "mission/tasks/DeviceHandlerSchedule.h"
+#include "mission/tasks/EventDrivenTask.h"
+#include "mission/tasks/ThreadPolicy.h"
+#include "mission/tasks/TimedExecutable.h"
+#include "mission/tasks/WorkStealingExecutor.h"
+#include "mission/timing/TaskTimingService.h"
+#include "mission/webcam/WebcamComIF.h"
+#include "mission/webcam/WebcamCookie.h"
 #include "mission/webcam/WebcamDeviceHandler.h"
+#include "mission/tmtc/TcLoadGenerator.h"
 #include "mission/tmtc/TmtcInfrastructure.h"
 #include "mission/tmtc/WebcamCommandingService.h"
 #include "mission/webcam/WebcamDefinitions.h"
 
 #include <chrono>
+#include <memory>
+#include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 using namespace std;
 
+// How the webcam handlers are scheduled:
+// fixedTimeslot: deterministic, the communication steps are spread over a period of one frame
+// eventDriven: a full cycle as soon as a frame or a command arrives, the period only paces
+// housekeeping
+enum class WebcamScheduling { fixedTimeslot, eventDriven };
+constexpr WebcamScheduling WEBCAM_SCHEDULING = WebcamScheduling::fixedTimeslot;
+// Execution time, deadline misses and jitter per task component, sent as TM by the task
+// timing service and logged periodically
+constexpr bool TASK_TIMING_ENABLED = true;
+// Workers of the work stealing pool running the TMTC components in parallel, TM report output
+// is offloaded to it as well. Off by default: 0 runs them one after another in a periodic task.
+constexpr unsigned TMTC_WORKERS = 0;
+// TC load generator instead of the example TCs: drives the PUS distributor with a subservice
+// mix at increasing rates and reports throughput, verification and TM latency and the
+// saturation point of the commanding chain. The TMTC components then run every 2 ms.
+constexpr bool LOAD_GENERATOR_ENABLED = false;
+constexpr double TMTC_PERIOD_S = LOAD_GENERATOR_ENABLED ? 0.002 : 1.0;
+// Capture threads and handler tasks run SCHED_FIFO on the upper half of the cores, TMTC, JPEG
+// encoding and disk I/O stay on the lower half. Memory is locked and the real time stacks are
+// prefaulted. Off by default: needs CAP_SYS_NICE and CAP_IPC_LOCK or matching rlimits,
+// otherwise a warning is printed and the threads keep the normal policy.
+constexpr bool REALTIME_ENABLED = false;
+constexpr int CAPTURE_PRIORITY = 80;
+constexpr int HANDLER_PRIORITY = 70;
+// Below this the cores are shared, only policy and memory locking apply
+constexpr unsigned MIN_CORES_FOR_ISOLATION = 4;
+
 // main() function: where the execution of
 // C++ program begins
 int main() {
+    // One entry per camera, each gets its own handler task so a stalled device can not hold
+    // up the others
+    const std::vector<CameraConfig> cameras = {
+        {"/dev/video0", 30.0},
+        // Hardware free load test of the whole capture -> handler -> service -> TM chain:
+        // {"synthetic://1920x1080@120/yuyv?pattern=noise", 120.0},
+    };
+
     auto* objectManager = ObjectManager::instance();
-    ObjectFactory::createMissionObjects();
+    ObjectFactory::createMissionObjects(cameras);
     objectManager->initialize();
 
-    auto* webcamHandler = objectManager->get<WebcamDeviceHandler>(webcam::objectIdWebcamHandler);
     auto* webcamService = objectManager->get<webcam::WebcamCommandingService>(webcam::objectIdWebcamCommandingService);
     auto* telemetrySink = objectManager->get<webcam::StubTelemetrySink>(webcam::objectIdWebcamTelemetrySink);
     auto* verificationSink = objectManager->get<webcam::StubVerificationReceiver>(webcam::objectIdWebcamVerificationSink);
     auto* pusDistributor = objectManager->get<webcam::StubPusDistributor>(webcam::objectIdWebcamTcDistributor);
-    (void)webcamHandler;
-    (void)webcamService;
+    auto* housekeepingService = objectManager->get<Service3Housekeeping>(objects::PUS_SERVICE_3_HOUSEKEEPING);
+    auto* taskTimingService = objectManager->get<timing::TaskTimingService>(webcam::objectIdTaskTimingService);
+    auto* webcamComIF = objectManager->get<WebcamComIF>(webcam::objectIdWebcamComIF);
+
+    tasks::ThreadPolicy capturePolicy;
+    tasks::ThreadPolicy handlerPolicy;
+    tasks::ThreadPolicy backgroundPolicy;
+    if (REALTIME_ENABLED) {
+        // The pools are allocated at this point and get locked and faulted in right away,
+        // everything mapped later is locked on first use
+        tasks::lockProcessMemory();
+        const unsigned cores = std::thread::hardware_concurrency();
+        const unsigned realtimeCores = cores >= MIN_CORES_FOR_ISOLATION ? cores / 2 : 0;
+        const uint64_t realtimeCpus = tasks::ThreadPolicy::cpuRange(cores - realtimeCores, realtimeCores);
+        const uint64_t backgroundCpus = realtimeCores > 0 ? tasks::ThreadPolicy::cpuRange(0, cores - realtimeCores) : 0;
+        capturePolicy = tasks::ThreadPolicy::realtime(CAPTURE_PRIORITY, realtimeCpus);
+        handlerPolicy = tasks::ThreadPolicy::realtime(HANDLER_PRIORITY, realtimeCpus);
+        backgroundPolicy = tasks::ThreadPolicy::background(backgroundCpus);
+    }
+    if (webcamComIF != nullptr) {webcamComIF->setCapturePolicy(capturePolicy);}
+    if (webcamService != nullptr) {webcamService->setBackgroundPolicy(backgroundPolicy);}
 
     auto* taskFactory = TaskFactory::instance();
     auto priority = 0;
-    PeriodicTaskIF* webcamTask = taskFactory->createPeriodicTask("WEBCAM_TASK", priority, PeriodicTaskIF::MINIMUM_STACK_SIZE, 1.0, nullptr);
-    webcamTask->addComponent(webcam::objectIdWebcamHandler);
-    webcamTask->startTask();
-
-    PeriodicTaskIF* tmtcTask = taskFactory->createPeriodicTask("TMTC_TASK", priority, PeriodicTaskIF::MINIMUM_STACK_SIZE, 1.0, nullptr);
-    if (webcamService != nullptr) {tmtcTask->addComponent(webcam::objectIdWebcamCommandingService);}
-    if (telemetrySink != nullptr) {tmtcTask->addComponent(webcam::objectIdWebcamTelemetrySink);}
-    if (verificationSink != nullptr) {tmtcTask->addComponent(webcam::objectIdWebcamVerificationSink);}
+    std::vector<std::unique_ptr<tasks::EventDrivenTask>> webcamTasks;
+    std::vector<std::string> webcamTaskNames;
+    // Kept alive for the tasks, reserved so the name pointers stay valid
+    webcamTaskNames.reserve(cameras.size());
+    for (uint8_t camera = 0; camera < cameras.size() && camera < webcam::MAX_CAMERAS; camera++) {
+        const object_id_t handlerId = webcam::handlerObjectId(camera);
+        auto* handler = objectManager->get<WebcamDeviceHandler>(handlerId);
+        auto* cookie = objectManager->get<WebcamCookie>(webcam::cookieObjectId(camera));
+        if (handler == nullptr) {
+            continue;
+        }
+        webcamTaskNames.push_back("WEBCAM_TASK_" + std::to_string(camera));
+
+        if (WEBCAM_SCHEDULING == WebcamScheduling::fixedTimeslot) {
+            // One frame per period, offsets can be set per step instead of evenly spread
+            const double frameRate = cameras[camera].frameRate > 0.0 ? cameras[camera].frameRate : 10.0;
+            const auto periodMs = static_cast<uint32_t>(1000.0 / frameRate);
+            const tasks::DeviceHandlerSlots slots = tasks::DeviceHandlerSlots::evenlySpread(periodMs);
+            FixedTimeslotTaskIF* webcamTask = tasks::createDeviceHandlerTask(webcamTaskNames.back().c_str(), priority, handlerId, slots, TASK_TIMING_ENABLED);
+            if (webcamTask == nullptr) {
+                continue;
+            }
+            if (!handlerPolicy.isDefault()) {
+                webcamTask->addSlot(objects::NO_OBJECT, tasks::ThreadPolicyApplier::create(handlerPolicy, webcamTaskNames.back().c_str()), 0, 0);
+            }
+            const auto offsets = slots.offsets();
+            handler->configureSlotJitter(slots.periodMs, offsets.data(), offsets.size());
+            webcamTask->startTask();
+            continue;
+        }
+
+        auto webcamTask = std::make_unique<tasks::EventDrivenTask>(webcamTaskNames.back(), 1.0);
+        webcamTask->setThreadPolicy(handlerPolicy);
+        webcamTask->addWakeupFd(handler->getWakeupFd());
+        if (cookie != nullptr) {
+            webcamTask->addWakeupFd(cookie->getFrameEventFd());
+        }
+        // One full communication cycle per wakeup, without a period there is no deadline
+        const std::pair<uint8_t, const char*> steps[] = {
+            {DeviceHandlerIF::PERFORM_OPERATION, "operation"}, {DeviceHandlerIF::SEND_WRITE, "sendWrite"},
+            {DeviceHandlerIF::GET_WRITE, "getWrite"}, {DeviceHandlerIF::SEND_READ, "sendRead"},
+            {DeviceHandlerIF::GET_READ, "getRead"}};
+        for (const auto& step : steps) {
+            ExecutableObjectIF* component = handler;
+            if (TASK_TIMING_ENABLED) {
+                component = tasks::TimedExecutable::wrap(handler, webcamTaskNames.back() + "/" + step.second, 0, 0);
+            }
+            webcamTask->addComponent(component, step.first);
+        }
+        webcamTask->startTask();
+        webcamTasks.push_back(std::move(webcamTask));
+    }
+
+    std::unique_ptr<tasks::WorkStealingExecutor> tmtcExecutor;
+    PeriodicTaskIF* tmtcTask = nullptr;
+    if (TMTC_WORKERS > 0) {
+        tmtcExecutor = std::make_unique<tasks::WorkStealingExecutor>("TMTC_TASK", TMTC_PERIOD_S, TMTC_WORKERS);
+        tmtcExecutor->setThreadPolicy(backgroundPolicy);
+        tmtcTask = tmtcExecutor.get();
+        if (telemetrySink != nullptr) {telemetrySink->setExecutor(tmtcExecutor.get());}
+    } else {
+        tmtcTask = taskFactory->createPeriodicTask("TMTC_TASK", priority, PeriodicTaskIF::MINIMUM_STACK_SIZE, TMTC_PERIOD_S, nullptr);
+        if (!backgroundPolicy.isDefault()) {tmtcTask->addComponent(tasks::ThreadPolicyApplier::create(backgroundPolicy, "TMTC_TASK"));}
+    }
+    // Each component may use the whole period of the task
+    auto addTmtcComponent = [&](object_id_t component, const char* name) {
+        if (TASK_TIMING_ENABLED) {
+            tmtcTask->addComponent(tasks::TimedExecutable::wrap(component, std::string("TMTC_TASK/") + name,
+                                                                tmtcTask->getPeriodMs(), tmtcTask->getPeriodMs() * 1000));
+        } else {
+            tmtcTask->addComponent(component);
+        }
+    };
+    if (webcamService != nullptr) {addTmtcComponent(webcam::objectIdWebcamCommandingService, "service");}
+    if (housekeepingService != nullptr) {addTmtcComponent(objects::PUS_SERVICE_3_HOUSEKEEPING, "hk");}
+    if (telemetrySink != nullptr) {addTmtcComponent(webcam::objectIdWebcamTelemetrySink, "tmSink");}
+    if (verificationSink != nullptr) {addTmtcComponent(webcam::objectIdWebcamVerificationSink, "verification");}
+    if (TASK_TIMING_ENABLED && taskTimingService != nullptr) {addTmtcComponent(webcam::objectIdTaskTimingService, "taskTiming");}
+    // Installs its callbacks in the sinks, so it is created before the TMTC task starts
+    std::unique_ptr<webcam::TcLoadGenerator> loadGenerator;
+    if (LOAD_GENERATOR_ENABLED && pusDistributor != nullptr && verificationSink != nullptr && telemetrySink != nullptr) {
+        loadGenerator = std::make_unique<webcam::TcLoadGenerator>(*pusDistributor, *verificationSink, *telemetrySink);
+    }
     tmtcTask->startTask();
 
     using namespace std::chrono_literals;
     bool commandsQueued = false;
     while (true) {
+        if (!commandsQueued && loadGenerator != nullptr) {
+            loadGenerator->run(webcam::TcLoadGenerator::Config{});
+            commandsQueued = true;
+        }
         if (!commandsQueued && pusDistributor != nullptr) {
+            using Subservice = webcam::WebcamCommandingService::Subservice;
             double newFrameRate = 24.0;
-            pusDistributor->sendCommand(
-                static_cast<uint8_t>(webcam::WebcamCommandingService::Subservice::COMMAND_SET_FRAME_RATE),
-                reinterpret_cast<const uint8_t*>(&newFrameRate), sizeof(newFrameRate));
-            pusDistributor->sendCommand(
-                static_cast<uint8_t>(webcam::WebcamCommandingService::Subservice::COMMAND_GET_FRAME_RATE));
-            pusDistributor->sendCommand(
-                static_cast<uint8_t>(webcam::WebcamCommandingService::Subservice::PARAMETER_DUMP));
+            const webcam::StubPusDistributor::Telecommand commands[] = {
+                {static_cast<uint8_t>(Subservice::COMMAND_SET_FRAME_RATE),
+                 reinterpret_cast<const uint8_t*>(&newFrameRate), sizeof(newFrameRate)},
+                {static_cast<uint8_t>(Subservice::COMMAND_GET_FRAME_RATE)},
+                {static_cast<uint8_t>(Subservice::PARAMETER_DUMP)}};
+            pusDistributor->sendCommands(commands, sizeof(commands) / sizeof(commands[0]));
             commandsQueued = true;
         }
         std::this_thread::sleep_for(1s);
@@ -15,46 +15,119 @@
 
 #include "ObjectFactory.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 #include <fsfw/objectmanager/frameworkObjects.h>
-#include <fsfw/storagemanager/LocalPool.h>
+#include <fsfw/pus/Service3Housekeeping.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+#include <fsfw/storagemanager/PoolManager.h>
 #include <fsfw/timemanager/CdsShortTimeStamper.h>
 #include <fsfw/tmtcservices/VerificationReporter.h>
 #include "webcam/WebcamDeviceHandler.h"
 #include "mission/tmtc/TmtcInfrastructure.h"
+#include "mission/timing/TaskTimingService.h"
 #include "mission/tmtc/WebcamCommandingService.h"
+#include "mission/webcam/FramePool.h"
+#include "mission/webcam/SyntheticCamera.h"
 #include "mission/webcam/WebcamComIF.h"
 #include "mission/webcam/WebcamCookie.h"
 #include "mission/webcam/WebcamDefinitions.h"
 
 namespace {
-    std::unique_ptr<LocalPool> ipcStore;
-    std::unique_ptr<LocalPool> tcStore;
-    std::unique_ptr<LocalPool> tmStore;
+    std::unique_ptr<PoolManager> ipcStore;
+    std::unique_ptr<webcam::TcPoolManager> tcStore;
+    std::unique_ptr<PoolManager> tmStore;
     std::unique_ptr<CdsShortTimeStamper> timeStamper;
     std::unique_ptr<VerificationReporter> verificationReporter;
     std::unique_ptr<webcam::StubTelemetrySink> telemetrySink;
     std::unique_ptr<webcam::StubVerificationReceiver> verificationReceiver;
     std::unique_ptr<webcam::StubPusDistributor> pusDistributor;
     std::unique_ptr<WebcamComIF> webcamComIF;
-    std::unique_ptr<WebcamCookie> webcamCookie;
-    std::unique_ptr<WebcamDeviceHandler> webcamHandler;
+    std::unique_ptr<webcam::FramePool> framePool;
+    std::vector<std::unique_ptr<WebcamDeviceHandler>> webcamHandlers;
     std::unique_ptr<webcam::WebcamCommandingService> webcamService;
+    std::unique_ptr<Service3Housekeeping> housekeepingService;
+    std::unique_ptr<timing::TaskTimingService> taskTimingService;
     bool serviceRegistered = false;
+    bool housekeepingRegistered = false;
+    bool taskTimingRegistered = false;
 }
 
-void ObjectFactory::createMissionObjects() {
+namespace {
+    // Every camera gets its own cookie, handler and capture thread in the shared ComIF. The
+    // capture rings of all cameras are reserved first, so the frame pool is allocated once.
+    void createCameras(const std::vector<CameraConfig> &cameras) {
+        const size_t cameraCount = std::min<size_t>(cameras.size(), webcam::MAX_CAMERAS);
+        if (cameras.size() > cameraCount) {
+            sif::printWarning("ObjectFactory: Only %u cameras supported, ignoring %zu\n",
+                              static_cast<unsigned int>(webcam::MAX_CAMERAS),
+                              cameras.size() - cameraCount);
+        }
+        framePool = std::make_unique<webcam::FramePool>();
+        std::vector<size_t> slices(cameraCount);
+        for (size_t camera = 0; camera < cameraCount; camera++) {
+            const CameraConfig &config = cameras[camera];
+            if (config.sharedPool) {
+                // A synthetic source delivers the resolution of its path, whatever was requested
+                webcam::SyntheticCamera::Config synthetic;
+                const bool isSynthetic = webcam::SyntheticCamera::parse(config.devicePath, synthetic);
+                slices[camera] = framePool->reserve(isSynthetic ? synthetic.width : config.width,
+                                                    isSynthetic ? synthetic.height : config.height,
+                                                    config.bufferCount);
+            }
+        }
+        const bool poolReady =
+            framePool->getSize() > 0 && framePool->allocate() == returnvalue::OK;
+
+        for (size_t camera = 0; camera < cameraCount; camera++) {
+            const CameraConfig &config = cameras[camera];
+            const auto index = static_cast<uint8_t>(camera);
+            auto cookie = std::make_unique<WebcamCookie>(
+                config.devicePath, config.frameRate, config.width, config.height,
+                config.pixelFormat, config.bufferCount, webcam::cookieObjectId(index));
+            if (poolReady && config.sharedPool) {
+                const webcam::FramePool::Slice slice = framePool->getSlice(slices[camera]);
+                cookie->setUserPointerMode(slice.start, slice.size);
+            }
+            auto handler = std::make_unique<WebcamDeviceHandler>(
+                webcam::handlerObjectId(index), webcam::objectIdWebcamComIF, cookie.release(),
+                nullptr, 20);
+            // Open the device and start streaming right after initialization
+            handler->setStartUpImmediately();
+            webcamHandlers.push_back(std::move(handler));
+        }
+    }
+}
+
+LocalPool::LocalPoolConfig ObjectFactory::getStoreConfig(object_id_t store) {
+    switch (store) {
+        case objects::IPC_STORE:
+            return {{40, 32}, {20, 64}, {10, 128}};
+        case objects::TC_STORE:
+            return {{20, 256}, {10, 512}};
+        case objects::TM_STORE:
+            // 1 KiB pages for the image segments of service 200, one per segment of the
+            // largest image product
+            return {{20, 256}, {10, 512}, {64, 1024}};
+        default:
+            return {};
+    }
+}
+
+void ObjectFactory::createMissionObjects(const std::vector<CameraConfig> &cameras) {
     if (ipcStore == nullptr) {
-        LocalPool::LocalPoolConfig ipcCfg = {{40, 32}, {20, 64}, {10, 128}};
-        ipcStore = std::make_unique<LocalPool>(objects::IPC_STORE, ipcCfg, true, true);
+        // The stores are shared by the handler tasks and the TMTC workers, PoolManager
+        // serializes the accesses with a mutex
+        ipcStore = std::make_unique<PoolManager>(objects::IPC_STORE, getStoreConfig(objects::IPC_STORE));
     }
     if (tcStore == nullptr) {
-        LocalPool::LocalPoolConfig tcCfg = {{20, 256}, {10, 512}};
-        tcStore = std::make_unique<LocalPool>(objects::TC_STORE, tcCfg, true, true);
+        // Reserves whole command sequences under one lock, see StubPusDistributor::sendCommands()
+        tcStore = std::make_unique<webcam::TcPoolManager>(objects::TC_STORE,
+                                                          getStoreConfig(objects::TC_STORE));
     }
     if (tmStore == nullptr) {
-        LocalPool::LocalPoolConfig tmCfg = {{20, 256}, {10, 512}};
-        tmStore = std::make_unique<LocalPool>(objects::TM_STORE, tmCfg, true, true);
+        tmStore = std::make_unique<PoolManager>(objects::TM_STORE, getStoreConfig(objects::TM_STORE));
     }
     if (timeStamper == nullptr) {
         timeStamper = std::make_unique<CdsShortTimeStamper>(objects::TIME_STAMPER);
@@ -81,13 +154,8 @@ void ObjectFactory::createMissionObjects() {
         webcamComIF = std::make_unique<WebcamComIF>(
             webcam::objectIdWebcamComIF);
     }
-    if (webcamCookie == nullptr && webcamHandler == nullptr) {
-        webcamCookie = std::make_unique<WebcamCookie>("/dev/video0", 30.0);
-    }
-    if (webcamHandler == nullptr && webcamCookie != nullptr) {
-        webcamHandler = std::make_unique<WebcamDeviceHandler>(
-        webcam::objectIdWebcamHandler, webcam::objectIdWebcamComIF,
-        webcamCookie.release(), nullptr, 20);
+    if (webcamHandlers.empty()) {
+        createCameras(cameras);
     }
     if (webcamService == nullptr) {
         if (verificationReporter != nullptr) {
@@ -100,8 +168,31 @@ void ObjectFactory::createMissionObjects() {
         webcamService->setPacketSource(webcam::objectIdWebcamTcDistributor);
         webcamService->setPacketDestination(webcam::objectIdWebcamTelemetrySink);
     }
+    if (housekeepingService == nullptr) {
+        // Receives the periodic HK packets of the device handlers, e.g. the frame statistics
+        housekeepingService = std::make_unique<Service3Housekeeping>(
+            objects::PUS_SERVICE_3_HOUSEKEEPING, webcam::WebcamCommandingService::APID, 3);
+        housekeepingService->setPacketSource(webcam::objectIdWebcamTcDistributor);
+        housekeepingService->setPacketDestination(webcam::objectIdWebcamTelemetrySink);
+    }
+    if (taskTimingService == nullptr) {
+        // Independent of the cameras, publishes whatever main() instrumented
+        taskTimingService = std::make_unique<timing::TaskTimingService>(
+            webcam::objectIdTaskTimingService, webcam::WebcamCommandingService::APID,
+            verificationReporter.get());
+        taskTimingService->setPacketSource(webcam::objectIdWebcamTcDistributor);
+        taskTimingService->setPacketDestination(webcam::objectIdWebcamTelemetrySink);
+    }
     if (pusDistributor != nullptr && webcamService != nullptr && !serviceRegistered) {
         pusDistributor->registerService(webcamService.get());
         serviceRegistered = true;
     }
+    if (pusDistributor != nullptr && housekeepingService != nullptr && !housekeepingRegistered) {
+        pusDistributor->registerService(housekeepingService.get());
+        housekeepingRegistered = true;
+    }
+    if (pusDistributor != nullptr && taskTimingService != nullptr && !taskTimingRegistered) {
+        pusDistributor->registerService(taskTimingService.get());
+        taskTimingRegistered = true;
+    }
 }
\ No newline at end of file
@@ -15,7 +15,29 @@
 
 #pragma once
 
+#include <fsfw/storagemanager/LocalPool.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// One entry per camera, the index in the list is the camera index of webcam::handlerObjectId()
+struct CameraConfig {
+    // V4L2 device or a synthetic source, see webcam::SyntheticCamera
+    std::string devicePath;
+    double frameRate = 30.0;
+    uint32_t width = 640;
+    uint32_t height = 480;
+    uint32_t pixelFormat = 0;  // 0 keeps the driver setting
+    uint32_t bufferCount = 4;
+    // Capture into the shared frame pool, otherwise into driver allocated buffers
+    bool sharedPool = true;
+};
+
 class ObjectFactory {
 public:
-    static void createMissionObjects();
-};
\ No newline at end of file
+    static void createMissionObjects(
+        const std::vector<CameraConfig> &cameras = {CameraConfig{"/dev/video0"}});
+    // Page counts and sizes of the IPC, TC and TM stores, empty for any other object
+    static LocalPool::LocalPoolConfig getStoreConfig(object_id_t store);
+};
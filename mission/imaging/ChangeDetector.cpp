@@ -0,0 +1,169 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "ChangeDetector.h"
+
+#include "ColorConversion.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IMAGING_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace imaging {
+    namespace {
+        uint64_t sadScalar(const uint8_t *a, const uint8_t *b, size_t count) {
+            uint64_t sum = 0;
+            for (size_t i = 0; i < count; i++) {
+                sum += a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+            }
+            return sum;
+        }
+
+#if IMAGING_X86
+        uint64_t sadSse2(const uint8_t *a, const uint8_t *b, size_t count) {
+            // psadbw leaves two 16 bit sums in the 64 bit lanes
+            __m128i sum = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+                const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+                sum = _mm_add_epi64(sum, _mm_sad_epu8(va, vb));
+            }
+            alignas(16) uint64_t lanes[2];
+            _mm_store_si128(reinterpret_cast<__m128i *>(lanes), sum);
+            return lanes[0] + lanes[1] + sadScalar(a + i, b + i, count - i);
+        }
+
+        __attribute__((target("avx2"))) uint64_t sadAvx2(const uint8_t *a, const uint8_t *b,
+                                                         size_t count) {
+            __m256i sum = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 32 <= count; i += 32) {
+                const __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+                const __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+                sum = _mm256_add_epi64(sum, _mm256_sad_epu8(va, vb));
+            }
+            alignas(32) uint64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), sum);
+            return lanes[0] + lanes[1] + lanes[2] + lanes[3] + sadSse2(a + i, b + i, count - i);
+        }
+#endif  // IMAGING_X86
+
+#if defined(__ARM_NEON)
+        uint64_t sadNeon(const uint8_t *a, const uint8_t *b, size_t count) {
+            uint32x4_t sum = vdupq_n_u32(0);
+            size_t i = 0;
+            while (i + 16 <= count) {
+                // 16 bit lanes hold at most 128 pairwise sums of 255 before they overflow
+                uint16x8_t partial = vdupq_n_u16(0);
+                for (int block = 0; block < 128 && i + 16 <= count; block++, i += 16) {
+                    partial = vpadalq_u8(partial, vabdq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+                }
+                sum = vpadalq_u16(sum, partial);
+            }
+            // vaddvq_u32 is AArch64 only, the pairwise widening add also builds for ARMv7
+            const uint64x2_t total = vpaddlq_u32(sum);
+            return vgetq_lane_u64(total, 0) + vgetq_lane_u64(total, 1) +
+                   sadScalar(a + i, b + i, count - i);
+        }
+#endif  // __ARM_NEON
+    }  // namespace
+
+    uint64_t sumOfAbsoluteDifferences(const uint8_t *a, const uint8_t *b, size_t count) {
+        switch (activeBackend()) {
+#if IMAGING_X86
+            case Backend::sse2:
+                return sadSse2(a, b, count);
+            case Backend::avx2:
+                return sadAvx2(a, b, count);
+#endif
+#if defined(__ARM_NEON)
+            case Backend::neon:
+                return sadNeon(a, b, count);
+#endif
+            default:
+                return sadScalar(a, b, count);
+        }
+    }
+
+    ChangeDetector::ChangeDetector(uint32_t factor)
+        : factor(factor > 0 && factor <= ImageScaler::MAX_FACTOR ? factor : DEFAULT_FACTOR) {}
+
+    bool ChangeDetector::evaluateYuyv(const uint8_t *frame, uint32_t width, uint32_t height,
+                                      double threshold, Result &result) {
+        result = Result{};
+        const ScaledImage expected = ImageScaler::scaledSize(width, height, Region{}, factor);
+        thumbnail.resize(expected.size);
+        ScaledImage image;
+        if (!scaler.scaleYuyv(frame, width, height, Region{}, factor, thumbnail.data(),
+                              thumbnail.size(), image)) {
+            return false;
+        }
+        compare(image, threshold, result);
+        return true;
+    }
+
+    bool ChangeDetector::evaluateMjpeg(const uint8_t *jpeg, size_t size, double threshold,
+                                       Result &result) {
+        result = Result{};
+        ScaledImage image;
+        if (!scaler.scaleMjpeg(jpeg, size, Region{}, factor, thumbnail.data(), thumbnail.size(),
+                               image)) {
+            // The frame size is only known from the header, grow once and try again
+            if (image.size == 0 || image.size <= thumbnail.size()) {
+                return false;
+            }
+            thumbnail.resize(image.size);
+            if (!scaler.scaleMjpeg(jpeg, size, Region{}, factor, thumbnail.data(),
+                                   thumbnail.size(), image)) {
+                return false;
+            }
+        }
+        compare(image, threshold, result);
+        return true;
+    }
+
+    void ChangeDetector::reset() {
+        referenceWidth = 0;
+        referenceHeight = 0;
+    }
+
+    void ChangeDetector::compare(const ScaledImage &image, double threshold, Result &result) {
+        const size_t samples = static_cast<size_t>(image.width) * image.height;
+        luma.resize(samples);
+        for (size_t i = 0; i < samples; i++) {
+            luma[i] = thumbnail[2 * i];
+        }
+
+        if (image.width != referenceWidth || image.height != referenceHeight) {
+            result.changed = true;
+            result.meanDifference = 255.0;
+        } else {
+            const uint64_t sad = sumOfAbsoluteDifferences(luma.data(), reference.data(), samples);
+            result.meanDifference = static_cast<double>(sad) / static_cast<double>(samples);
+            result.changed = result.meanDifference >= threshold;
+        }
+        if (result.changed) {
+            reference.swap(luma);
+            referenceWidth = image.width;
+            referenceHeight = image.height;
+        }
+    }
+
+}  // namespace imaging
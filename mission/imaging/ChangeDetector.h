@@ -0,0 +1,66 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ImageScaler.h"
+
+namespace imaging {
+
+    // Sum of |a[i] - b[i]|, SSE2/AVX2/NEON through the backend of ColorConversion.h
+    uint64_t sumOfAbsoluteDifferences(const uint8_t *a, const uint8_t *b, size_t count);
+
+    /*
+     * Cheap scene change detection for streaming. The luma of every frame is box filtered
+     * down by the factor (ImageScaler, so MJPEG only needs the DC coefficients) and compared
+     * against a reference with a SAD. The mean absolute difference per sample is compared
+     * with the threshold; a changed frame becomes the new reference, so slow drift is still
+     * reported once it adds up. Not thread safe.
+     */
+    class ChangeDetector {
+    public:
+        static constexpr uint32_t DEFAULT_FACTOR = 8;
+
+        struct Result {
+            bool changed = true;
+            double meanDifference = 0.0;  // per downsampled luma sample, 0..255
+        };
+
+        explicit ChangeDetector(uint32_t factor = DEFAULT_FACTOR);
+
+        // Return false if the frame could not be evaluated, the result then reports a change
+        bool evaluateYuyv(const uint8_t *frame, uint32_t width, uint32_t height, double threshold,
+                          Result &result);
+        bool evaluateMjpeg(const uint8_t *jpeg, size_t size, double threshold, Result &result);
+        // The next frame becomes the reference
+        void reset();
+
+    private:
+        void compare(const ScaledImage &image, double threshold, Result &result);
+
+        uint32_t factor;
+        ImageScaler scaler;
+        std::vector<uint8_t> thumbnail;
+        std::vector<uint8_t> luma;
+        std::vector<uint8_t> reference;
+        uint32_t referenceWidth = 0;
+        uint32_t referenceHeight = 0;
+    };
+
+}  // namespace imaging
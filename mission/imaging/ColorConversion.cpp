@@ -0,0 +1,488 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "ColorConversion.h"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IMAGING_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace imaging {
+    namespace {
+        // BT.601 coefficients of the old routine in Q14
+        constexpr int FIXED_SHIFT = 14;
+        constexpr int32_t COEFF_RV = 22970;   // 1.402
+        constexpr int32_t COEFF_GU = -5638;   // -0.344136
+        constexpr int32_t COEFF_GV = -11700;  // -0.714136
+        constexpr int32_t COEFF_BU = 29032;   // 1.772
+
+        using RowKernel = void (*)(const uint8_t *src, uint8_t *dst, uint32_t width);
+        using Nv12RowKernel = void (*)(const uint8_t *src0, const uint8_t *src1, uint8_t *y0,
+                                       uint8_t *y1, uint8_t *uv, uint32_t width);
+
+        struct Kernels {
+            RowKernel rgb24Row;
+            RowKernel y8Row;
+            Nv12RowKernel nv12RowPair;
+        };
+
+        inline uint8_t clampToByte(int32_t value) {
+            return static_cast<uint8_t>(value < 0 ? 0 : (value > 255 ? 255 : value));
+        }
+
+        inline void convertPixelPair(const uint8_t *src, uint8_t *dst) {
+            const int32_t u = src[1] - 128;
+            const int32_t v = src[3] - 128;
+            const int32_t rc = COEFF_RV * v;
+            const int32_t gc = COEFF_GU * u + COEFF_GV * v;
+            const int32_t bc = COEFF_BU * u;
+            const int32_t y0 = src[0] << FIXED_SHIFT;
+            const int32_t y1 = src[2] << FIXED_SHIFT;
+            // >> on negative values is an arithmetic shift (floor) on all our targets
+            dst[0] = clampToByte((y0 + rc) >> FIXED_SHIFT);
+            dst[1] = clampToByte((y0 + gc) >> FIXED_SHIFT);
+            dst[2] = clampToByte((y0 + bc) >> FIXED_SHIFT);
+            dst[3] = clampToByte((y1 + rc) >> FIXED_SHIFT);
+            dst[4] = clampToByte((y1 + gc) >> FIXED_SHIFT);
+            dst[5] = clampToByte((y1 + bc) >> FIXED_SHIFT);
+        }
+
+        void rgb24RowScalar(const uint8_t *src, uint8_t *dst, uint32_t width) {
+            for (uint32_t x = 0; x < width; x += 2) {
+                convertPixelPair(src, dst);
+                src += 4;
+                dst += 6;
+            }
+        }
+
+        void y8RowScalar(const uint8_t *src, uint8_t *dst, uint32_t width) {
+            for (uint32_t x = 0; x < width; x++) {
+                dst[x] = src[2 * x];
+            }
+        }
+
+        void nv12RowPairScalar(const uint8_t *src0, const uint8_t *src1, uint8_t *y0,
+                               uint8_t *y1, uint8_t *uv, uint32_t width) {
+            for (uint32_t x = 0; x < width; x++) {
+                y0[x] = src0[2 * x];
+                y1[x] = src1[2 * x];
+                // 4:2:2 -> 4:2:0 by averaging the chroma of both rows, rounded up like pavg
+                uv[x] = static_cast<uint8_t>((src0[2 * x + 1] + src1[2 * x + 1] + 1) >> 1);
+            }
+        }
+
+#if IMAGING_X86
+        inline int32_t packCoefficients(int32_t coeffU, int32_t coeffV) {
+            // pmaddwd operand for interleaved (u, v) int16 pairs
+            return static_cast<int32_t>((static_cast<uint32_t>(static_cast<uint16_t>(coeffV)) << 16) |
+                                        static_cast<uint16_t>(coeffU));
+        }
+
+        void rgb24RowSse2(const uint8_t *src, uint8_t *dst, uint32_t width) {
+            const __m128i lowByteMask = _mm_set1_epi16(0x00ff);
+            const __m128i chromaBias = _mm_set1_epi16(128);
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i coeffR = _mm_set1_epi32(packCoefficients(0, COEFF_RV));
+            const __m128i coeffG = _mm_set1_epi32(packCoefficients(COEFF_GU, COEFF_GV));
+            const __m128i coeffB = _mm_set1_epi32(packCoefficients(COEFF_BU, 0));
+            alignas(16) uint8_t planes[3][16];
+
+            uint32_t x = 0;
+            for (; x + 8 <= width; x += 8) {
+                const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+                const __m128i luma = _mm_and_si128(in, lowByteMask);
+                const __m128i chroma = _mm_sub_epi16(_mm_srli_epi16(in, 8), chromaBias);
+                const __m128i yLo = _mm_slli_epi32(_mm_unpacklo_epi16(luma, zero), FIXED_SHIFT);
+                const __m128i yHi = _mm_slli_epi32(_mm_unpackhi_epi16(luma, zero), FIXED_SHIFT);
+                const __m128i coeffs[3] = {coeffR, coeffG, coeffB};
+                for (int channel = 0; channel < 3; channel++) {
+                    // one chroma term per pixel pair, duplicated for both pixels
+                    const __m128i term = _mm_madd_epi16(chroma, coeffs[channel]);
+                    const __m128i lo = _mm_srai_epi32(
+                        _mm_add_epi32(yLo, _mm_unpacklo_epi32(term, term)), FIXED_SHIFT);
+                    const __m128i hi = _mm_srai_epi32(
+                        _mm_add_epi32(yHi, _mm_unpackhi_epi32(term, term)), FIXED_SHIFT);
+                    const __m128i packed = _mm_packus_epi16(_mm_packs_epi32(lo, hi), zero);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(planes[channel]), packed);
+                }
+                // SSE2 has no byte shuffle, interleave the three planes in scalar code
+                for (int pixel = 0; pixel < 8; pixel++) {
+                    dst[3 * pixel] = planes[0][pixel];
+                    dst[3 * pixel + 1] = planes[1][pixel];
+                    dst[3 * pixel + 2] = planes[2][pixel];
+                }
+                src += 16;
+                dst += 24;
+            }
+            rgb24RowScalar(src, dst, width - x);
+        }
+
+        void y8RowSse2(const uint8_t *src, uint8_t *dst, uint32_t width) {
+            const __m128i lowByteMask = _mm_set1_epi16(0x00ff);
+            uint32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                const __m128i in0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+                const __m128i in1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+                const __m128i luma = _mm_packus_epi16(_mm_and_si128(in0, lowByteMask),
+                                                      _mm_and_si128(in1, lowByteMask));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), luma);
+                src += 32;
+                dst += 16;
+            }
+            y8RowScalar(src, dst, width - x);
+        }
+
+        void nv12RowPairSse2(const uint8_t *src0, const uint8_t *src1, uint8_t *y0, uint8_t *y1,
+                             uint8_t *uv, uint32_t width) {
+            const __m128i lowByteMask = _mm_set1_epi16(0x00ff);
+            uint32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                const __m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src0));
+                const __m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src0 + 16));
+                const __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src1));
+                const __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src1 + 16));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(y0 + x),
+                                 _mm_packus_epi16(_mm_and_si128(a0, lowByteMask),
+                                                  _mm_and_si128(a1, lowByteMask)));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(y1 + x),
+                                 _mm_packus_epi16(_mm_and_si128(b0, lowByteMask),
+                                                  _mm_and_si128(b1, lowByteMask)));
+                // chroma is already in NV12 order (u0 v0 u1 v1 ...) once extracted
+                const __m128i chroma0 = _mm_avg_epu16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(b0, 8));
+                const __m128i chroma1 = _mm_avg_epu16(_mm_srli_epi16(a1, 8), _mm_srli_epi16(b1, 8));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(uv + x),
+                                 _mm_packus_epi16(chroma0, chroma1));
+                src0 += 32;
+                src1 += 32;
+            }
+            nv12RowPairScalar(src0, src1, y0 + x, y1 + x, uv + x, width - x);
+        }
+
+        __attribute__((target("avx2"))) void rgb24RowAvx2(const uint8_t *src, uint8_t *dst,
+                                                          uint32_t width) {
+            const __m256i lowByteMask = _mm256_set1_epi16(0x00ff);
+            const __m256i chromaBias = _mm256_set1_epi16(128);
+            const __m256i zero = _mm256_setzero_si256();
+            const __m256i maxByte = _mm256_set1_epi16(255);
+            const __m256i coeffR = _mm256_set1_epi32(packCoefficients(0, COEFF_RV));
+            const __m256i coeffG = _mm256_set1_epi32(packCoefficients(COEFF_GU, COEFF_GV));
+            const __m256i coeffB = _mm256_set1_epi32(packCoefficients(COEFF_BU, 0));
+            // RGBx -> RGB within each 128 bit lane, the last four bytes are don't care
+            const __m256i compact = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1,
+                                                     -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13,
+                                                     14, -1, -1, -1, -1);
+
+            uint32_t x = 0;
+            // Each 12 byte group is written with a 16 byte store, keep two pixels of slack
+            for (; x + 18 <= width; x += 16) {
+                const __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+                const __m256i luma = _mm256_and_si256(in, lowByteMask);
+                const __m256i chroma = _mm256_sub_epi16(_mm256_srli_epi16(in, 8), chromaBias);
+                const __m256i yLo =
+                    _mm256_slli_epi32(_mm256_unpacklo_epi16(luma, zero), FIXED_SHIFT);
+                const __m256i yHi =
+                    _mm256_slli_epi32(_mm256_unpackhi_epi16(luma, zero), FIXED_SHIFT);
+                const __m256i coeffs[3] = {coeffR, coeffG, coeffB};
+                __m256i channels[3];
+                for (int channel = 0; channel < 3; channel++) {
+                    const __m256i term = _mm256_madd_epi16(chroma, coeffs[channel]);
+                    const __m256i lo = _mm256_srai_epi32(
+                        _mm256_add_epi32(yLo, _mm256_unpacklo_epi32(term, term)), FIXED_SHIFT);
+                    const __m256i hi = _mm256_srai_epi32(
+                        _mm256_add_epi32(yHi, _mm256_unpackhi_epi32(term, term)), FIXED_SHIFT);
+                    // 16 bit per pixel in pixel order (within the lanes), clamped to a byte
+                    channels[channel] = _mm256_min_epi16(
+                        _mm256_max_epi16(_mm256_packs_epi32(lo, hi), zero), maxByte);
+                }
+                const __m256i rg = _mm256_or_si256(channels[0], _mm256_slli_epi16(channels[1], 8));
+                const __m256i rgbxLo =
+                    _mm256_shuffle_epi8(_mm256_unpacklo_epi16(rg, channels[2]), compact);
+                const __m256i rgbxHi =
+                    _mm256_shuffle_epi8(_mm256_unpackhi_epi16(rg, channels[2]), compact);
+                // lane 0 holds pixels 0-7, lane 1 pixels 8-15
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst),
+                                 _mm256_castsi256_si128(rgbxLo));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 12),
+                                 _mm256_castsi256_si128(rgbxHi));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 24),
+                                 _mm256_extracti128_si256(rgbxLo, 1));
+                _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + 36),
+                                 _mm256_extracti128_si256(rgbxHi, 1));
+                src += 32;
+                dst += 48;
+            }
+            rgb24RowScalar(src, dst, width - x);
+        }
+
+        __attribute__((target("avx2"))) void y8RowAvx2(const uint8_t *src, uint8_t *dst,
+                                                       uint32_t width) {
+            const __m256i lowByteMask = _mm256_set1_epi16(0x00ff);
+            uint32_t x = 0;
+            for (; x + 32 <= width; x += 32) {
+                const __m256i in0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src));
+                const __m256i in1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 32));
+                const __m256i luma = _mm256_packus_epi16(_mm256_and_si256(in0, lowByteMask),
+                                                         _mm256_and_si256(in1, lowByteMask));
+                // packus works per lane, restore the pixel order
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst),
+                                    _mm256_permute4x64_epi64(luma, 0xd8));
+                src += 64;
+                dst += 32;
+            }
+            y8RowSse2(src, dst, width - x);
+        }
+
+        __attribute__((target("avx2"))) void nv12RowPairAvx2(const uint8_t *src0,
+                                                             const uint8_t *src1, uint8_t *y0,
+                                                             uint8_t *y1, uint8_t *uv,
+                                                             uint32_t width) {
+            const __m256i lowByteMask = _mm256_set1_epi16(0x00ff);
+            uint32_t x = 0;
+            for (; x + 32 <= width; x += 32) {
+                const __m256i a0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src0));
+                const __m256i a1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src0 + 32));
+                const __m256i b0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src1));
+                const __m256i b1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src1 + 32));
+                const __m256i lumaA = _mm256_packus_epi16(_mm256_and_si256(a0, lowByteMask),
+                                                          _mm256_and_si256(a1, lowByteMask));
+                const __m256i lumaB = _mm256_packus_epi16(_mm256_and_si256(b0, lowByteMask),
+                                                          _mm256_and_si256(b1, lowByteMask));
+                const __m256i chroma0 =
+                    _mm256_avg_epu16(_mm256_srli_epi16(a0, 8), _mm256_srli_epi16(b0, 8));
+                const __m256i chroma1 =
+                    _mm256_avg_epu16(_mm256_srli_epi16(a1, 8), _mm256_srli_epi16(b1, 8));
+                const __m256i chroma = _mm256_packus_epi16(chroma0, chroma1);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(y0 + x),
+                                    _mm256_permute4x64_epi64(lumaA, 0xd8));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(y1 + x),
+                                    _mm256_permute4x64_epi64(lumaB, 0xd8));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(uv + x),
+                                    _mm256_permute4x64_epi64(chroma, 0xd8));
+                src0 += 64;
+                src1 += 64;
+            }
+            nv12RowPairSse2(src0, src1, y0 + x, y1 + x, uv + x, width - x);
+        }
+#endif  // IMAGING_X86
+
+#if defined(__ARM_NEON)
+        // Fixed point conversion of four pixels, luma and the matching chroma terms as int32
+        inline uint8x8_t neonChannel(int32x4_t yLo, int32x4_t yHi, int32x4_t termLo,
+                                     int32x4_t termHi) {
+            const int16x4_t lo = vqmovn_s32(vshrq_n_s32(vaddq_s32(yLo, termLo), FIXED_SHIFT));
+            const int16x4_t hi = vqmovn_s32(vshrq_n_s32(vaddq_s32(yHi, termHi), FIXED_SHIFT));
+            return vqmovun_s16(vcombine_s16(lo, hi));
+        }
+
+        inline int32x4_t neonLuma(uint16x4_t luma) {
+            return vshlq_n_s32(vreinterpretq_s32_u32(vmovl_u16(luma)), FIXED_SHIFT);
+        }
+
+        void rgb24RowNeon(const uint8_t *src, uint8_t *dst, uint32_t width) {
+            uint32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                // 8 pixel pairs: y0[8] u[8] y1[8] v[8]
+                const uint8x8x4_t in = vld4_u8(src);
+                const int16x8_t u = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(in.val[1])),
+                                              vdupq_n_s16(128));
+                const int16x8_t v = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(in.val[3])),
+                                              vdupq_n_s16(128));
+                const uint16x8_t yEven = vmovl_u8(in.val[0]);
+                const uint16x8_t yOdd = vmovl_u8(in.val[2]);
+                const int32x4_t yEvenLo = neonLuma(vget_low_u16(yEven));
+                const int32x4_t yEvenHi = neonLuma(vget_high_u16(yEven));
+                const int32x4_t yOddLo = neonLuma(vget_low_u16(yOdd));
+                const int32x4_t yOddHi = neonLuma(vget_high_u16(yOdd));
+
+                const int32x4_t rLo = vmull_n_s16(vget_low_s16(v), COEFF_RV);
+                const int32x4_t rHi = vmull_n_s16(vget_high_s16(v), COEFF_RV);
+                const int32x4_t gLo = vmlal_n_s16(vmull_n_s16(vget_low_s16(u), COEFF_GU),
+                                                  vget_low_s16(v), COEFF_GV);
+                const int32x4_t gHi = vmlal_n_s16(vmull_n_s16(vget_high_s16(u), COEFF_GU),
+                                                  vget_high_s16(v), COEFF_GV);
+                const int32x4_t bLo = vmull_n_s16(vget_low_s16(u), COEFF_BU);
+                const int32x4_t bHi = vmull_n_s16(vget_high_s16(u), COEFF_BU);
+
+                // even and odd pixels are zipped back together by vst3 of the zipped planes
+                const uint8x8x2_t r = vzip_u8(neonChannel(yEvenLo, yEvenHi, rLo, rHi),
+                                              neonChannel(yOddLo, yOddHi, rLo, rHi));
+                const uint8x8x2_t g = vzip_u8(neonChannel(yEvenLo, yEvenHi, gLo, gHi),
+                                              neonChannel(yOddLo, yOddHi, gLo, gHi));
+                const uint8x8x2_t b = vzip_u8(neonChannel(yEvenLo, yEvenHi, bLo, bHi),
+                                              neonChannel(yOddLo, yOddHi, bLo, bHi));
+                uint8x16x3_t out;
+                out.val[0] = vcombine_u8(r.val[0], r.val[1]);
+                out.val[1] = vcombine_u8(g.val[0], g.val[1]);
+                out.val[2] = vcombine_u8(b.val[0], b.val[1]);
+                vst3q_u8(dst, out);
+                src += 32;
+                dst += 48;
+            }
+            rgb24RowScalar(src, dst, width - x);
+        }
+
+        void y8RowNeon(const uint8_t *src, uint8_t *dst, uint32_t width) {
+            uint32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                vst1q_u8(dst, vld2q_u8(src).val[0]);
+                src += 32;
+                dst += 16;
+            }
+            y8RowScalar(src, dst, width - x);
+        }
+
+        void nv12RowPairNeon(const uint8_t *src0, const uint8_t *src1, uint8_t *y0, uint8_t *y1,
+                             uint8_t *uv, uint32_t width) {
+            uint32_t x = 0;
+            for (; x + 16 <= width; x += 16) {
+                const uint8x16x2_t a = vld2q_u8(src0);
+                const uint8x16x2_t b = vld2q_u8(src1);
+                vst1q_u8(y0 + x, a.val[0]);
+                vst1q_u8(y1 + x, b.val[0]);
+                vst1q_u8(uv + x, vrhaddq_u8(a.val[1], b.val[1]));
+                src0 += 32;
+                src1 += 32;
+            }
+            nv12RowPairScalar(src0, src1, y0 + x, y1 + x, uv + x, width - x);
+        }
+#endif  // __ARM_NEON
+
+        const Kernels &kernelsFor(Backend backend) {
+            static const Kernels scalarKernels{rgb24RowScalar, y8RowScalar, nv12RowPairScalar};
+#if IMAGING_X86
+            static const Kernels sse2Kernels{rgb24RowSse2, y8RowSse2, nv12RowPairSse2};
+            static const Kernels avx2Kernels{rgb24RowAvx2, y8RowAvx2, nv12RowPairAvx2};
+#endif
+#if defined(__ARM_NEON)
+            static const Kernels neonKernels{rgb24RowNeon, y8RowNeon, nv12RowPairNeon};
+#endif
+            switch (backend) {
+#if IMAGING_X86
+                case Backend::sse2:
+                    return sse2Kernels;
+                case Backend::avx2:
+                    return avx2Kernels;
+#endif
+#if defined(__ARM_NEON)
+                case Backend::neon:
+                    return neonKernels;
+#endif
+                default:
+                    return scalarKernels;
+            }
+        }
+
+        std::atomic<Backend> &selectedBackend() {
+            static std::atomic<Backend> backend{detectBackend()};
+            return backend;
+        }
+
+        const Kernels &activeKernels() {
+            return kernelsFor(selectedBackend().load(std::memory_order_relaxed));
+        }
+    }  // namespace
+
+    const char *backendToString(Backend backend) {
+        switch (backend) {
+            case Backend::scalar:
+                return "scalar";
+            case Backend::sse2:
+                return "SSE2";
+            case Backend::avx2:
+                return "AVX2";
+            case Backend::neon:
+                return "NEON";
+        }
+        return "unknown";
+    }
+
+    bool isBackendSupported(Backend backend) {
+        switch (backend) {
+            case Backend::scalar:
+                return true;
+#if IMAGING_X86
+            case Backend::sse2:
+                return __builtin_cpu_supports("sse2");
+            case Backend::avx2:
+                return __builtin_cpu_supports("avx2");
+#endif
+#if defined(__ARM_NEON)
+            case Backend::neon:
+                return true;
+#endif
+            default:
+                return false;
+        }
+    }
+
+    Backend detectBackend() {
+        const Backend candidates[] = {Backend::avx2, Backend::neon, Backend::sse2};
+        for (Backend candidate : candidates) {
+            if (isBackendSupported(candidate)) {
+                return candidate;
+            }
+        }
+        return Backend::scalar;
+    }
+
+    Backend activeBackend() { return selectedBackend().load(); }
+
+    bool setBackend(Backend backend) {
+        if (!isBackendSupported(backend)) {
+            return false;
+        }
+        selectedBackend().store(backend);
+        return true;
+    }
+
+    void yuyvToRgb24(const uint8_t *yuyv, uint8_t *rgb, uint32_t width, uint32_t height) {
+        const RowKernel rowKernel = activeKernels().rgb24Row;
+        for (uint32_t row = 0; row < height; row++) {
+            rowKernel(yuyv + static_cast<size_t>(row) * width * 2,
+                      rgb + static_cast<size_t>(row) * width * 3, width);
+        }
+    }
+
+    void yuyvToY8(const uint8_t *yuyv, uint8_t *y8, uint32_t width, uint32_t height) {
+        const RowKernel rowKernel = activeKernels().y8Row;
+        for (uint32_t row = 0; row < height; row++) {
+            rowKernel(yuyv + static_cast<size_t>(row) * width * 2,
+                      y8 + static_cast<size_t>(row) * width, width);
+        }
+    }
+
+    void yuyvToNv12(const uint8_t *yuyv, uint8_t *yPlane, uint8_t *uvPlane, uint32_t width,
+                    uint32_t height) {
+        const Nv12RowKernel rowKernel = activeKernels().nv12RowPair;
+        const size_t srcStride = static_cast<size_t>(width) * 2;
+        for (uint32_t row = 0; row + 1 < height; row += 2) {
+            const uint8_t *src = yuyv + row * srcStride;
+            rowKernel(src, src + srcStride, yPlane + static_cast<size_t>(row) * width,
+                      yPlane + static_cast<size_t>(row + 1) * width,
+                      uvPlane + static_cast<size_t>(row / 2) * width, width);
+        }
+    }
+
+    void yuyvToNv12(const uint8_t *yuyv, uint8_t *nv12, uint32_t width, uint32_t height) {
+        yuyvToNv12(yuyv, nv12, nv12 + y8Size(width, height), width, height);
+    }
+
+}  // namespace imaging
@@ -0,0 +1,69 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * YUYV (4:2:2) conversion kernels. All backends use the same Q14 fixed point
+ * arithmetic, so SSE2, AVX2 and NEON are bit-exact with the portable scalar path.
+ * Compared to the old double precision routine of test/webcam.cpp an output byte
+ * may differ by at most one.
+ *
+ * Frames are tightly packed (stride = width * bytes per pixel), width must be even
+ * and for NV12 the height must be even as well.
+ */
+namespace imaging {
+
+    enum class Backend : uint8_t {
+        scalar = 0,
+        sse2 = 1,
+        avx2 = 2,
+        neon = 3,
+    };
+
+    const char *backendToString(Backend backend);
+
+    // Best backend the CPU supports, this is what is used by default
+    Backend detectBackend();
+    Backend activeBackend();
+    bool isBackendSupported(Backend backend);
+    // Returns false and keeps the current backend if the CPU does not support it
+    bool setBackend(Backend backend);
+
+    inline constexpr size_t yuyvSize(uint32_t width, uint32_t height) {
+        return static_cast<size_t>(width) * height * 2;
+    }
+    inline constexpr size_t rgb24Size(uint32_t width, uint32_t height) {
+        return static_cast<size_t>(width) * height * 3;
+    }
+    inline constexpr size_t y8Size(uint32_t width, uint32_t height) {
+        return static_cast<size_t>(width) * height;
+    }
+    inline constexpr size_t nv12Size(uint32_t width, uint32_t height) {
+        return static_cast<size_t>(width) * height * 3 / 2;
+    }
+
+    void yuyvToRgb24(const uint8_t *yuyv, uint8_t *rgb, uint32_t width, uint32_t height);
+    void yuyvToY8(const uint8_t *yuyv, uint8_t *y8, uint32_t width, uint32_t height);
+    // NV12 with separate planes, uvPlane holds width * height / 2 interleaved UV bytes
+    void yuyvToNv12(const uint8_t *yuyv, uint8_t *yPlane, uint8_t *uvPlane, uint32_t width,
+                    uint32_t height);
+    // NV12 with the UV plane directly behind the Y plane
+    void yuyvToNv12(const uint8_t *yuyv, uint8_t *nv12, uint32_t width, uint32_t height);
+
+}  // namespace imaging
@@ -0,0 +1,119 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "ExposureController.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace imaging {
+
+    void ExposureController::configure(const Limits &newLimits, const Setting &setting) {
+        limits = newLimits;
+        limits.exposureMin = std::max<int32_t>(limits.exposureMin, 1);
+        limits.exposureMax = std::max(limits.exposureMax, limits.exposureMin);
+        limits.gainMax = std::max(limits.gainMax, limits.gainMin);
+        current = setting;
+        configured = true;
+        pending = false;
+        settling = false;
+    }
+
+    void ExposureController::reset() {
+        configured = false;
+        pending = false;
+        settling = false;
+    }
+
+    void ExposureController::setTarget(uint8_t newTarget) {
+        target = std::clamp<uint8_t>(newTarget, TOLERANCE + 1, 255 - TOLERANCE - 1);
+    }
+
+    void ExposureController::setFrameRate(double newFrameRate) { frameRate = newFrameRate; }
+
+    bool ExposureController::update(uint32_t sequence, const ImageStatistics::Result &statistics,
+                                    Setting &next) {
+        if (!configured || pending) {
+            return false;
+        }
+        if (settling) {
+            // Sequence numbers wrap, compare the distance
+            if (static_cast<int32_t>(sequence - settleUntilSequence) < 0) {
+                return false;
+            }
+            settling = false;
+        }
+
+        double measured = statistics.mean;
+        // A bright mean with clipped highlights is still too bright
+        if (statistics.saturatedRatio > SATURATION_LIMIT) {
+            measured = std::max(measured, static_cast<double>(target) + 2 * TOLERANCE);
+        }
+        if (std::fabs(measured - target) <= TOLERANCE) {
+            return false;
+        }
+
+        const double ratio =
+            std::clamp(std::pow(target / std::max(measured, 1.0), RESPONSE_EXPONENT),
+                       1.0 / MAX_STEP, MAX_STEP);
+        const double brightness = current.exposure * gainFactor(current.gain) * ratio;
+
+        // Exposure first, the rest with gain
+        const int32_t maxExposure = exposureLimit();
+        next.exposure = static_cast<int32_t>(
+            std::clamp(std::lround(brightness), static_cast<long>(limits.exposureMin),
+                       static_cast<long>(maxExposure)));
+        next.gain = limits.gainMin;
+        if (limits.gainMax > limits.gainMin && next.exposure == maxExposure &&
+            brightness > maxExposure) {
+            const double factor = std::min(brightness / next.exposure, MAX_GAIN_FACTOR);
+            next.gain = limits.gainMin + static_cast<int32_t>(std::lround(
+                (factor - 1.0) / (MAX_GAIN_FACTOR - 1.0) * (limits.gainMax - limits.gainMin)));
+        }
+        if (next.exposure == current.exposure && next.gain == current.gain) {
+            // Saturated at a limit
+            return false;
+        }
+        pending = true;
+        return true;
+    }
+
+    void ExposureController::applied(const Setting &actual, uint32_t lastSequence) {
+        current = actual;
+        pending = false;
+        settling = true;
+        settleUntilSequence = lastSequence + SETTLE_FRAMES + 1;
+    }
+
+    double ExposureController::gainFactor(int32_t gain) const {
+        if (limits.gainMax <= limits.gainMin) {
+            return 1.0;
+        }
+        const double position =
+            static_cast<double>(std::clamp(gain, limits.gainMin, limits.gainMax) - limits.gainMin) /
+            (limits.gainMax - limits.gainMin);
+        return 1.0 + position * (MAX_GAIN_FACTOR - 1.0);
+    }
+
+    int32_t ExposureController::exposureLimit() const {
+        if (frameRate <= 0.0) {
+            return limits.exposureMax;
+        }
+        // 100 us units
+        const auto framePeriod = static_cast<int32_t>(10000.0 / frameRate);
+        return std::clamp(framePeriod, limits.exposureMin, limits.exposureMax);
+    }
+
+}  // namespace imaging
@@ -0,0 +1,93 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <cstdint>
+
+#include "ImageStatistics.h"
+
+namespace imaging {
+
+    /*
+     * Closed-loop auto exposure on the luma statistics of the captured frames. The loop
+     * works on the product of exposure time and gain ("brightness"): every step scales it
+     * by (target / mean)^RESPONSE_EXPONENT, limited to MAX_STEP. The exponent sits between
+     * a linear sensor response (1) and a gamma encoded one (2.2), so both converge within a
+     * few frames without oscillating. Exposure time is used first, gain only once the
+     * exposure is at its limit, which is also bounded by the frame period.
+     *
+     * The controller only proposes settings. After a setting was applied, frames up to
+     * SETTLE_FRAMES after the confirmation are ignored, they may still have been exposed
+     * with the old values. The gain control is assumed to be linear over
+     * MAX_GAIN_FACTOR, V4L2 does not define its unit.
+     */
+    class ExposureController {
+    public:
+        static constexpr uint8_t DEFAULT_TARGET = 110;
+        // Mean luma deviation which is accepted without correction
+        static constexpr uint8_t TOLERANCE = 8;
+        static constexpr uint32_t SETTLE_FRAMES = 2;
+        static constexpr double MAX_STEP = 4.0;
+        static constexpr double RESPONSE_EXPONENT = 1.5;
+        static constexpr double MAX_GAIN_FACTOR = 8.0;
+        // Share of clipped highlights from which the exposure is reduced regardless of the mean
+        static constexpr float SATURATION_LIMIT = 0.02f;
+
+        struct Setting {
+            int32_t exposure = 0;  // V4L2_CID_EXPOSURE_ABSOLUTE, 100 us units
+            int32_t gain = 0;      // V4L2_CID_GAIN
+        };
+
+        struct Limits {
+            int32_t exposureMin = 1;
+            int32_t exposureMax = 1;
+            int32_t gainMin = 0;
+            int32_t gainMax = 0;  // gainMin == gainMax: no gain control
+        };
+
+        // Limits and current setting as read back from the device
+        void configure(const Limits &limits, const Setting &current);
+        bool isConfigured() const { return configured; }
+        // Forget the device state, e.g. after the capture was restarted
+        void reset();
+
+        void setTarget(uint8_t target);
+        uint8_t getTarget() const { return target; }
+        // Exposure can not be longer than the frame period
+        void setFrameRate(double frameRate);
+
+        // Returns true if the statistics of this frame call for a new setting
+        bool update(uint32_t sequence, const ImageStatistics::Result &statistics, Setting &next);
+        // The device confirmed a setting while frame lastSequence was the newest one
+        void applied(const Setting &actual, uint32_t lastSequence);
+
+        const Setting &getSetting() const { return current; }
+
+    private:
+        double gainFactor(int32_t gain) const;
+        int32_t exposureLimit() const;
+
+        Limits limits;
+        Setting current;
+        bool configured = false;
+        bool pending = false;  // proposed setting not confirmed yet
+        bool settling = false;
+        uint32_t settleUntilSequence = 0;
+        uint8_t target = DEFAULT_TARGET;
+        double frameRate = 0.0;
+    };
+
+}  // namespace imaging
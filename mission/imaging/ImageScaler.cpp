@@ -0,0 +1,326 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "ImageScaler.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// jpeglib.h needs FILE and size_t declared before it is included
+#include <jpeglib.h>
+
+#include "ColorConversion.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IMAGING_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace imaging {
+    namespace {
+        // acc[i] += src[i], the vertical pass of the box filter
+        using AccumulateKernel = void (*)(const uint8_t *src, uint16_t *acc, size_t count);
+
+        void accumulateRowScalar(const uint8_t *src, uint16_t *acc, size_t count) {
+            for (size_t i = 0; i < count; i++) {
+                acc[i] = static_cast<uint16_t>(acc[i] + src[i]);
+            }
+        }
+
+#if IMAGING_X86
+        void accumulateRowSse2(const uint8_t *src, uint16_t *acc, size_t count) {
+            const __m128i zero = _mm_setzero_si128();
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+                auto *lo = reinterpret_cast<__m128i *>(acc + i);
+                auto *hi = reinterpret_cast<__m128i *>(acc + i + 8);
+                _mm_storeu_si128(lo, _mm_add_epi16(_mm_loadu_si128(lo), _mm_unpacklo_epi8(bytes, zero)));
+                _mm_storeu_si128(hi, _mm_add_epi16(_mm_loadu_si128(hi), _mm_unpackhi_epi8(bytes, zero)));
+            }
+            accumulateRowScalar(src + i, acc + i, count - i);
+        }
+
+        __attribute__((target("avx2"))) void accumulateRowAvx2(const uint8_t *src, uint16_t *acc,
+                                                               size_t count) {
+            size_t i = 0;
+            for (; i + 32 <= count; i += 32) {
+                const __m256i lo = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i)));
+                const __m256i hi = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + 16)));
+                auto *accLo = reinterpret_cast<__m256i *>(acc + i);
+                auto *accHi = reinterpret_cast<__m256i *>(acc + i + 16);
+                _mm256_storeu_si256(accLo, _mm256_add_epi16(_mm256_loadu_si256(accLo), lo));
+                _mm256_storeu_si256(accHi, _mm256_add_epi16(_mm256_loadu_si256(accHi), hi));
+            }
+            accumulateRowSse2(src + i, acc + i, count - i);
+        }
+#endif  // IMAGING_X86
+
+#if defined(__ARM_NEON)
+        void accumulateRowNeon(const uint8_t *src, uint16_t *acc, size_t count) {
+            size_t i = 0;
+            for (; i + 16 <= count; i += 16) {
+                const uint8x16_t bytes = vld1q_u8(src + i);
+                vst1q_u16(acc + i, vaddw_u8(vld1q_u16(acc + i), vget_low_u8(bytes)));
+                vst1q_u16(acc + i + 8, vaddw_u8(vld1q_u16(acc + i + 8), vget_high_u8(bytes)));
+            }
+            accumulateRowScalar(src + i, acc + i, count - i);
+        }
+#endif  // __ARM_NEON
+
+        AccumulateKernel accumulateKernel() {
+            switch (activeBackend()) {
+#if IMAGING_X86
+                case Backend::sse2:
+                    return accumulateRowSse2;
+                case Backend::avx2:
+                    return accumulateRowAvx2;
+#endif
+#if defined(__ARM_NEON)
+                case Backend::neon:
+                    return accumulateRowNeon;
+#endif
+                default:
+                    return accumulateRowScalar;
+            }
+        }
+
+        Region clipRegion(uint32_t frameWidth, uint32_t frameHeight, Region region) {
+            if (region.width == 0 || region.height == 0) {
+                return Region{0, 0, frameWidth & ~1U, frameHeight};
+            }
+            region.x = (region.x < frameWidth ? region.x : frameWidth) & ~1U;
+            region.y = region.y < frameHeight ? region.y : frameHeight;
+            if (region.width > frameWidth - region.x) {
+                region.width = frameWidth - region.x;
+            }
+            region.width &= ~1U;
+            if (region.height > frameHeight - region.y) {
+                region.height = frameHeight - region.y;
+            }
+            return region;
+        }
+
+        // Largest IDCT scaling of libjpeg which divides the factor and keeps the region origin
+        // on the scaled pixel grid
+        uint32_t dctScale(uint32_t factor, const Region &region) {
+            for (uint32_t scale : {8U, 4U, 2U}) {
+                if (factor % scale == 0 && region.x % scale == 0 && region.y % scale == 0) {
+                    return scale;
+                }
+            }
+            return 1;
+        }
+
+        struct ErrorManager {
+            jpeg_error_mgr base;
+            jmp_buf jump;
+        };
+
+        // The default handler calls exit(), jump back into scaleMjpeg() instead
+        void onError(j_common_ptr info) {
+            std::longjmp(reinterpret_cast<ErrorManager *>(info->err)->jump, 1);
+        }
+
+        void onMessage(j_common_ptr, int) {}
+    }  // namespace
+
+    struct ImageScaler::State {
+        std::vector<uint16_t> accumulator;
+        jpeg_decompress_struct jpeg{};
+        ErrorManager errors{};
+        std::vector<uint8_t> decodedRow;     // YCbCr 4:4:4 scanline of the decoder
+        std::vector<uint8_t> intermediate;   // region after the IDCT scaling, as YUYV
+
+        // Box filter of an already clipped region, dst gets image.width x image.height
+        void boxFilter(const uint8_t *src, size_t stride, const Region &region, uint32_t factor,
+                       const ScaledImage &image, uint8_t *dst);
+    };
+
+    void ImageScaler::State::boxFilter(const uint8_t *src, size_t stride, const Region &region,
+                                       uint32_t factor, const ScaledImage &image, uint8_t *dst) {
+        const uint8_t *origin = src + region.y * stride + static_cast<size_t>(region.x) * 2;
+        const size_t outputStride = static_cast<size_t>(image.width) * 2;
+        if (factor == 1) {
+            for (uint32_t row = 0; row < image.height; row++) {
+                std::memcpy(dst + row * outputStride, origin + row * stride, outputStride);
+            }
+            return;
+        }
+
+        const size_t rowBytes = outputStride * factor;
+        accumulator.resize(rowBytes);
+        const AccumulateKernel accumulate = accumulateKernel();
+        const uint32_t area = factor * factor;
+        const uint32_t rounding = area / 2;
+        for (uint32_t outRow = 0; outRow < image.height; outRow++) {
+            std::memset(accumulator.data(), 0, rowBytes * sizeof(uint16_t));
+            const uint8_t *rowStart = origin + static_cast<size_t>(outRow) * factor * stride;
+            for (uint32_t i = 0; i < factor; i++) {
+                accumulate(rowStart + i * stride, accumulator.data(), rowBytes);
+            }
+
+            // Each output pixel pair covers 2 * factor pixels, i.e. factor YUYV macropixels
+            const uint16_t *acc = accumulator.data();
+            uint8_t *out = dst + outRow * outputStride;
+            for (uint32_t pair = 0; pair < image.width / 2; pair++) {
+                uint32_t y0 = 0;
+                uint32_t y1 = 0;
+                uint32_t u = 0;
+                uint32_t v = 0;
+                for (uint32_t i = 0; i < factor; i++) {
+                    y0 += acc[2 * i];
+                    y1 += acc[2 * (factor + i)];
+                    u += acc[4 * i + 1];
+                    v += acc[4 * i + 3];
+                }
+                out[0] = static_cast<uint8_t>((y0 + rounding) / area);
+                out[1] = static_cast<uint8_t>((u + rounding) / area);
+                out[2] = static_cast<uint8_t>((y1 + rounding) / area);
+                out[3] = static_cast<uint8_t>((v + rounding) / area);
+                acc += 4 * factor;
+                out += 4;
+            }
+        }
+    }
+
+    ImageScaler::ImageScaler() : state(std::make_unique<State>()) {
+        state->jpeg.err = jpeg_std_error(&state->errors.base);
+        state->errors.base.error_exit = onError;
+        state->errors.base.emit_message = onMessage;
+        jpeg_create_decompress(&state->jpeg);
+    }
+
+    ImageScaler::~ImageScaler() { jpeg_destroy_decompress(&state->jpeg); }
+
+    ScaledImage ImageScaler::scaledSize(uint32_t frameWidth, uint32_t frameHeight, Region region,
+                                        uint32_t factor) {
+        ScaledImage image;
+        if (factor == 0 || factor > MAX_FACTOR) {
+            return image;
+        }
+        region = clipRegion(frameWidth, frameHeight, region);
+        image.width = (region.width / factor) & ~1U;
+        image.height = region.height / factor;
+        if (image.width == 0 || image.height == 0) {
+            return ScaledImage{};
+        }
+        image.size = static_cast<size_t>(image.width) * image.height * 2;
+        return image;
+    }
+
+    bool ImageScaler::scaleYuyv(const uint8_t *frame, uint32_t frameWidth, uint32_t frameHeight,
+                                Region region, uint32_t factor, uint8_t *dst, size_t dstCapacity,
+                                ScaledImage &image) {
+        image = scaledSize(frameWidth, frameHeight, region, factor);
+        if (frame == nullptr || image.size == 0 || image.size > dstCapacity) {
+            return false;
+        }
+        state->boxFilter(frame, static_cast<size_t>(frameWidth) * 2,
+                         clipRegion(frameWidth, frameHeight, region), factor, image, dst);
+        return true;
+    }
+
+    bool ImageScaler::scaleMjpeg(const uint8_t *jpeg, size_t size, Region region, uint32_t factor,
+                                 uint8_t *dst, size_t dstCapacity, ScaledImage &image) {
+        image = ScaledImage{};
+        if (jpeg == nullptr || size == 0) {
+            return false;
+        }
+        State &s = *state;
+        jpeg_decompress_struct &info = s.jpeg;
+        if (setjmp(s.errors.jump) != 0) {
+            jpeg_abort_decompress(&info);
+            image = ScaledImage{};
+            return false;
+        }
+
+        jpeg_mem_src(&info, jpeg, static_cast<unsigned long>(size));
+        if (jpeg_read_header(&info, TRUE) != JPEG_HEADER_OK) {
+            jpeg_abort_decompress(&info);
+            return false;
+        }
+        region = clipRegion(info.image_width, info.image_height, region);
+        image = scaledSize(info.image_width, info.image_height, region, factor);
+        if (image.size == 0 || image.size > dstCapacity) {
+            jpeg_abort_decompress(&info);
+            return false;
+        }
+
+        // The IDCT takes the power of two part of the factor, the box filter the rest
+        const uint32_t scale = dctScale(factor, region);
+        const uint32_t remaining = factor / scale;
+        info.scale_num = 1;
+        info.scale_denom = scale;
+        info.out_color_space = JCS_YCbCr;
+        info.dct_method = JDCT_IFAST;
+        info.do_fancy_upsampling = FALSE;
+        jpeg_start_decompress(&info);
+
+        const uint32_t scaledX = region.x / scale;
+        const uint32_t scaledY = region.y / scale;
+        const uint32_t scaledWidth = image.width * remaining;
+        const uint32_t scaledHeight = image.height * remaining;
+        // Only the iMCU columns of the region are decoded, the crop starts at the column edge
+        JDIMENSION cropX = scaledX;
+        JDIMENSION cropWidth = scaledWidth;
+        if (scaledWidth < info.output_width) {
+            jpeg_crop_scanline(&info, &cropX, &cropWidth);
+        } else {
+            cropX = 0;
+        }
+        if (scaledY > 0) {
+            jpeg_skip_scanlines(&info, scaledY);
+        }
+
+        s.decodedRow.resize(static_cast<size_t>(info.output_width) * 3);
+        uint8_t *target = dst;
+        if (remaining > 1) {
+            s.intermediate.resize(static_cast<size_t>(scaledWidth) * scaledHeight * 2);
+            target = s.intermediate.data();
+        }
+        JSAMPROW row = s.decodedRow.data();
+        const uint8_t *regionStart = s.decodedRow.data() + static_cast<size_t>(scaledX - cropX) * 3;
+        for (uint32_t y = 0; y < scaledHeight; y++) {
+            jpeg_read_scanlines(&info, &row, 1);
+            const uint8_t *src = regionStart;
+            uint8_t *out = target + static_cast<size_t>(y) * scaledWidth * 2;
+            for (uint32_t pair = 0; pair < scaledWidth / 2; pair++) {
+                out[0] = src[0];
+                out[1] = static_cast<uint8_t>((src[1] + src[4] + 1) >> 1);
+                out[2] = src[3];
+                out[3] = static_cast<uint8_t>((src[2] + src[5] + 1) >> 1);
+                src += 6;
+                out += 4;
+            }
+        }
+        // The rows below the region are never decoded
+        jpeg_abort_decompress(&info);
+
+        if (remaining > 1) {
+            s.boxFilter(s.intermediate.data(), static_cast<size_t>(scaledWidth) * 2,
+                        Region{0, 0, scaledWidth, scaledHeight}, remaining, image, dst);
+        }
+        return true;
+    }
+
+}  // namespace imaging
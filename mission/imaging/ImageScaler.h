@@ -0,0 +1,77 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace imaging {
+
+    // Rectangle in source pixels. An empty region selects the whole frame.
+    struct Region {
+        uint32_t x = 0;
+        uint32_t y = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+    };
+
+    struct ScaledImage {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        size_t size = 0;  // bytes of YUYV written to the destination
+    };
+
+    /*
+     * Thumbnails and regions of interest straight from the capture buffer, the output is
+     * always YUYV. YUYV frames go through a factor x factor box filter: the source rows of
+     * an output row are summed with the SIMD backend selected in ColorConversion.h, the
+     * horizontal pass only sees 1/factor of the data. MJPEG frames are not fully decoded,
+     * libjpeg scales by 1/2, 1/4 or 1/8 in the IDCT and only decodes the rows and iMCU
+     * columns of the region; the box filter does the rest of the factor.
+     *
+     * The region is clipped to the frame and x/width are rounded down to even pixels.
+     * Not thread safe, the scratch rows and the decompressor are reused between calls.
+     */
+    class ImageScaler {
+    public:
+        static constexpr uint32_t MAX_FACTOR = 16;
+
+        ImageScaler();
+        ~ImageScaler();
+
+        ImageScaler(const ImageScaler &) = delete;
+        ImageScaler &operator=(const ImageScaler &) = delete;
+
+        // Output dimensions for a region of a frame, 0x0 if nothing is left
+        static ScaledImage scaledSize(uint32_t frameWidth, uint32_t frameHeight, Region region,
+                                      uint32_t factor);
+
+        // Returns false if the factor is out of range or the result does not fit into dst. In the
+        // latter case image still tells the size which would have been needed.
+        bool scaleYuyv(const uint8_t *frame, uint32_t frameWidth, uint32_t frameHeight,
+                       Region region, uint32_t factor, uint8_t *dst, size_t dstCapacity,
+                       ScaledImage &image);
+        // The frame dimensions are taken from the JPEG header
+        bool scaleMjpeg(const uint8_t *jpeg, size_t size, Region region, uint32_t factor,
+                        uint8_t *dst, size_t dstCapacity, ScaledImage &image);
+
+    private:
+        struct State;
+        std::unique_ptr<State> state;
+    };
+
+}  // namespace imaging
@@ -0,0 +1,272 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "ImageStatistics.h"
+
+#include <algorithm>
+
+#include "ColorConversion.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define IMAGING_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace imaging {
+    namespace {
+        struct LaplacianSums {
+            int64_t sum = 0;
+            uint64_t sumOfSquares = 0;
+            uint64_t count = 0;
+        };
+
+        // Histogram of one luma row, two banks so neighbouring equal pixels do not stall on
+        // the same counter
+        inline void histogramRow(const uint8_t *luma, uint32_t width, uint32_t (*banks)[256]) {
+            uint32_t x = 0;
+            for (; x + 2 <= width; x += 2) {
+                banks[0][luma[x]]++;
+                banks[1][luma[x + 1]]++;
+            }
+            if (x < width) {
+                banks[0][luma[x]]++;
+            }
+        }
+
+        // Sum and sum of squares of the Laplacian for x in [1, count + 1) of a luma row. The
+        // kernels are called with at most LAPLACIAN_CHUNK pixels, 2048 * 1020^2 squares still
+        // fit into the 32 bit lanes.
+        constexpr uint32_t LAPLACIAN_CHUNK = 2048;
+        using LaplacianKernel = void (*)(const uint8_t *up, const uint8_t *row,
+                                         const uint8_t *down, size_t count, int32_t &sum,
+                                         uint32_t &sumOfSquares);
+
+        void laplacianScalar(const uint8_t *up, const uint8_t *row, const uint8_t *down,
+                             size_t count, int32_t &sum, uint32_t &sumOfSquares) {
+            for (size_t x = 1; x <= count; x++) {
+                const int32_t value = 4 * row[x] - row[x - 1] - row[x + 1] - up[x] - down[x];
+                sum += value;
+                sumOfSquares += static_cast<uint32_t>(value * value);
+            }
+        }
+
+#if IMAGING_X86
+        // 8 / 16 luma samples widened to 16 bit
+        inline __m128i widenSse2(const uint8_t *p) {
+            return _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(p)),
+                                     _mm_setzero_si128());
+        }
+
+        __attribute__((target("avx2"))) inline __m256i widenAvx2(const uint8_t *p) {
+            return _mm256_cvtepu8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)));
+        }
+
+        void laplacianSse2(const uint8_t *up, const uint8_t *row, const uint8_t *down,
+                           size_t count, int32_t &sum, uint32_t &sumOfSquares) {
+            const __m128i ones = _mm_set1_epi16(1);
+            auto load = widenSse2;
+            __m128i sums = _mm_setzero_si128();
+            __m128i squares = _mm_setzero_si128();
+            size_t x = 1;
+            for (; x + 8 <= count + 1; x += 8) {
+                const __m128i neighbours =
+                    _mm_add_epi16(_mm_add_epi16(load(row + x - 1), load(row + x + 1)),
+                                  _mm_add_epi16(load(up + x), load(down + x)));
+                const __m128i value = _mm_sub_epi16(_mm_slli_epi16(load(row + x), 2), neighbours);
+                sums = _mm_add_epi32(sums, _mm_madd_epi16(value, ones));
+                squares = _mm_add_epi32(squares, _mm_madd_epi16(value, value));
+            }
+            alignas(16) int32_t sumLanes[4];
+            alignas(16) uint32_t squareLanes[4];
+            _mm_store_si128(reinterpret_cast<__m128i *>(sumLanes), sums);
+            _mm_store_si128(reinterpret_cast<__m128i *>(squareLanes), squares);
+            sum += sumLanes[0] + sumLanes[1] + sumLanes[2] + sumLanes[3];
+            sumOfSquares += squareLanes[0] + squareLanes[1] + squareLanes[2] + squareLanes[3];
+            laplacianScalar(up + x - 1, row + x - 1, down + x - 1, count + 1 - x, sum, sumOfSquares);
+        }
+
+        __attribute__((target("avx2"))) void laplacianAvx2(const uint8_t *up, const uint8_t *row,
+                                                           const uint8_t *down, size_t count,
+                                                           int32_t &sum, uint32_t &sumOfSquares) {
+            const __m256i ones = _mm256_set1_epi16(1);
+            auto load = widenAvx2;
+            __m256i sums = _mm256_setzero_si256();
+            __m256i squares = _mm256_setzero_si256();
+            size_t x = 1;
+            for (; x + 16 <= count + 1; x += 16) {
+                const __m256i neighbours =
+                    _mm256_add_epi16(_mm256_add_epi16(load(row + x - 1), load(row + x + 1)),
+                                     _mm256_add_epi16(load(up + x), load(down + x)));
+                const __m256i value =
+                    _mm256_sub_epi16(_mm256_slli_epi16(load(row + x), 2), neighbours);
+                sums = _mm256_add_epi32(sums, _mm256_madd_epi16(value, ones));
+                squares = _mm256_add_epi32(squares, _mm256_madd_epi16(value, value));
+            }
+            alignas(32) int32_t sumLanes[8];
+            alignas(32) uint32_t squareLanes[8];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(sumLanes), sums);
+            _mm256_store_si256(reinterpret_cast<__m256i *>(squareLanes), squares);
+            for (int lane = 0; lane < 8; lane++) {
+                sum += sumLanes[lane];
+                sumOfSquares += squareLanes[lane];
+            }
+            laplacianSse2(up + x - 1, row + x - 1, down + x - 1, count + 1 - x, sum, sumOfSquares);
+        }
+#endif  // IMAGING_X86
+
+#if defined(__ARM_NEON)
+        inline int16x8_t widenNeon(const uint8_t *p) {
+            return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)));
+        }
+
+        void laplacianNeon(const uint8_t *up, const uint8_t *row, const uint8_t *down,
+                           size_t count, int32_t &sum, uint32_t &sumOfSquares) {
+            auto load = widenNeon;
+            int32x4_t sums = vdupq_n_s32(0);
+            uint32x4_t squares = vdupq_n_u32(0);
+            size_t x = 1;
+            for (; x + 8 <= count + 1; x += 8) {
+                const int16x8_t neighbours = vaddq_s16(vaddq_s16(load(row + x - 1), load(row + x + 1)),
+                                                       vaddq_s16(load(up + x), load(down + x)));
+                const int16x8_t value = vsubq_s16(vshlq_n_s16(load(row + x), 2), neighbours);
+                sums = vpadalq_s16(sums, value);
+                const int16x4_t low = vget_low_s16(value);
+                const int16x4_t high = vget_high_s16(value);
+                squares = vaddq_u32(squares, vreinterpretq_u32_s32(vmull_s16(low, low)));
+                squares = vaddq_u32(squares, vreinterpretq_u32_s32(vmull_s16(high, high)));
+            }
+            // Pairwise widening adds instead of vaddvq, which only exists on AArch64
+            const int64x2_t sumPairs = vpaddlq_s32(sums);
+            const uint64x2_t squarePairs = vpaddlq_u32(squares);
+            sum += static_cast<int32_t>(vgetq_lane_s64(sumPairs, 0) + vgetq_lane_s64(sumPairs, 1));
+            sumOfSquares +=
+                static_cast<uint32_t>(vgetq_lane_u64(squarePairs, 0) + vgetq_lane_u64(squarePairs, 1));
+            laplacianScalar(up + x - 1, row + x - 1, down + x - 1, count + 1 - x, sum, sumOfSquares);
+        }
+#endif  // __ARM_NEON
+
+        LaplacianKernel laplacianKernel() {
+            switch (activeBackend()) {
+#if IMAGING_X86
+                case Backend::sse2:
+                    return laplacianSse2;
+                case Backend::avx2:
+                    return laplacianAvx2;
+#endif
+#if defined(__ARM_NEON)
+                case Backend::neon:
+                    return laplacianNeon;
+#endif
+                default:
+                    return laplacianScalar;
+            }
+        }
+
+        void laplacianRow(LaplacianKernel kernel, const uint8_t *up, const uint8_t *row,
+                          const uint8_t *down, uint32_t width, LaplacianSums &sums) {
+            for (uint32_t start = 0; start + 2 < width; start += LAPLACIAN_CHUNK) {
+                const uint32_t count = std::min(LAPLACIAN_CHUNK, width - 2 - start);
+                int32_t sum = 0;
+                uint32_t sumOfSquares = 0;
+                kernel(up + start, row + start, down + start, count, sum, sumOfSquares);
+                sums.sum += sum;
+                sums.sumOfSquares += sumOfSquares;
+            }
+            sums.count += width - 2;
+        }
+    }  // namespace
+
+    bool ImageStatistics::analyzeYuyv(const uint8_t *frame, uint32_t width, uint32_t height,
+                                      Result &result) {
+        result = Result{};
+        if (frame == nullptr || width == 0 || height == 0) {
+            return false;
+        }
+        const size_t stride = 2 * static_cast<size_t>(width);
+        // The luma of the last three rows, contiguous so the Laplacian vectorizes
+        lumaRows.resize(3 * static_cast<size_t>(width));
+        uint32_t banks[2][256] = {};
+        LaplacianSums laplacian;
+        const LaplacianKernel kernel = laplacianKernel();
+        for (uint32_t y = 0; y < height; y++) {
+            const uint8_t *row = frame + y * stride;
+            uint8_t *luma = lumaRows.data() + (y % 3) * static_cast<size_t>(width);
+            for (uint32_t x = 0; x < width; x++) {
+                luma[x] = row[2 * x];
+            }
+            histogramRow(luma, width, banks);
+            // Row y completes the neighbourhood of row y - 1
+            if (y >= 2 && width >= 3) {
+                laplacianRow(kernel, lumaRows.data() + ((y - 2) % 3) * static_cast<size_t>(width),
+                             lumaRows.data() + ((y - 1) % 3) * static_cast<size_t>(width), luma,
+                             width, laplacian);
+            }
+        }
+
+        const uint64_t samples = static_cast<uint64_t>(width) * height;
+        uint64_t sum = 0;
+        uint64_t sumOfSquares = 0;
+        uint64_t saturated = 0;
+        uint64_t black = 0;
+        for (uint32_t value = 0; value < 256; value++) {
+            const uint64_t count = static_cast<uint64_t>(banks[0][value]) + banks[1][value];
+            result.histogram[value * HISTOGRAM_BINS / 256] += static_cast<uint32_t>(count);
+            sum += count * value;
+            sumOfSquares += count * value * value;
+            if (value >= SATURATED_LEVEL) {
+                saturated += count;
+            } else if (value <= BLACK_LEVEL) {
+                black += count;
+            }
+        }
+        const double mean = static_cast<double>(sum) / static_cast<double>(samples);
+        result.width = width;
+        result.height = height;
+        result.mean = static_cast<float>(mean);
+        result.variance =
+            static_cast<float>(static_cast<double>(sumOfSquares) / samples - mean * mean);
+        result.saturatedRatio = static_cast<float>(static_cast<double>(saturated) / samples);
+        result.blackRatio = static_cast<float>(static_cast<double>(black) / samples);
+        if (laplacian.count > 0) {
+            const double count = static_cast<double>(laplacian.count);
+            const double laplacianMean = static_cast<double>(laplacian.sum) / count;
+            result.sharpness = static_cast<float>(
+                static_cast<double>(laplacian.sumOfSquares) / count - laplacianMean * laplacianMean);
+        }
+        return true;
+    }
+
+    bool ImageStatistics::analyzeMjpeg(const uint8_t *jpeg, size_t size, Result &result) {
+        result = Result{};
+        ScaledImage image;
+        if (!scaler.scaleMjpeg(jpeg, size, Region{}, MJPEG_FACTOR, decoded.data(), decoded.size(),
+                               image)) {
+            // The frame size is only known from the header, grow once and try again
+            if (image.size == 0 || image.size <= decoded.size()) {
+                return false;
+            }
+            decoded.resize(image.size);
+            if (!scaler.scaleMjpeg(jpeg, size, Region{}, MJPEG_FACTOR, decoded.data(),
+                                   decoded.size(), image)) {
+                return false;
+            }
+        }
+        return analyzeYuyv(decoded.data(), image.width, image.height, result);
+    }
+
+}  // namespace imaging
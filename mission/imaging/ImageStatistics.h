@@ -0,0 +1,67 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ImageScaler.h"
+
+namespace imaging {
+
+    /*
+     * Exposure and focus health of a frame from a single pass over the luma. Every row is
+     * read once and its luma kept in a three row ring that stays in L1: the pass fills a
+     * 256 bin histogram and sums the 4-neighbour Laplacian of the row above. Mean, variance
+     * and the clipping ratios are derived from the histogram afterwards, so the per-pixel
+     * work is one increment and one Laplacian.
+     *
+     * MJPEG frames are decoded at half size with the IDCT scaling of ImageScaler, the
+     * sharpness of MJPEG and YUYV frames is therefore not directly comparable.
+     * Not thread safe, the buffers are reused between calls.
+     */
+    class ImageStatistics {
+    public:
+        static constexpr size_t HISTOGRAM_BINS = 32;
+        static constexpr uint32_t MJPEG_FACTOR = 2;
+        // Luma values counted as clipped highlights / crushed shadows
+        static constexpr uint8_t SATURATED_LEVEL = 250;
+        static constexpr uint8_t BLACK_LEVEL = 5;
+
+        struct Result {
+            uint32_t width = 0;   // of the analysed luma plane
+            uint32_t height = 0;
+            std::array<uint32_t, HISTOGRAM_BINS> histogram{};  // 256 / HISTOGRAM_BINS values each
+            float mean = 0.0f;
+            float variance = 0.0f;
+            float saturatedRatio = 0.0f;  // share of samples >= SATURATED_LEVEL
+            float blackRatio = 0.0f;      // share of samples <= BLACK_LEVEL
+            float sharpness = 0.0f;       // variance of the Laplacian, higher is sharper
+        };
+
+        // Return false if the frame could not be analysed
+        bool analyzeYuyv(const uint8_t *frame, uint32_t width, uint32_t height, Result &result);
+        bool analyzeMjpeg(const uint8_t *jpeg, size_t size, Result &result);
+
+    private:
+        ImageScaler scaler;
+        std::vector<uint8_t> decoded;
+        std::vector<uint8_t> lumaRows;
+    };
+
+}  // namespace imaging
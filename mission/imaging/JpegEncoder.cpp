@@ -0,0 +1,282 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "JpegEncoder.h"
+
+#include <chrono>
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// jpeglib.h needs FILE and size_t declared before it is included
+#include <jpeglib.h>
+
+#include "SnapshotWriter.h"
+
+namespace imaging {
+    namespace {
+        // 4:2:2, one MCU is 16x8 pixels
+        constexpr uint32_t MCU_WIDTH = 16;
+        constexpr uint32_t MCU_HEIGHT = DCTSIZE;
+
+        struct ErrorManager {
+            jpeg_error_mgr base;
+            jmp_buf jump;
+            char message[JMSG_LENGTH_MAX];
+        };
+
+        // The default handler calls exit(), jump back into encodeYuyv() instead
+        void onError(j_common_ptr info) {
+            auto *errors = reinterpret_cast<ErrorManager *>(info->err);
+            errors->base.format_message(info, errors->message);
+            std::longjmp(errors->jump, 1);
+        }
+
+        void onMessage(j_common_ptr, int) {}
+    }  // namespace
+
+    struct JpegEncoder::State {
+        jpeg_compress_struct info{};
+        ErrorManager errors{};
+
+        // libjpeg may replace the buffer with a larger one of its own, we take over ownership
+        unsigned char *output = nullptr;
+        unsigned long outputCapacity = 0;
+        unsigned long outputSize = 0;
+
+        // One MCU row of planar Y, Cb and Cr, widths padded to whole MCUs
+        std::vector<uint8_t> planes;
+        JSAMPROW rows[3][MCU_HEIGHT]{};
+        uint32_t paddedWidth = 0;
+    };
+
+    JpegEncoder::JpegEncoder() : state(std::make_unique<State>()) {
+        state->info.err = jpeg_std_error(&state->errors.base);
+        state->errors.base.error_exit = onError;
+        state->errors.base.emit_message = onMessage;
+        jpeg_create_compress(&state->info);
+    }
+
+    JpegEncoder::~JpegEncoder() {
+        jpeg_destroy_compress(&state->info);
+        std::free(state->output);
+    }
+
+    const uint8_t *JpegEncoder::data() const { return state->output; }
+
+    size_t JpegEncoder::size() const { return state->outputSize; }
+
+    const char *JpegEncoder::lastError() const { return state->errors.message; }
+
+    bool JpegEncoder::encodeYuyv(const uint8_t *yuyv, uint32_t width, uint32_t height,
+                                 int quality) {
+        State &s = *state;
+        s.outputSize = 0;
+        if (yuyv == nullptr || width == 0 || height == 0 || (width & 1) != 0) {
+            std::snprintf(s.errors.message, sizeof(s.errors.message), "invalid frame");
+            return false;
+        }
+
+        const uint32_t paddedWidth = (width + MCU_WIDTH - 1) / MCU_WIDTH * MCU_WIDTH;
+        if (paddedWidth != s.paddedWidth) {
+            s.paddedWidth = paddedWidth;
+            s.planes.resize(static_cast<size_t>(paddedWidth) * 2 * MCU_HEIGHT);
+            uint8_t *plane = s.planes.data();
+            const uint32_t planeWidths[3] = {paddedWidth, paddedWidth / 2, paddedWidth / 2};
+            for (int component = 0; component < 3; component++) {
+                for (uint32_t row = 0; row < MCU_HEIGHT; row++) {
+                    s.rows[component][row] = plane;
+                    plane += planeWidths[component];
+                }
+            }
+        }
+        if (s.output == nullptr) {
+            // Plenty for a YUYV frame, grown by libjpeg if a frame does not fit
+            s.outputCapacity = static_cast<unsigned long>(width) * height;
+            s.output = static_cast<unsigned char *>(std::malloc(s.outputCapacity));
+            if (s.output == nullptr) {
+                s.outputCapacity = 0;
+            }
+        }
+
+        jpeg_compress_struct &info = s.info;
+        unsigned char *const ownBuffer = s.output;
+        if (setjmp(s.errors.jump) != 0) {
+            jpeg_abort_compress(&info);
+            if (s.output != ownBuffer) {
+                std::free(s.output);
+                s.output = ownBuffer;
+            }
+            s.outputSize = 0;
+            return false;
+        }
+
+        s.outputSize = s.outputCapacity;
+        jpeg_mem_dest(&info, &s.output, &s.outputSize);
+        info.image_width = width;
+        info.image_height = height;
+        info.input_components = 3;
+        info.in_color_space = JCS_YCbCr;
+        jpeg_set_defaults(&info);
+        jpeg_set_colorspace(&info, JCS_YCbCr);
+        jpeg_set_quality(&info, quality < 1 ? 1 : (quality > 100 ? 100 : quality), TRUE);
+        info.raw_data_in = TRUE;
+        info.dct_method = JDCT_ISLOW;
+        info.comp_info[0].h_samp_factor = 2;
+        info.comp_info[0].v_samp_factor = 1;
+        for (int component = 1; component < 3; component++) {
+            info.comp_info[component].h_samp_factor = 1;
+            info.comp_info[component].v_samp_factor = 1;
+        }
+        jpeg_start_compress(&info, TRUE);
+
+        JSAMPARRAY planes[3] = {s.rows[0], s.rows[1], s.rows[2]};
+        const size_t stride = static_cast<size_t>(width) * 2;
+        for (uint32_t firstRow = 0; firstRow < height; firstRow += MCU_HEIGHT) {
+            for (uint32_t row = 0; row < MCU_HEIGHT; row++) {
+                // Rows below the image repeat the last one
+                const uint32_t sourceRow = firstRow + row < height ? firstRow + row : height - 1;
+                const uint8_t *src = yuyv + sourceRow * stride;
+                uint8_t *y = s.rows[0][row];
+                uint8_t *cb = s.rows[1][row];
+                uint8_t *cr = s.rows[2][row];
+                for (uint32_t pair = 0; pair < width / 2; pair++) {
+                    y[2 * pair] = src[4 * pair];
+                    cb[pair] = src[4 * pair + 1];
+                    y[2 * pair + 1] = src[4 * pair + 2];
+                    cr[pair] = src[4 * pair + 3];
+                }
+                // Columns right of the image repeat the last pixel pair
+                for (uint32_t x = width; x < paddedWidth; x++) {
+                    y[x] = y[width - 1];
+                }
+                for (uint32_t x = width / 2; x < paddedWidth / 2; x++) {
+                    cb[x] = cb[width / 2 - 1];
+                    cr[x] = cr[width / 2 - 1];
+                }
+            }
+            jpeg_write_raw_data(&info, planes, MCU_HEIGHT);
+        }
+        jpeg_finish_compress(&info);
+
+        if (s.output != ownBuffer) {
+            // libjpeg had to grow the buffer, keep the larger one for the next frames
+            std::free(ownBuffer);
+            s.outputCapacity = s.outputSize;
+        }
+        return true;
+    }
+
+    JpegEncodeStage::JpegEncodeStage(SnapshotWriter &writer, size_t queueDepth)
+        : writer(writer), queueDepth(queueDepth > 0 ? queueDepth : 1) {
+        thread = std::thread(&JpegEncodeStage::encoderLoop, this);
+    }
+
+    JpegEncodeStage::~JpegEncodeStage() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobQueued.notify_one();
+        thread.join();
+    }
+
+    bool JpegEncodeStage::submitYuyv(std::string path, const uint8_t *yuyv, uint32_t width,
+                                     uint32_t height, int quality) {
+        const size_t frameSize = static_cast<size_t>(width) * height * 2;
+        std::vector<uint8_t> frame;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() >= queueDepth || stopping) {
+                statistics.rejected++;
+                return false;
+            }
+            if (!freeFrames.empty()) {
+                frame = std::move(freeFrames.back());
+                freeFrames.pop_back();
+            }
+        }
+        // Copy outside of the lock, the encoder thread keeps running meanwhile
+        frame.resize(frameSize);
+        std::memcpy(frame.data(), yuyv, frameSize);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (queue.size() >= queueDepth) {
+            statistics.rejected++;
+            freeFrames.push_back(std::move(frame));
+            return false;
+        }
+        queue.push_back(Job{std::move(path), width, height, quality, std::move(frame)});
+        statistics.submitted++;
+        statistics.bytesIn += frameSize;
+        jobQueued.notify_one();
+        return true;
+    }
+
+    void JpegEncodeStage::flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobFinished.wait(lock, [this] { return queue.empty() && !encoding; });
+    }
+
+    JpegEncodeStage::Statistics JpegEncodeStage::getStatistics() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return statistics;
+    }
+
+    void JpegEncodeStage::encoderLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            jobQueued.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return;
+            }
+            Job job = std::move(queue.front());
+            queue.pop_front();
+            encoding = true;
+            lock.unlock();
+
+            const auto start = std::chrono::steady_clock::now();
+            const bool encoded = encoder.encodeYuyv(job.frame.data(), job.width, job.height,
+                                                    job.quality);
+            const auto encodeTimeUs = static_cast<uint32_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count());
+            const bool queued =
+                encoded && writer.submitCopy(std::move(job.path), encoder.data(), encoder.size());
+
+            lock.lock();
+            encoding = false;
+            if (!encoded) {
+                statistics.failed++;
+            } else if (!queued) {
+                statistics.rejected++;
+            } else {
+                statistics.encoded++;
+                statistics.bytesOut += encoder.size();
+            }
+            statistics.lastEncodeTimeUs = encodeTimeUs;
+            if (encodeTimeUs > statistics.maxEncodeTimeUs) {
+                statistics.maxEncodeTimeUs = encodeTimeUs;
+            }
+            if (freeFrames.size() < queueDepth) {
+                freeFrames.push_back(std::move(job.frame));
+            }
+            jobFinished.notify_all();
+        }
+    }
+
+}  // namespace imaging
@@ -0,0 +1,123 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace imaging {
+
+    class SnapshotWriter;
+
+    /*
+     * YUYV -> JPEG with libjpeg(-turbo). The 4:2:2 planes are fed as raw data, so there is
+     * no colour conversion and no chroma resampling, only a deinterleave per 8 rows.
+     * Compressor state, scratch rows and the output buffer live as long as the encoder.
+     * Not thread safe, use one encoder per thread.
+     */
+    class JpegEncoder {
+    public:
+        static constexpr int DEFAULT_QUALITY = 85;
+
+        JpegEncoder();
+        ~JpegEncoder();
+
+        JpegEncoder(const JpegEncoder &) = delete;
+        JpegEncoder &operator=(const JpegEncoder &) = delete;
+
+        // quality 1..100, width must be even. The result stays valid until the next call.
+        bool encodeYuyv(const uint8_t *yuyv, uint32_t width, uint32_t height, int quality);
+        [[nodiscard]] const uint8_t *data() const;
+        [[nodiscard]] size_t size() const;
+        // libjpeg message of the last failed encode
+        [[nodiscard]] const char *lastError() const;
+
+    private:
+        struct State;
+        std::unique_ptr<State> state;
+    };
+
+    /*
+     * Encoding stage between the frame consumers and the SnapshotWriter. Frames are copied
+     * into recycled input buffers and encoded on a dedicated thread, so neither the device
+     * handler nor the PUS service spend their cycle on compression. When all input buffers
+     * are in use the frame is rejected instead of blocking the producer.
+     */
+    class JpegEncodeStage {
+    public:
+        static constexpr size_t DEFAULT_QUEUE_DEPTH = 2;
+
+        struct Statistics {
+            uint64_t submitted = 0;
+            uint64_t encoded = 0;
+            uint64_t failed = 0;
+            uint64_t rejected = 0;  // stage busy or writer queue full
+            uint64_t bytesIn = 0;
+            uint64_t bytesOut = 0;
+            uint32_t lastEncodeTimeUs = 0;
+            uint32_t maxEncodeTimeUs = 0;
+        };
+
+        explicit JpegEncodeStage(SnapshotWriter &writer, size_t queueDepth = DEFAULT_QUEUE_DEPTH);
+        // Encodes the frames still queued before returning
+        ~JpegEncodeStage();
+
+        JpegEncodeStage(const JpegEncodeStage &) = delete;
+        JpegEncodeStage &operator=(const JpegEncodeStage &) = delete;
+
+        bool submitYuyv(std::string path, const uint8_t *yuyv, uint32_t width, uint32_t height,
+                        int quality);
+        // Blocks until all queued frames went to the writer
+        void flush();
+        [[nodiscard]] Statistics getStatistics() const;
+        // Encoder thread, e.g. to keep the compression off the cores of the capture path
+        [[nodiscard]] std::thread::native_handle_type getThreadHandle() { return thread.native_handle(); }
+
+    private:
+        struct Job {
+            std::string path;
+            uint32_t width = 0;
+            uint32_t height = 0;
+            int quality = JpegEncoder::DEFAULT_QUALITY;
+            std::vector<uint8_t> frame;
+        };
+
+        void encoderLoop();
+
+        SnapshotWriter &writer;
+        const size_t queueDepth;
+        JpegEncoder encoder;
+
+        mutable std::mutex mutex;
+        std::condition_variable jobQueued;
+        std::condition_variable jobFinished;
+        std::deque<Job> queue;
+        std::vector<std::vector<uint8_t>> freeFrames;
+        bool encoding = false;
+        bool stopping = false;
+        Statistics statistics;
+
+        std::thread thread;
+    };
+
+}  // namespace imaging
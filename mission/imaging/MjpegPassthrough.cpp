@@ -0,0 +1,195 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "MjpegPassthrough.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace imaging {
+    namespace {
+        constexpr uint8_t MARKER_SOF0 = 0xc0;
+        constexpr uint8_t MARKER_SOF2 = 0xc2;
+        constexpr uint8_t MARKER_DHT = 0xc4;
+        constexpr uint8_t MARKER_RST0 = 0xd0;
+        constexpr uint8_t MARKER_RST7 = 0xd7;
+        constexpr uint8_t MARKER_SOI = 0xd8;
+        constexpr uint8_t MARKER_EOI = 0xd9;
+        constexpr uint8_t MARKER_SOS = 0xda;
+        constexpr uint8_t MARKER_TEM = 0x01;
+
+        // ITU-T T.81 Annex K.3, the tables libjpeg uses when optimize_coding is off
+        constexpr uint8_t DC_LUMINANCE_BITS[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+        constexpr uint8_t DC_CHROMINANCE_BITS[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+        constexpr uint8_t DC_VALUES[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+        constexpr uint8_t AC_LUMINANCE_BITS[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+        constexpr uint8_t AC_LUMINANCE_VALUES[162] = {
+            0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51,
+            0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1,
+            0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18,
+            0x19, 0x1a, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39,
+            0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57,
+            0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75,
+            0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x92,
+            0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+            0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+            0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8,
+            0xd9, 0xda, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2,
+            0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
+
+        constexpr uint8_t AC_CHROMINANCE_BITS[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+        constexpr uint8_t AC_CHROMINANCE_VALUES[162] = {
+            0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07,
+            0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09,
+            0x23, 0x33, 0x52, 0xf0, 0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25,
+            0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38,
+            0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56,
+            0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74,
+            0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+            0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+            0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba,
+            0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6,
+            0xd7, 0xd8, 0xd9, 0xda, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2,
+            0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa};
+
+        // One DHT segment holding all four tables, built at compile time
+        constexpr std::array<uint8_t, STANDARD_DHT_SIZE> buildStandardDht() {
+            std::array<uint8_t, STANDARD_DHT_SIZE> segment{};
+            size_t pos = 0;
+            segment[pos++] = 0xff;
+            segment[pos++] = MARKER_DHT;
+            segment[pos++] = static_cast<uint8_t>((STANDARD_DHT_SIZE - 2) >> 8);
+            segment[pos++] = static_cast<uint8_t>((STANDARD_DHT_SIZE - 2) & 0xff);
+            // class << 4 | id, bits, values
+            const uint8_t tableIds[4] = {0x00, 0x10, 0x01, 0x11};
+            const uint8_t *bits[4] = {DC_LUMINANCE_BITS, AC_LUMINANCE_BITS, DC_CHROMINANCE_BITS,
+                                      AC_CHROMINANCE_BITS};
+            const uint8_t *values[4] = {DC_VALUES, AC_LUMINANCE_VALUES, DC_VALUES,
+                                        AC_CHROMINANCE_VALUES};
+            const size_t valueCounts[4] = {sizeof(DC_VALUES), sizeof(AC_LUMINANCE_VALUES),
+                                           sizeof(DC_VALUES), sizeof(AC_CHROMINANCE_VALUES)};
+            for (size_t table = 0; table < 4; table++) {
+                segment[pos++] = tableIds[table];
+                for (size_t i = 0; i < 16; i++) {
+                    segment[pos++] = bits[table][i];
+                }
+                for (size_t i = 0; i < valueCounts[table]; i++) {
+                    segment[pos++] = values[table][i];
+                }
+            }
+            return segment;
+        }
+
+        constexpr std::array<uint8_t, STANDARD_DHT_SIZE> STANDARD_DHT = buildStandardDht();
+
+        bool hasNoLength(uint8_t marker) {
+            return marker == MARKER_TEM || (marker >= MARKER_RST0 && marker <= MARKER_RST7);
+        }
+    }  // namespace
+
+    const char *mjpegCheckToString(MjpegCheck check) {
+        switch (check) {
+            case MjpegCheck::ok:
+                return "ok";
+            case MjpegCheck::noStartOfImage:
+                return "noStartOfImage";
+            case MjpegCheck::truncatedHeader:
+                return "truncatedHeader";
+            case MjpegCheck::noScan:
+                return "noScan";
+            case MjpegCheck::noEndOfImage:
+                return "noEndOfImage";
+        }
+        return "unknown";
+    }
+
+    MjpegCheck inspectMjpeg(const uint8_t *frame, size_t size, MjpegFrameInfo &info) {
+        info = MjpegFrameInfo{};
+        if (frame == nullptr || size < 4 || frame[0] != 0xff || frame[1] != MARKER_SOI) {
+            return MjpegCheck::noStartOfImage;
+        }
+
+        // Marker segments up to the start of scan
+        size_t pos = 2;
+        while (true) {
+            if (pos + 2 > size) {
+                return MjpegCheck::truncatedHeader;
+            }
+            if (frame[pos] != 0xff) {
+                return MjpegCheck::truncatedHeader;
+            }
+            // Any number of 0xff fill bytes may precede a marker
+            while (pos + 1 < size && frame[pos + 1] == 0xff) {
+                pos++;
+            }
+            if (pos + 2 > size) {
+                return MjpegCheck::truncatedHeader;
+            }
+            const uint8_t marker = frame[pos + 1];
+            if (marker == MARKER_SOS) {
+                info.scanOffset = pos;
+                break;
+            }
+            if (marker == MARKER_EOI) {
+                return MjpegCheck::noScan;
+            }
+            if (hasNoLength(marker)) {
+                pos += 2;
+                continue;
+            }
+            if (pos + 4 > size) {
+                return MjpegCheck::truncatedHeader;
+            }
+            const size_t segmentLength = (static_cast<size_t>(frame[pos + 2]) << 8) | frame[pos + 3];
+            if (segmentLength < 2 || pos + 2 + segmentLength > size) {
+                return MjpegCheck::truncatedHeader;
+            }
+            if (marker == MARKER_DHT) {
+                info.hasHuffmanTables = true;
+            } else if (marker >= MARKER_SOF0 && marker <= MARKER_SOF2 && segmentLength >= 7) {
+                info.height = static_cast<uint16_t>((frame[pos + 5] << 8) | frame[pos + 6]);
+                info.width = static_cast<uint16_t>((frame[pos + 7] << 8) | frame[pos + 8]);
+            }
+            pos += 2 + segmentLength;
+        }
+
+        // The EOI is at the end, UVC payloads may only have a few padding bytes behind it.
+        // A truncated frame must not cost a scan of the whole payload.
+        const size_t searchEnd = std::max(info.scanOffset + 4,
+                                          size > EOI_SEARCH_WINDOW ? size - EOI_SEARCH_WINDOW : 0);
+        for (size_t end = size; end >= searchEnd; end--) {
+            if (frame[end - 2] == 0xff && frame[end - 1] == MARKER_EOI) {
+                info.length = end;
+                return MjpegCheck::ok;
+            }
+        }
+        return MjpegCheck::noEndOfImage;
+    }
+
+    size_t completeMjpeg(const uint8_t *frame, const MjpegFrameInfo &info, uint8_t *dst) {
+        if (info.hasHuffmanTables) {
+            std::memcpy(dst, frame, info.length);
+            return info.length;
+        }
+        std::memcpy(dst, frame, info.scanOffset);
+        std::memcpy(dst + info.scanOffset, STANDARD_DHT.data(), STANDARD_DHT.size());
+        std::memcpy(dst + info.scanOffset + STANDARD_DHT.size(), frame + info.scanOffset,
+                    info.length - info.scanOffset);
+        return info.completedSize();
+    }
+
+}  // namespace imaging
@@ -0,0 +1,66 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace imaging {
+
+    /*
+     * MJPEG frames are stored as they come from the camera, nothing is decoded. The check
+     * only walks the marker segments in front of the scan and looks for the EOI in the last
+     * EOI_SEARCH_WINDOW bytes, which costs a few hundred bytes of reads per frame. UVC cameras usually leave out the
+     * Huffman tables (the AVI1 convention), those frames get the standard tables of
+     * ITU-T T.81 Annex K inserted in front of the scan so any JPEG decoder can open them.
+     */
+    enum class MjpegCheck : uint8_t {
+        ok = 0,
+        noStartOfImage,   // no FFD8 at the start of the buffer
+        truncatedHeader,  // a marker segment runs past the end of the buffer
+        noScan,           // the header ended (EOI) before a start of scan
+        noEndOfImage,     // no FFD9 behind the scan, the frame was cut off
+    };
+
+    const char *mjpegCheckToString(MjpegCheck check);
+
+    // Padding a UVC payload may carry behind the EOI, a frame without an EOI in there is cut off
+    inline constexpr size_t EOI_SEARCH_WINDOW = 256;
+
+    // Size of the DHT segment with the four standard tables, marker included
+    inline constexpr size_t STANDARD_DHT_SIZE = 420;
+
+    struct MjpegFrameInfo {
+        size_t length = 0;       // up to and including EOI, trailing padding is cut off
+        size_t scanOffset = 0;   // offset of the SOS marker, missing tables go in front of it
+        uint16_t width = 0;      // from the SOF segment, 0 if there was none
+        uint16_t height = 0;
+        bool hasHuffmanTables = false;
+
+        [[nodiscard]] size_t completedSize() const {
+            return length + (hasHuffmanTables ? 0 : STANDARD_DHT_SIZE);
+        }
+    };
+
+    MjpegCheck inspectMjpeg(const uint8_t *frame, size_t size, MjpegFrameInfo &info);
+
+    /*
+     * Copies an inspected frame to dst, inserting the standard Huffman tables if the frame
+     * has none. dst must hold info.completedSize() bytes. Returns the bytes written.
+     */
+    size_t completeMjpeg(const uint8_t *frame, const MjpegFrameInfo &info, uint8_t *dst);
+
+}  // namespace imaging
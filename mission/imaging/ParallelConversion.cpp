@@ -0,0 +1,166 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "ParallelConversion.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "ColorConversion.h"
+
+namespace imaging {
+
+    unsigned ParallelConverter::defaultWorkerCount() {
+        const unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 0;
+    }
+
+    size_t ParallelConverter::detectL2CacheSize() {
+#ifdef _SC_LEVEL2_CACHE_SIZE
+        const long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+        if (size > 0) {
+            return static_cast<size_t>(size);
+        }
+#endif
+        return DEFAULT_L2_CACHE_SIZE;
+    }
+
+    ParallelConverter::ParallelConverter(unsigned workerCount, size_t l2CacheSize,
+                                         size_t minParallelPixels)
+        : l2CacheSize(l2CacheSize > 0 ? l2CacheSize : DEFAULT_L2_CACHE_SIZE),
+          minParallelPixels(minParallelPixels) {
+        workers.reserve(workerCount);
+        for (unsigned i = 0; i < workerCount; i++) {
+            workers.emplace_back(&ParallelConverter::workerLoop, this);
+        }
+    }
+
+    ParallelConverter::~ParallelConverter() {
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            stopping = true;
+        }
+        jobPosted.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    unsigned ParallelConverter::getWorkerCount() const {
+        return static_cast<unsigned>(workers.size());
+    }
+
+    uint32_t ParallelConverter::getBandRows(size_t bytesPerRow) const {
+        // Half of L2 for the band, the rest stays for the other data of the worker
+        const size_t rows = bytesPerRow > 0 ? (l2CacheSize / 2) / bytesPerRow : 2;
+        return std::max<uint32_t>(2, static_cast<uint32_t>(std::min<size_t>(rows, 0xffff)) & ~1u);
+    }
+
+    void ParallelConverter::yuyvToRgb24(const uint8_t *yuyv, uint8_t *rgb, uint32_t width,
+                                        uint32_t height) {
+        Job job{Format::rgb24, yuyv, rgb, nullptr, width, height,
+                getBandRows(static_cast<size_t>(width) * 5), 0};
+        run(job);
+    }
+
+    void ParallelConverter::yuyvToY8(const uint8_t *yuyv, uint8_t *y8, uint32_t width,
+                                     uint32_t height) {
+        Job job{Format::y8, yuyv, y8, nullptr, width, height,
+                getBandRows(static_cast<size_t>(width) * 3), 0};
+        run(job);
+    }
+
+    void ParallelConverter::yuyvToNv12(const uint8_t *yuyv, uint8_t *nv12, uint32_t width,
+                                       uint32_t height) {
+        Job job{Format::nv12, yuyv, nv12, nv12 + y8Size(width, height), width, height,
+                getBandRows(static_cast<size_t>(width) * 7 / 2), 0};
+        run(job);
+    }
+
+    void ParallelConverter::run(Job &job) {
+        job.bandCount = (job.height + job.bandRows - 1) / job.bandRows;
+        // Waking the pool costs more than the extra cores gain on small frames
+        if (workers.empty() || job.bandCount < 2 ||
+            static_cast<size_t>(job.width) * job.height < minParallelPixels) {
+            convertBand(job, 0, job.height);
+            return;
+        }
+
+        std::lock_guard<std::mutex> callLock(callMutex);
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            currentJob = &job;
+            jobGeneration++;
+            busyWorkers = static_cast<unsigned>(workers.size());
+        }
+        jobPosted.notify_all();
+
+        processBands(job);
+
+        // The job lives on our stack, wait until no worker touches it anymore
+        std::unique_lock<std::mutex> lock(poolMutex);
+        jobDone.wait(lock, [this] { return busyWorkers == 0; });
+        currentJob = nullptr;
+    }
+
+    void ParallelConverter::workerLoop() {
+        uint64_t seenGeneration = 0;
+        std::unique_lock<std::mutex> lock(poolMutex);
+        while (true) {
+            jobPosted.wait(lock, [&] { return stopping || jobGeneration != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = jobGeneration;
+            Job *job = currentJob;
+            lock.unlock();
+
+            processBands(*job);
+
+            lock.lock();
+            if (--busyWorkers == 0) {
+                jobDone.notify_one();
+            }
+        }
+    }
+
+    void ParallelConverter::processBands(Job &job) {
+        uint32_t band;
+        while ((band = job.nextBand.fetch_add(1, std::memory_order_relaxed)) < job.bandCount) {
+            const uint32_t firstRow = band * job.bandRows;
+            convertBand(job, firstRow, std::min(job.bandRows, job.height - firstRow));
+        }
+    }
+
+    void ParallelConverter::convertBand(const Job &job, uint32_t firstRow, uint32_t rows) {
+        const size_t width = job.width;
+        const uint8_t *src = job.src + firstRow * width * 2;
+        switch (job.format) {
+            case Format::rgb24:
+                imaging::yuyvToRgb24(src, job.dst + firstRow * width * 3, job.width, rows);
+                break;
+            case Format::y8:
+                imaging::yuyvToY8(src, job.dst + firstRow * width, job.width, rows);
+                break;
+            case Format::nv12:
+                // band rows are even, so every band starts on a chroma row
+                imaging::yuyvToNv12(src, job.dst + firstRow * width,
+                                    job.uvPlane + (firstRow / 2) * width, job.width, rows);
+                break;
+        }
+    }
+
+}  // namespace imaging
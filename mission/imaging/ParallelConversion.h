@@ -0,0 +1,102 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace imaging {
+
+    /*
+     * Splits a frame into row bands and converts them on a persistent worker pool with the
+     * kernels of ColorConversion.h. The calling thread works on bands as well, so a pool with
+     * n workers uses n + 1 cores. Bands are sized so that the source and destination rows of
+     * one band fit into half of the L2 cache. Output is identical to the single threaded
+     * functions.
+     *
+     * The conversions are memory bound, so the pool only pays off for large frames: at 1080p
+     * the single threaded AVX2 RGB conversion reached 2291 MPix/s and the pool 1645 MPix/s.
+     * Frames below minParallelPixels are converted on the calling thread alone.
+     *
+     * One conversion runs at a time, concurrent callers are serialized.
+     */
+    class ParallelConverter {
+    public:
+        static constexpr size_t DEFAULT_L2_CACHE_SIZE = 256 * 1024;
+        // Twice 1080p, so 1080p and smaller stay single threaded and 4K is split
+        static constexpr size_t DEFAULT_MIN_PARALLEL_PIXELS = 2 * 1920 * 1080;
+
+        // One worker less than cores, the caller is the last one
+        static unsigned defaultWorkerCount();
+        // L2 size reported by the system or DEFAULT_L2_CACHE_SIZE
+        static size_t detectL2CacheSize();
+
+        explicit ParallelConverter(unsigned workerCount = defaultWorkerCount(),
+                                   size_t l2CacheSize = detectL2CacheSize(),
+                                   size_t minParallelPixels = DEFAULT_MIN_PARALLEL_PIXELS);
+        ~ParallelConverter();
+
+        ParallelConverter(const ParallelConverter &) = delete;
+        ParallelConverter &operator=(const ParallelConverter &) = delete;
+
+        void yuyvToRgb24(const uint8_t *yuyv, uint8_t *rgb, uint32_t width, uint32_t height);
+        void yuyvToY8(const uint8_t *yuyv, uint8_t *y8, uint32_t width, uint32_t height);
+        void yuyvToNv12(const uint8_t *yuyv, uint8_t *nv12, uint32_t width, uint32_t height);
+
+        [[nodiscard]] unsigned getWorkerCount() const;
+        // Even number of rows per band for the given source + destination bytes per row
+        [[nodiscard]] uint32_t getBandRows(size_t bytesPerRow) const;
+
+    private:
+        enum class Format : uint8_t { rgb24, y8, nv12 };
+
+        struct Job {
+            Format format;
+            const uint8_t *src;
+            uint8_t *dst;
+            uint8_t *uvPlane;
+            uint32_t width;
+            uint32_t height;
+            uint32_t bandRows;
+            uint32_t bandCount;
+            std::atomic<uint32_t> nextBand{0};
+        };
+
+        void run(Job &job);
+        void workerLoop();
+        static void processBands(Job &job);
+        static void convertBand(const Job &job, uint32_t firstRow, uint32_t rows);
+
+        size_t l2CacheSize;
+        size_t minParallelPixels;
+        std::vector<std::thread> workers;
+
+        std::mutex callMutex;
+        std::mutex poolMutex;
+        std::condition_variable jobPosted;
+        std::condition_variable jobDone;
+        Job *currentJob = nullptr;
+        uint64_t jobGeneration = 0;
+        unsigned busyWorkers = 0;
+        bool stopping = false;
+    };
+
+}  // namespace imaging
@@ -0,0 +1,334 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "SnapshotWriter.h"
+
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+namespace imaging {
+    namespace {
+        constexpr mode_t FILE_MODE = 0644;
+
+        bool writeAll(int fd, const uint8_t *data, size_t size) {
+            while (size > 0) {
+                const ssize_t written = ::write(fd, data, size);
+                if (written < 0) {
+                    if (errno == EINTR) {
+                        continue;
+                    }
+                    return false;
+                }
+                data += written;
+                size -= static_cast<size_t>(written);
+            }
+            return true;
+        }
+    }  // namespace
+
+    SnapshotBuffer::~SnapshotBuffer() { std::free(memory); }
+
+    SnapshotBuffer::SnapshotBuffer(SnapshotBuffer &&other) noexcept
+        : memory(other.memory), allocated(other.allocated), used(other.used) {
+        other.memory = nullptr;
+        other.allocated = 0;
+        other.used = 0;
+    }
+
+    SnapshotBuffer &SnapshotBuffer::operator=(SnapshotBuffer &&other) noexcept {
+        if (this != &other) {
+            std::free(memory);
+            memory = other.memory;
+            allocated = other.allocated;
+            used = other.used;
+            other.memory = nullptr;
+            other.allocated = 0;
+            other.used = 0;
+        }
+        return *this;
+    }
+
+    bool SnapshotBuffer::resize(size_t size) {
+        if (size > allocated) {
+            return false;
+        }
+        used = size;
+        return true;
+    }
+
+    SnapshotBuffer SnapshotBuffer::allocate(size_t size) {
+        SnapshotBuffer buffer;
+        // Whole pages, so the aligned part of an O_DIRECT write never reads past the end
+        const size_t capacity = (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+        void *memory = nullptr;
+        if (posix_memalign(&memory, ALIGNMENT, capacity > 0 ? capacity : ALIGNMENT) != 0) {
+            return buffer;
+        }
+        buffer.memory = static_cast<uint8_t *>(memory);
+        buffer.allocated = capacity > 0 ? capacity : ALIGNMENT;
+        buffer.used = size;
+        return buffer;
+    }
+
+    SnapshotWriter::SnapshotWriter(size_t queueDepth, bool useDirectIo)
+        : queueDepth(queueDepth > 0 ? queueDepth : 1), directIo(useDirectIo) {
+        statistics.directIo = useDirectIo;
+        thread = std::thread(&SnapshotWriter::writerLoop, this);
+    }
+
+    SnapshotWriter::~SnapshotWriter() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        jobQueued.notify_one();
+        thread.join();
+    }
+
+    SnapshotBuffer SnapshotWriter::acquireBuffer(size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto it = freeBuffers.begin(); it != freeBuffers.end(); ++it) {
+                if (it->capacity() >= size) {
+                    SnapshotBuffer buffer = std::move(*it);
+                    freeBuffers.erase(it);
+                    buffer.resize(size);
+                    return buffer;
+                }
+            }
+        }
+        return SnapshotBuffer::allocate(size);
+    }
+
+    bool SnapshotWriter::submit(std::string path, SnapshotBuffer payload, std::string header) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (queue.size() < queueDepth && !stopping) {
+                queue.push_back(Job{std::move(path), std::move(header), std::move(payload)});
+                statistics.submitted++;
+                statistics.queueDepth = static_cast<uint32_t>(queue.size());
+                if (statistics.queueDepth > statistics.highWaterMark) {
+                    statistics.highWaterMark = statistics.queueDepth;
+                }
+                jobQueued.notify_one();
+                return true;
+            }
+        }
+        recycle(std::move(payload));
+        reject();
+        return false;
+    }
+
+    bool SnapshotWriter::submitCopy(std::string path, const uint8_t *data, size_t size,
+                                    std::string header) {
+        bool full;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            full = queue.size() >= queueDepth;
+        }
+        if (full) {
+            // Do not copy just to get rejected afterwards
+            reject();
+            return false;
+        }
+        SnapshotBuffer buffer = acquireBuffer(size);
+        if (!buffer.isValid()) {
+            std::lock_guard<std::mutex> lock(mutex);
+            statistics.failed++;
+            return false;
+        }
+        std::memcpy(buffer.data(), data, size);
+        return submit(std::move(path), std::move(buffer), std::move(header));
+    }
+
+    void SnapshotWriter::flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        jobFinished.wait(lock, [this] { return queue.empty() && !writing; });
+    }
+
+    SnapshotWriter::Statistics SnapshotWriter::getStatistics() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        Statistics copy = statistics;
+        copy.directIo = directIo;
+        return copy;
+    }
+
+    void SnapshotWriter::setSaturationCallback(SaturationCallback callback) {
+        std::lock_guard<std::mutex> lock(mutex);
+        saturationCallback = std::move(callback);
+    }
+
+    void SnapshotWriter::reject() {
+        Statistics saturationSnapshot;
+        SaturationCallback callback;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            statistics.rejected++;
+            if (saturated) {
+                // Report once per saturation period, not for every rejected frame
+                return;
+            }
+            saturated = true;
+            statistics.saturationEvents++;
+            saturationSnapshot = statistics;
+            saturationSnapshot.directIo = directIo;
+            callback = saturationCallback;
+        }
+        if (callback) {
+            callback(saturationSnapshot);
+        }
+    }
+
+    void SnapshotWriter::recycle(SnapshotBuffer buffer) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (buffer.isValid() && freeBuffers.size() < queueDepth) {
+            freeBuffers.push_back(std::move(buffer));
+        }
+    }
+
+    void SnapshotWriter::writerLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            jobQueued.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                // stopping and drained
+                return;
+            }
+            Job job = std::move(queue.front());
+            queue.pop_front();
+            writing = true;
+            lock.unlock();
+
+            const auto start = std::chrono::steady_clock::now();
+            const bool ok = writeJob(job);
+            const auto writeTimeUs = std::chrono::duration_cast<std::chrono::microseconds>(
+                                         std::chrono::steady_clock::now() - start)
+                                         .count();
+
+            lock.lock();
+            writing = false;
+            if (ok) {
+                statistics.written++;
+                statistics.bytesWritten += job.header.size() + job.payload.size();
+            } else {
+                statistics.failed++;
+            }
+            if (static_cast<uint64_t>(writeTimeUs) > statistics.maxWriteTimeUs) {
+                statistics.maxWriteTimeUs = static_cast<uint32_t>(writeTimeUs);
+            }
+            statistics.queueDepth = static_cast<uint32_t>(queue.size());
+            if (saturated && queue.size() <= queueDepth / 2) {
+                saturated = false;
+            }
+            if (job.payload.isValid() && freeBuffers.size() < queueDepth) {
+                freeBuffers.push_back(std::move(job.payload));
+            }
+            jobFinished.notify_all();
+        }
+    }
+
+    bool SnapshotWriter::writeJob(const Job &job) {
+#ifdef O_DIRECT
+        if (job.header.empty() && directIo) {
+            return writeDirect(job);
+        }
+#endif
+        return writeBuffered(job);
+    }
+
+    bool SnapshotWriter::writeDirect(const Job &job) {
+#ifdef O_DIRECT
+        const int fd = ::open(job.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, FILE_MODE);
+        if (fd < 0) {
+            if (errno == EINVAL) {
+                // File system without O_DIRECT (tmpfs), do not try again
+                directIo = false;
+                return writeBuffered(job);
+            }
+            return false;
+        }
+        const size_t alignedSize = job.payload.size() & ~(SnapshotBuffer::ALIGNMENT - 1);
+        size_t done = 0;
+        bool ok = true;
+        while (done < alignedSize) {
+            const ssize_t written = ::write(fd, job.payload.data() + done, alignedSize - done);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ok = errno == EINVAL;
+                break;
+            }
+            done += static_cast<size_t>(written);
+        }
+        // The tail is not a multiple of the block size, finish it through the page cache
+        if (ok && done < job.payload.size()) {
+            const int flags = fcntl(fd, F_GETFL);
+            ok = flags >= 0 && fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0 &&
+                 writeAll(fd, job.payload.data() + done, job.payload.size() - done);
+        }
+        return ::close(fd) == 0 && ok;
+#else
+        return writeBuffered(job);
+#endif
+    }
+
+    bool SnapshotWriter::writeBuffered(const Job &job) {
+        const int fd = ::open(job.path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, FILE_MODE);
+        if (fd < 0) {
+            return false;
+        }
+        iovec vectors[2];
+        int vectorCount = 0;
+        if (!job.header.empty()) {
+            vectors[vectorCount++] = {const_cast<char *>(job.header.data()), job.header.size()};
+        }
+        vectors[vectorCount++] = {const_cast<uint8_t *>(job.payload.data()), job.payload.size()};
+
+        size_t remaining = job.header.size() + job.payload.size();
+        iovec *current = vectors;
+        bool ok = true;
+        while (remaining > 0) {
+            const ssize_t written = ::writev(fd, current, vectorCount);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ok = false;
+                break;
+            }
+            remaining -= static_cast<size_t>(written);
+            // Skip what was written, usually everything on the first call
+            size_t skip = static_cast<size_t>(written);
+            while (vectorCount > 0 && skip >= current->iov_len) {
+                skip -= current->iov_len;
+                current++;
+                vectorCount--;
+            }
+            if (vectorCount > 0) {
+                current->iov_base = static_cast<uint8_t *>(current->iov_base) + skip;
+                current->iov_len -= skip;
+            }
+        }
+        return ::close(fd) == 0 && ok;
+    }
+
+}  // namespace imaging
@@ -0,0 +1,148 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace imaging {
+
+    /*
+     * Page aligned buffer handed from the producer to the SnapshotWriter. Buffers are
+     * recycled by the writer, so after warm up no memory is allocated per frame.
+     */
+    class SnapshotBuffer {
+    public:
+        static constexpr size_t ALIGNMENT = 4096;
+
+        SnapshotBuffer() = default;
+        ~SnapshotBuffer();
+        SnapshotBuffer(SnapshotBuffer &&other) noexcept;
+        SnapshotBuffer &operator=(SnapshotBuffer &&other) noexcept;
+        SnapshotBuffer(const SnapshotBuffer &) = delete;
+        SnapshotBuffer &operator=(const SnapshotBuffer &) = delete;
+
+        [[nodiscard]] uint8_t *data() { return memory; }
+        [[nodiscard]] const uint8_t *data() const { return memory; }
+        [[nodiscard]] size_t size() const { return used; }
+        [[nodiscard]] size_t capacity() const { return allocated; }
+        [[nodiscard]] bool isValid() const { return memory != nullptr; }
+        // Only shrinks or grows within the capacity
+        bool resize(size_t size);
+
+    private:
+        friend class SnapshotWriter;
+        static SnapshotBuffer allocate(size_t size);
+
+        uint8_t *memory = nullptr;
+        size_t allocated = 0;
+        size_t used = 0;
+    };
+
+    /*
+     * Write-behind stage for snapshots. Producers hand over a filled buffer and return
+     * immediately, a dedicated thread writes it to disk. The queue is bounded: when it is
+     * full the snapshot is rejected instead of blocking the producer, so a slow disk can
+     * never stall the capture path. Each transition into saturation is counted and
+     * reported through the saturation callback.
+     *
+     * Files without a header are written with O_DIRECT when the file system supports it,
+     * header + payload go out with a single writev.
+     */
+    class SnapshotWriter {
+    public:
+        static constexpr size_t DEFAULT_QUEUE_DEPTH = 8;
+
+        struct Statistics {
+            uint64_t submitted = 0;
+            uint64_t written = 0;
+            uint64_t failed = 0;
+            // Snapshots dropped because the queue was full
+            uint64_t rejected = 0;
+            uint64_t bytesWritten = 0;
+            uint32_t saturationEvents = 0;
+            uint32_t queueDepth = 0;
+            uint32_t highWaterMark = 0;
+            uint32_t maxWriteTimeUs = 0;
+            bool directIo = false;
+        };
+
+        // Called from the submitting thread when the queue runs full
+        using SaturationCallback = std::function<void(const Statistics &statistics)>;
+
+        explicit SnapshotWriter(size_t queueDepth = DEFAULT_QUEUE_DEPTH, bool useDirectIo = true);
+        // Writes all queued snapshots before returning
+        ~SnapshotWriter();
+
+        SnapshotWriter(const SnapshotWriter &) = delete;
+        SnapshotWriter &operator=(const SnapshotWriter &) = delete;
+
+        // Recycled buffer with at least size bytes, invalid if the allocation failed
+        SnapshotBuffer acquireBuffer(size_t size);
+        // Returns false if the queue is full, the buffer is recycled in that case
+        bool submit(std::string path, SnapshotBuffer payload, std::string header = {});
+        // Copying convenience for callers which need their source buffer back right away
+        bool submitCopy(std::string path, const uint8_t *data, size_t size,
+                        std::string header = {});
+
+        // Blocks until everything queued so far is on disk
+        void flush();
+        [[nodiscard]] Statistics getStatistics() const;
+        // Writer thread, e.g. to keep the disk I/O off the cores of the capture path
+        [[nodiscard]] std::thread::native_handle_type getThreadHandle() { return thread.native_handle(); }
+        void setSaturationCallback(SaturationCallback callback);
+
+    private:
+        struct Job {
+            std::string path;
+            std::string header;
+            SnapshotBuffer payload;
+        };
+
+        void writerLoop();
+        bool writeJob(const Job &job);
+        bool writeDirect(const Job &job);
+        bool writeBuffered(const Job &job);
+        void reject();
+        void recycle(SnapshotBuffer buffer);
+
+        const size_t queueDepth;
+        std::atomic<bool> directIo;
+
+        mutable std::mutex mutex;
+        std::condition_variable jobQueued;
+        std::condition_variable jobFinished;
+        std::deque<Job> queue;
+        std::vector<SnapshotBuffer> freeBuffers;
+        bool writing = false;
+        bool saturated = false;
+        bool stopping = false;
+        Statistics statistics;
+        SaturationCallback saturationCallback;
+
+        std::thread thread;
+    };
+
+}  // namespace imaging
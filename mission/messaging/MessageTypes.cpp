@@ -23,6 +23,9 @@ namespace messagetypes::mission::webcam {
                 case ::webcam::CommandId::commandTakeSnapshot:
                 case ::webcam::CommandId::commandSetFrameRate:
                 case ::webcam::CommandId::commandGetFrameRate:
+                case ::webcam::CommandId::commandStartStream:
+                case ::webcam::CommandId::commandStopStream:
+                case ::webcam::CommandId::commandBurst:
                     return true;
                 default:
                     return false;
@@ -31,6 +34,10 @@ namespace messagetypes::mission::webcam {
         constexpr bool isValidParameter(::webcam::ParameterId parameter) {
             switch (parameter) {
                 case ::webcam::ParameterId::parameterFrameRate:
+                case ::webcam::ParameterId::parameterJpegQuality:
+                case ::webcam::ParameterId::parameterChangeThreshold:
+                case ::webcam::ParameterId::parameterAutoExposure:
+                case ::webcam::ParameterId::parameterExposureTarget:
                     return true;
                 default:
                     return false;
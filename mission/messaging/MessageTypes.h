@@ -26,7 +26,14 @@ namespace messagetypes::mission::webcam {
     inline constexpr DeviceCommandId_t TAKE_SNAPSHOT = static_cast<DeviceCommandId_t>(::webcam::CommandId::commandTakeSnapshot);
     inline constexpr DeviceCommandId_t SET_FRAME_RATE = static_cast<DeviceCommandId_t>(::webcam::CommandId::commandSetFrameRate);
     inline constexpr DeviceCommandId_t GET_FRAME_RATE = static_cast<DeviceCommandId_t>(::webcam::CommandId::commandGetFrameRate);
+    inline constexpr DeviceCommandId_t START_STREAM = static_cast<DeviceCommandId_t>(::webcam::CommandId::commandStartStream);
+    inline constexpr DeviceCommandId_t STOP_STREAM = static_cast<DeviceCommandId_t>(::webcam::CommandId::commandStopStream);
+    inline constexpr DeviceCommandId_t BURST = static_cast<DeviceCommandId_t>(::webcam::CommandId::commandBurst);
     inline constexpr uint8_t PARAM_FRAME_RATE = static_cast<uint8_t>(::webcam::ParameterId::parameterFrameRate);
+    inline constexpr uint8_t PARAM_JPEG_QUALITY = static_cast<uint8_t>(::webcam::ParameterId::parameterJpegQuality);
+    inline constexpr uint8_t PARAM_CHANGE_THRESHOLD = static_cast<uint8_t>(::webcam::ParameterId::parameterChangeThreshold);
+    inline constexpr uint8_t PARAM_AUTO_EXPOSURE = static_cast<uint8_t>(::webcam::ParameterId::parameterAutoExposure);
+    inline constexpr uint8_t PARAM_EXPOSURE_TARGET = static_cast<uint8_t>(::webcam::ParameterId::parameterExposureTarget);
     [[nodiscard]] bool rawToCommand(DeviceCommandId_t rawId, ::webcam::CommandId &command);
     [[nodiscard]] DeviceCommandId_t commandToRaw(::webcam::CommandId command);
     [[nodiscard]] bool rawToParameter(uint8_t rawId, ::webcam::ParameterId &parameter);
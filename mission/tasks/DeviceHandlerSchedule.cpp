@@ -0,0 +1,116 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "DeviceHandlerSchedule.h"
+
+#include <fsfw/devicehandlers/DeviceHandlerIF.h>
+#include <fsfw/objectmanager/ObjectManager.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+#include <fsfw/tasks/PeriodicTaskIF.h>
+
+#include <string>
+
+#include "TimedExecutable.h"
+
+namespace tasks {
+    namespace {
+        const char *const STEP_NAMES[DeviceHandlerSlots::STEP_COUNT] = {
+            "operation", "sendWrite", "getWrite", "sendRead", "getRead"};
+    }  // namespace
+
+    DeviceHandlerSlots DeviceHandlerSlots::evenlySpread(uint32_t periodMs) {
+        DeviceHandlerSlots slots;
+        const uint32_t step = periodMs / STEP_COUNT;
+        slots.periodMs = periodMs;
+        slots.performOperationMs = 0;
+        slots.sendWriteMs = step;
+        slots.getWriteMs = 2 * step;
+        slots.sendReadMs = 3 * step;
+        slots.getReadMs = 4 * step;
+        return slots;
+    }
+
+    std::array<uint32_t, DeviceHandlerSlots::STEP_COUNT> DeviceHandlerSlots::offsets() const {
+        std::array<uint32_t, STEP_COUNT> result{};
+        result[DeviceHandlerIF::PERFORM_OPERATION] = performOperationMs;
+        result[DeviceHandlerIF::SEND_WRITE] = sendWriteMs;
+        result[DeviceHandlerIF::GET_WRITE] = getWriteMs;
+        result[DeviceHandlerIF::SEND_READ] = sendReadMs;
+        result[DeviceHandlerIF::GET_READ] = getReadMs;
+        return result;
+    }
+
+    uint32_t DeviceHandlerSlots::slotLengthMs(size_t step) const {
+        const std::array<uint32_t, STEP_COUNT> times = offsets();
+        if (step >= STEP_COUNT) {
+            return 0;
+        }
+        const uint32_t end = step + 1 < STEP_COUNT ? times[step + 1] : periodMs + times[0];
+        return end > times[step] ? end - times[step] : 0;
+    }
+
+    bool DeviceHandlerSlots::isValid() const {
+        const std::array<uint32_t, STEP_COUNT> times = offsets();
+        for (size_t step = 1; step < STEP_COUNT; step++) {
+            if (times[step] <= times[step - 1]) {
+                return false;
+            }
+        }
+        return times[STEP_COUNT - 1] < periodMs;
+    }
+
+    FixedTimeslotTaskIF *createDeviceHandlerTask(const char *name, TaskPriority priority,
+                                                 object_id_t handler,
+                                                 const DeviceHandlerSlots &slots,
+                                                 bool instrumented) {
+        if (!slots.isValid()) {
+            sif::printError("createDeviceHandlerTask: Invalid slots for %s, the steps must be "
+                            "ascending and within the %u ms period\n",
+                            name, static_cast<unsigned int>(slots.periodMs));
+            return nullptr;
+        }
+        FixedTimeslotTaskIF *task = TaskFactory::instance()->createFixedTimeslotTask(
+            name, priority, PeriodicTaskIF::MINIMUM_STACK_SIZE, slots.periodMs / 1000.0, nullptr);
+        if (task == nullptr) {
+            return nullptr;
+        }
+        const std::array<uint32_t, DeviceHandlerSlots::STEP_COUNT> times = slots.offsets();
+        auto *executable = ObjectManager::instance()->get<ExecutableObjectIF>(handler);
+        if (executable == nullptr) {
+            sif::printError("createDeviceHandlerTask: Object 0x%08x is not executable\n",
+                            static_cast<unsigned int>(handler));
+            return nullptr;
+        }
+        for (size_t step = 0; step < times.size(); step++) {
+            ExecutableObjectIF *slotObject =
+                instrumented ? TimedExecutable::wrap(executable,
+                                                     std::string(name) + "/" + STEP_NAMES[step],
+                                                     slots.periodMs,
+                                                     slots.slotLengthMs(step) * 1000)
+                             : executable;
+            ReturnValue_t result =
+                task->addSlot(handler, slotObject, times[step], static_cast<int8_t>(step));
+            if (result != returnvalue::OK) {
+                return nullptr;
+            }
+        }
+        if (task->checkSequence() != returnvalue::OK) {
+            sif::printError("createDeviceHandlerTask: Sequence check of %s failed\n", name);
+            return nullptr;
+        }
+        return task;
+    }
+
+}  // namespace tasks
@@ -0,0 +1,62 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <fsfw/objectmanager/SystemObjectIF.h>
+#include <fsfw/tasks/FixedTimeslotTaskIF.h>
+#include <fsfw/tasks/TaskFactory.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace tasks {
+
+    /*
+     * Fixed timeslot schedule of the DeviceHandlerBase communication steps. Spreading the
+     * steps over the period pipelines a device: the ComIF works on the command between send
+     * and read instead of all steps running back to back in one slot. Offsets in ms from the
+     * start of the period, strictly ascending in step order.
+     */
+    struct DeviceHandlerSlots {
+        static constexpr size_t STEP_COUNT = 5;
+
+        uint32_t periodMs = 100;
+        uint32_t performOperationMs = 0;
+        uint32_t sendWriteMs = 20;   // send the command
+        uint32_t getWriteMs = 40;    // check that it was sent
+        uint32_t sendReadMs = 60;    // request the reply
+        uint32_t getReadMs = 80;     // read and interpret the reply
+
+        // The steps evenly spread over the period
+        static DeviceHandlerSlots evenlySpread(uint32_t periodMs);
+
+        // Indexed by the DeviceHandlerIF step
+        [[nodiscard]] std::array<uint32_t, STEP_COUNT> offsets() const;
+        // Time until the next step starts, the last one ends with the period
+        [[nodiscard]] uint32_t slotLengthMs(size_t step) const;
+        [[nodiscard]] bool isValid() const;
+    };
+
+    // nullptr if the schedule is invalid or the task could not be created. The name must
+    // outlive the task. Instrumented steps are recorded as "<name>/<step>" with the slot
+    // length as deadline, see TimedExecutable.
+    FixedTimeslotTaskIF *createDeviceHandlerTask(const char *name, TaskPriority priority,
+                                                 object_id_t handler,
+                                                 const DeviceHandlerSlots &slots,
+                                                 bool instrumented = false);
+
+}  // namespace tasks
@@ -0,0 +1,198 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "EventDrivenTask.h"
+
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fsfw/objectmanager/ObjectManager.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#include "mission/timing/LatencyHistogram.h"
+
+namespace tasks {
+
+    EventDrivenTask::EventDrivenTask(std::string name, TaskPeriod periodSeconds)
+        : name(std::move(name)),
+          periodMs(static_cast<uint32_t>(periodSeconds * 1000.0)),
+          epollFd(epoll_create1(EPOLL_CLOEXEC)),
+          stopFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {
+        if (periodMs == 0) {
+            periodMs = 1;
+        }
+        if (epollFd < 0 || stopFd < 0 || addWakeupFd(stopFd) != returnvalue::OK) {
+            sif::printError("EventDrivenTask %s: Creating the event descriptors failed: %s\n",
+                            this->name.c_str(), std::strerror(errno));
+        }
+    }
+
+    EventDrivenTask::~EventDrivenTask() {
+        stop();
+        if (stopFd >= 0) {
+            close(stopFd);
+        }
+        if (epollFd >= 0) {
+            close(epollFd);
+        }
+    }
+
+    ReturnValue_t EventDrivenTask::addWakeupFd(int fd) {
+        if (epollFd < 0 || fd < 0) {
+            return returnvalue::FAILED;
+        }
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) != 0) {
+            sif::printWarning("EventDrivenTask %s: epoll_ctl failed for fd %d: %s\n",
+                              name.c_str(), fd, std::strerror(errno));
+            return returnvalue::FAILED;
+        }
+        return returnvalue::OK;
+    }
+
+    void EventDrivenTask::setThreadPolicy(const ThreadPolicy &policy) { threadPolicy = policy; }
+
+    ReturnValue_t EventDrivenTask::addComponent(object_id_t object, uint8_t opCode) {
+        auto *executable = ObjectManager::instance()->get<ExecutableObjectIF>(object);
+        if (executable == nullptr) {
+            sif::printError("EventDrivenTask %s: Object 0x%08x is not executable\n", name.c_str(),
+                            static_cast<unsigned int>(object));
+            return returnvalue::FAILED;
+        }
+        return addComponent(executable, opCode);
+    }
+
+    ReturnValue_t EventDrivenTask::addComponent(ExecutableObjectIF *object, uint8_t opCode) {
+        if (object == nullptr || running) {
+            return returnvalue::FAILED;
+        }
+        components.emplace_back(object, opCode);
+        return returnvalue::OK;
+    }
+
+    ReturnValue_t EventDrivenTask::startTask() {
+        if (running || epollFd < 0) {
+            return returnvalue::FAILED;
+        }
+        // Objects added for several steps are only set up once
+        std::vector<ExecutableObjectIF *> initialized;
+        for (auto &component : components) {
+            ExecutableObjectIF *object = component.first;
+            if (std::find(initialized.begin(), initialized.end(), object) != initialized.end()) {
+                continue;
+            }
+            initialized.push_back(object);
+            object->setTaskIF(this);
+            ReturnValue_t result = object->initializeAfterTaskCreation();
+            if (result != returnvalue::OK) {
+                sif::printError("EventDrivenTask %s: initializeAfterTaskCreation failed\n",
+                                name.c_str());
+                return result;
+            }
+        }
+        running = true;
+        thread = std::thread(&EventDrivenTask::taskLoop, this);
+        // Linux limits thread names to 15 characters
+        (void)pthread_setname_np(thread.native_handle(), name.substr(0, 15).c_str());
+        return returnvalue::OK;
+    }
+
+    ReturnValue_t EventDrivenTask::sleepFor(uint32_t ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return returnvalue::OK;
+    }
+
+    uint32_t EventDrivenTask::getPeriodMs() const { return periodMs; }
+
+    bool EventDrivenTask::isEmpty() const { return components.empty(); }
+
+    void EventDrivenTask::stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        const uint64_t increment = 1;
+        (void)write(stopFd, &increment, sizeof(increment));
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    uint64_t EventDrivenTask::getEventCycles() const {
+        return eventCycles.load(std::memory_order_relaxed);
+    }
+
+    uint64_t EventDrivenTask::getPeriodicCycles() const {
+        return periodicCycles.load(std::memory_order_relaxed);
+    }
+
+    void EventDrivenTask::taskLoop() {
+        if (!threadPolicy.isDefault()) {
+            threadPolicy.applyToCurrentThread(name.c_str());
+        }
+        const uint64_t periodUs = static_cast<uint64_t>(periodMs) * 1000;
+        uint64_t nextPeriodUs = timing::monotonicTimeUs() + periodUs;
+        epoll_event events[MAX_EVENTS];
+        while (running) {
+            uint64_t nowUs = timing::monotonicTimeUs();
+            const int timeoutMs =
+                nextPeriodUs > nowUs ? static_cast<int>((nextPeriodUs - nowUs + 999) / 1000) : 0;
+            const int count = epoll_wait(epollFd, events, MAX_EVENTS, timeoutMs);
+            if (count < 0 && errno != EINTR) {
+                sif::printError("EventDrivenTask %s: epoll_wait failed: %s\n", name.c_str(),
+                                std::strerror(errno));
+                return;
+            }
+            for (int index = 0; index < count; index++) {
+                // Level triggered, an undrained descriptor would wake us again right away
+                uint64_t value = 0;
+                (void)read(events[index].data.fd, &value, sizeof(value));
+            }
+            if (!running) {
+                return;
+            }
+
+            nowUs = timing::monotonicTimeUs();
+            if (nowUs >= nextPeriodUs) {
+                periodicCycles.fetch_add(1, std::memory_order_relaxed);
+                nextPeriodUs += periodUs;
+                if (nextPeriodUs <= nowUs) {
+                    // Overran by more than a period, do not run the missed ones back to back
+                    nextPeriodUs = nowUs + periodUs;
+                }
+            } else if (count > 0) {
+                eventCycles.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                continue;
+            }
+            runCycle();
+        }
+    }
+
+    void EventDrivenTask::runCycle() {
+        for (auto &component : components) {
+            component.first->performOperation(component.second);
+        }
+    }
+
+}  // namespace tasks
@@ -0,0 +1,88 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <fsfw/objectmanager/SystemObjectIF.h>
+#include <fsfw/tasks/ExecutableObjectIF.h>
+#include <fsfw/tasks/PeriodicTaskIF.h>
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "ThreadPolicy.h"
+
+namespace tasks {
+
+    /*
+     * Periodic task which also runs a cycle as soon as one of its wakeup file descriptors
+     * becomes readable, so a frame or a queued command is handled within milliseconds and
+     * the period only paces the work nobody signals, e.g. housekeeping. The task sleeps in
+     * epoll_wait in between, there is no polling.
+     *
+     * A cycle calls performOperation() of every component in the order added. A device
+     * handler is added once per communication step, as in a fixed timeslot sequence.
+     * Wakeup descriptors must be eventfds or timerfds, they are drained after every wakeup.
+     */
+    class EventDrivenTask : public PeriodicTaskIF {
+    public:
+        EventDrivenTask(std::string name, TaskPeriod periodSeconds);
+        ~EventDrivenTask() override;
+
+        EventDrivenTask(const EventDrivenTask &) = delete;
+        EventDrivenTask &operator=(const EventDrivenTask &) = delete;
+
+        // The descriptor stays owned by the caller and must outlive the task
+        ReturnValue_t addWakeupFd(int fd);
+        // Applied by the task thread when it starts, set before startTask()
+        void setThreadPolicy(const ThreadPolicy &policy);
+
+        ReturnValue_t addComponent(object_id_t object, uint8_t opCode = 0) override;
+        ReturnValue_t addComponent(ExecutableObjectIF *object, uint8_t opCode = 0) override;
+        ReturnValue_t startTask() override;
+        ReturnValue_t sleepFor(uint32_t ms) override;
+        [[nodiscard]] uint32_t getPeriodMs() const override;
+        [[nodiscard]] bool isEmpty() const override;
+
+        // Stops and joins the task thread, also done by the destructor
+        void stop();
+
+        // Cycles started by a wakeup descriptor and by the period
+        [[nodiscard]] uint64_t getEventCycles() const;
+        [[nodiscard]] uint64_t getPeriodicCycles() const;
+
+    private:
+        static constexpr int MAX_EVENTS = 8;
+
+        void taskLoop();
+        void runCycle();
+
+        std::string name;
+        uint32_t periodMs;
+        int epollFd = -1;
+        int stopFd = -1;
+        std::vector<std::pair<ExecutableObjectIF *, uint8_t>> components;
+        ThreadPolicy threadPolicy;
+        std::thread thread;
+        std::atomic<bool> running{false};
+        std::atomic<uint64_t> eventCycles{0};
+        std::atomic<uint64_t> periodicCycles{0};
+    };
+
+}  // namespace tasks
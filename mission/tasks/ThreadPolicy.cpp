@@ -0,0 +1,181 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "ThreadPolicy.h"
+
+#include <alloca.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+namespace tasks {
+    namespace {
+        int toSchedPolicy(ThreadPolicy::Scheduling scheduling) {
+            switch (scheduling) {
+                case ThreadPolicy::Scheduling::fifo:
+                    return SCHED_FIFO;
+                case ThreadPolicy::Scheduling::roundRobin:
+                    return SCHED_RR;
+                default:
+                    return SCHED_OTHER;
+            }
+        }
+
+        // Touches every page of the next bytes of stack below the caller, so later calls
+        // find them mapped. Not inlined, the alloca has to be freed on return.
+        __attribute__((noinline)) void prefaultStack(size_t bytes) {
+            const long pageSize = sysconf(_SC_PAGESIZE);
+            const size_t step = pageSize > 0 ? static_cast<size_t>(pageSize) : 4096;
+            auto *stack = static_cast<volatile uint8_t *>(alloca(bytes));
+            for (size_t offset = 0; offset < bytes; offset += step) {
+                stack[offset] = 0;
+            }
+        }
+
+        std::mutex appliersMutex;
+        std::vector<std::unique_ptr<ThreadPolicyApplier>> appliers;
+    }  // namespace
+
+    ThreadPolicy ThreadPolicy::realtime(int priority, uint64_t cpus, size_t stackPrefault) {
+        ThreadPolicy policy;
+        policy.scheduling = Scheduling::fifo;
+        policy.priority = priority;
+        policy.cpus = cpus;
+        policy.stackPrefault = stackPrefault;
+        return policy;
+    }
+
+    ThreadPolicy ThreadPolicy::background(uint64_t cpus) {
+        ThreadPolicy policy;
+        policy.cpus = cpus;
+        return policy;
+    }
+
+    uint64_t ThreadPolicy::cpuRange(unsigned first, unsigned count) {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        uint64_t cpus = 0;
+        for (unsigned cpu = first; cpu < first + count && cpu < 64; cpu++) {
+            if (online > 0 && cpu < static_cast<unsigned long>(online)) {
+                cpus |= uint64_t(1) << cpu;
+            }
+        }
+        return cpus;
+    }
+
+    bool ThreadPolicy::isDefault() const {
+        return scheduling == Scheduling::normal && cpus == 0 && stackPrefault == 0;
+    }
+
+    bool ThreadPolicy::apply(pthread_t thread, const char *name) const {
+        bool result = true;
+        if (cpus != 0) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (unsigned cpu = 0; cpu < 64; cpu++) {
+                if ((cpus >> cpu) & 1) {
+                    CPU_SET(cpu, &set);
+                }
+            }
+            const int error = pthread_setaffinity_np(thread, sizeof(set), &set);
+            if (error != 0) {
+                sif::printWarning("ThreadPolicy: Pinning %s to cores 0x%llx failed: %s\n", name,
+                                  static_cast<unsigned long long>(cpus), std::strerror(error));
+                result = false;
+            }
+        }
+        if (scheduling != Scheduling::normal) {
+            const int schedPolicy = toSchedPolicy(scheduling);
+            sched_param parameter{};
+            parameter.sched_priority = priority;
+            if (parameter.sched_priority < sched_get_priority_min(schedPolicy)) {
+                parameter.sched_priority = sched_get_priority_min(schedPolicy);
+            } else if (parameter.sched_priority > sched_get_priority_max(schedPolicy)) {
+                parameter.sched_priority = sched_get_priority_max(schedPolicy);
+            }
+            const int error = pthread_setschedparam(thread, schedPolicy, &parameter);
+            if (error != 0) {
+                sif::printWarning("ThreadPolicy: Real time priority %d for %s failed: %s\n",
+                                  parameter.sched_priority, name, std::strerror(error));
+                result = false;
+            }
+        }
+        return result;
+    }
+
+    bool ThreadPolicy::applyToCurrentThread(const char *name) const {
+        const bool result = apply(pthread_self(), name);
+        if (stackPrefault == 0) {
+            return result;
+        }
+        // At most half of the stack, the thread may have been created with a small one
+        size_t bytes = stackPrefault;
+        pthread_attr_t attributes;
+        if (pthread_getattr_np(pthread_self(), &attributes) == 0) {
+            size_t stackSize = 0;
+            if (pthread_attr_getstacksize(&attributes, &stackSize) == 0 && bytes > stackSize / 2) {
+                bytes = stackSize / 2;
+            }
+            pthread_attr_destroy(&attributes);
+        }
+        prefaultStack(bytes);
+        return result;
+    }
+
+    bool lockProcessMemory() {
+        // Faults in and locks what is mapped now, the pools must not page fault later on
+        if (mlockall(MCL_CURRENT) != 0) {
+            sif::printWarning("lockProcessMemory: mlockall failed: %s\n", std::strerror(errno));
+            return false;
+        }
+        // With MCL_ONFAULT later mappings are locked page by page as they are touched, so the
+        // 8 MiB thread stacks do not count fully against RLIMIT_MEMLOCK. The pages locked
+        // above stay resident.
+        int flags = MCL_CURRENT | MCL_FUTURE;
+#ifdef MCL_ONFAULT
+        flags |= MCL_ONFAULT;
+#endif
+        if (mlockall(flags) != 0) {
+            sif::printWarning("lockProcessMemory: mlockall failed: %s\n", std::strerror(errno));
+            return false;
+        }
+        return true;
+    }
+
+    ExecutableObjectIF *ThreadPolicyApplier::create(const ThreadPolicy &policy, const char *name) {
+        std::lock_guard<std::mutex> lock(appliersMutex);
+        appliers.push_back(std::unique_ptr<ThreadPolicyApplier>(new ThreadPolicyApplier(policy, name)));
+        return appliers.back().get();
+    }
+
+    ThreadPolicyApplier::ThreadPolicyApplier(const ThreadPolicy &policy, const char *name)
+        : policy(policy), name(name) {}
+
+    ReturnValue_t ThreadPolicyApplier::performOperation(uint8_t) {
+        if (!applied) {
+            applied = true;
+            policy.applyToCurrentThread(name);
+        }
+        return returnvalue::OK;
+    }
+
+}  // namespace tasks
@@ -0,0 +1,85 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <fsfw/objectmanager/SystemObjectIF.h>
+#include <fsfw/tasks/ExecutableObjectIF.h>
+
+#include <pthread.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace tasks {
+
+    /*
+     * Scheduling policy, CPU affinity and stack prefault of one thread. The default
+     * leaves the thread as it was created. Real time threads are pinned to their own
+     * cores. Their stack is touched once at start, so with lockProcessMemory() the
+     * capture path takes no page faults and does not migrate between cores.
+     *
+     * SCHED_FIFO/RR need CAP_SYS_NICE or an rtprio limit. Without one, apply() warns and
+     * the thread keeps the normal policy. Affinity is applied independently.
+     */
+    struct ThreadPolicy {
+        enum class Scheduling : uint8_t { normal, fifo, roundRobin };
+
+        static constexpr size_t DEFAULT_STACK_PREFAULT = 256 * 1024;
+
+        Scheduling scheduling = Scheduling::normal;
+        int priority = 0;
+        // Bit n pins to core n, 0 leaves the affinity alone
+        uint64_t cpus = 0;
+        size_t stackPrefault = 0;
+
+        static ThreadPolicy realtime(int priority, uint64_t cpus,
+                                     size_t stackPrefault = DEFAULT_STACK_PREFAULT);
+        static ThreadPolicy background(uint64_t cpus);
+        // Cores first..first+count-1 which are online, 0 if none is
+        static uint64_t cpuRange(unsigned first, unsigned count);
+
+        [[nodiscard]] bool isDefault() const;
+        // Scheduling and affinity of any thread, name is only used for the warnings
+        bool apply(pthread_t thread, const char *name) const;
+        // Additionally prefaults the stack, so it has to run on the thread itself
+        bool applyToCurrentThread(const char *name) const;
+    };
+
+    // Locks everything mapped now with its pages faulted in, later mappings on first touch.
+    // Call once the pools are allocated.
+    bool lockProcessMemory();
+
+    /*
+     * For tasks created by the TaskFactory, whose threads are not accessible: applies the
+     * policy on the first performOperation() from inside the task. Add it as the first
+     * component or slot.
+     */
+    class ThreadPolicyApplier : public ExecutableObjectIF {
+    public:
+        // The applier lives until exit
+        static ExecutableObjectIF *create(const ThreadPolicy &policy, const char *name);
+
+        ReturnValue_t performOperation(uint8_t opCode) override;
+
+    private:
+        ThreadPolicyApplier(const ThreadPolicy &policy, const char *name);
+
+        ThreadPolicy policy;
+        const char *name;
+        bool applied = false;
+    };
+
+}  // namespace tasks
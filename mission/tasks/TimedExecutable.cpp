@@ -0,0 +1,79 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "TimedExecutable.h"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <fsfw/objectmanager/ObjectManager.h>
+
+#include "mission/timing/LatencyHistogram.h"
+
+namespace tasks {
+    namespace {
+        std::mutex wrapperMutex;
+        std::vector<std::unique_ptr<TimedExecutable>> wrappers;
+        std::vector<ExecutableObjectIF *> wrappedComponents;
+    }  // namespace
+
+    ExecutableObjectIF *TimedExecutable::wrap(ExecutableObjectIF *component, std::string name,
+                                              uint32_t periodMs, uint32_t budgetUs) {
+        if (component == nullptr) {
+            return nullptr;
+        }
+        timing::ExecutionTiming *statistics =
+            timing::ExecutionTimingRegistry::instance().add(std::move(name), periodMs, budgetUs);
+        if (statistics == nullptr) {
+            return component;
+        }
+        std::lock_guard<std::mutex> lock(wrapperMutex);
+        const bool first = std::find(wrappedComponents.begin(), wrappedComponents.end(),
+                                     component) == wrappedComponents.end();
+        if (first) {
+            wrappedComponents.push_back(component);
+        }
+        wrappers.push_back(
+            std::unique_ptr<TimedExecutable>(new TimedExecutable(component, *statistics, first)));
+        return wrappers.back().get();
+    }
+
+    ExecutableObjectIF *TimedExecutable::wrap(object_id_t component, std::string name,
+                                              uint32_t periodMs, uint32_t budgetUs) {
+        return wrap(ObjectManager::instance()->get<ExecutableObjectIF>(component),
+                    std::move(name), periodMs, budgetUs);
+    }
+
+    TimedExecutable::TimedExecutable(ExecutableObjectIF *component,
+                                     timing::ExecutionTiming &statistics,
+                                     bool initializesComponent)
+        : component(component), statistics(statistics), initializesComponent(initializesComponent) {}
+
+    ReturnValue_t TimedExecutable::performOperation(uint8_t opCode) {
+        const uint64_t startUs = timing::monotonicTimeUs();
+        const ReturnValue_t result = component->performOperation(opCode);
+        statistics.record(startUs, timing::monotonicTimeUs());
+        return result;
+    }
+
+    void TimedExecutable::setTaskIF(PeriodicTaskIF *task) { component->setTaskIF(task); }
+
+    ReturnValue_t TimedExecutable::initializeAfterTaskCreation() {
+        return initializesComponent ? component->initializeAfterTaskCreation() : returnvalue::OK;
+    }
+
+}  // namespace tasks
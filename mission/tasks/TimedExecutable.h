@@ -0,0 +1,57 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <fsfw/objectmanager/SystemObjectIF.h>
+#include <fsfw/tasks/ExecutableObjectIF.h>
+#include <fsfw/tasks/PeriodicTaskIF.h>
+
+#include <cstdint>
+#include <string>
+
+#include "mission/timing/ExecutionTiming.h"
+
+namespace tasks {
+
+    /*
+     * Stands in for a component in a task and records every performOperation() in an
+     * ExecutionTiming of timing::ExecutionTimingRegistry. A component scheduled several
+     * times, e.g. a device handler per communication step, gets one wrapper per entry; only
+     * the first one forwards initializeAfterTaskCreation(), so it still runs once.
+     */
+    class TimedExecutable : public ExecutableObjectIF {
+    public:
+        // Wraps the component, the wrapper lives until exit. Returns the component itself if
+        // it can not be instrumented.
+        static ExecutableObjectIF *wrap(ExecutableObjectIF *component, std::string name,
+                                        uint32_t periodMs, uint32_t budgetUs);
+        static ExecutableObjectIF *wrap(object_id_t component, std::string name,
+                                        uint32_t periodMs, uint32_t budgetUs);
+
+        ReturnValue_t performOperation(uint8_t opCode) override;
+        void setTaskIF(PeriodicTaskIF *task) override;
+        ReturnValue_t initializeAfterTaskCreation() override;
+
+    private:
+        TimedExecutable(ExecutableObjectIF *component, timing::ExecutionTiming &statistics,
+                        bool initializesComponent);
+
+        ExecutableObjectIF *component;
+        timing::ExecutionTiming &statistics;
+        bool initializesComponent;
+    };
+
+}  // namespace tasks
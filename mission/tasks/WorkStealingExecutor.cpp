@@ -0,0 +1,296 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "WorkStealingExecutor.h"
+
+#include <pthread.h>
+
+#include <algorithm>
+#include <chrono>
+
+#include <fsfw/objectmanager/ObjectManager.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+namespace tasks {
+    namespace {
+        // Lets submit() from a worker use the deque of that worker
+        thread_local const WorkStealingExecutor *currentExecutor = nullptr;
+        thread_local unsigned currentWorker = 0;
+    }  // namespace
+
+    unsigned WorkStealingExecutor::defaultWorkerCount() {
+        const unsigned cores = std::thread::hardware_concurrency();
+        return cores > 1 ? cores - 1 : 1;
+    }
+
+    WorkStealingExecutor::WorkStealingExecutor(std::string name, TaskPeriod periodSeconds,
+                                               unsigned workerCount)
+        : name(std::move(name)),
+          periodMs(static_cast<uint32_t>(periodSeconds * 1000.0)),
+          workerCount(std::max(workerCount, 1U)) {
+        if (periodMs == 0) {
+            periodMs = 1;
+        }
+        workers.reserve(this->workerCount);
+        for (unsigned index = 0; index < this->workerCount; index++) {
+            workers.push_back(std::make_unique<Worker>());
+        }
+    }
+
+    WorkStealingExecutor::~WorkStealingExecutor() { stop(); }
+
+    ReturnValue_t WorkStealingExecutor::addComponent(object_id_t object, uint8_t opCode) {
+        auto *executable = ObjectManager::instance()->get<ExecutableObjectIF>(object);
+        if (executable == nullptr) {
+            sif::printError("WorkStealingExecutor %s: Object 0x%08x is not executable\n",
+                            name.c_str(), static_cast<unsigned int>(object));
+            return returnvalue::FAILED;
+        }
+        return addComponent(executable, opCode);
+    }
+
+    ReturnValue_t WorkStealingExecutor::addComponent(ExecutableObjectIF *object, uint8_t opCode) {
+        if (object == nullptr || running) {
+            return returnvalue::FAILED;
+        }
+        auto existing = std::find_if(components.begin(), components.end(),
+                                     [object](const std::unique_ptr<Component> &component) {
+                                         return component->object == object;
+                                     });
+        if (existing != components.end()) {
+            (*existing)->opCodes.push_back(opCode);
+            return returnvalue::OK;
+        }
+        auto component = std::make_unique<Component>();
+        component->object = object;
+        component->opCodes.push_back(opCode);
+        components.push_back(std::move(component));
+        return returnvalue::OK;
+    }
+
+    ReturnValue_t WorkStealingExecutor::startTask() {
+        if (running || stopping) {
+            return returnvalue::FAILED;
+        }
+        for (auto &component : components) {
+            component->object->setTaskIF(this);
+            ReturnValue_t result = component->object->initializeAfterTaskCreation();
+            if (result != returnvalue::OK) {
+                sif::printError("WorkStealingExecutor %s: initializeAfterTaskCreation failed\n",
+                                name.c_str());
+                return result;
+            }
+        }
+        running = true;
+        for (unsigned index = 0; index < workerCount; index++) {
+            Worker &worker = *workers[index];
+            worker.thread = std::thread(&WorkStealingExecutor::workerLoop, this, index);
+            // Linux limits thread names to 15 characters
+            const std::string threadName = name.substr(0, 11) + "/" + std::to_string(index);
+            (void)pthread_setname_np(worker.thread.native_handle(),
+                                     threadName.substr(0, 15).c_str());
+        }
+        releaseThread = std::thread(&WorkStealingExecutor::releaseLoop, this);
+        (void)pthread_setname_np(releaseThread.native_handle(), name.substr(0, 15).c_str());
+        return returnvalue::OK;
+    }
+
+    ReturnValue_t WorkStealingExecutor::sleepFor(uint32_t ms) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+        return returnvalue::OK;
+    }
+
+    uint32_t WorkStealingExecutor::getPeriodMs() const { return periodMs; }
+
+    bool WorkStealingExecutor::isEmpty() const { return components.empty(); }
+
+    void WorkStealingExecutor::setThreadPolicy(const ThreadPolicy &policy) {
+        threadPolicy = policy;
+    }
+
+    bool WorkStealingExecutor::submit(Job job) {
+        if (!running || stopping || !job) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const unsigned index =
+            currentExecutor == this
+                ? currentWorker
+                : nextWorker.fetch_add(1, std::memory_order_relaxed) % workerCount;
+        if (!push(index, job)) {
+            rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    void WorkStealingExecutor::stop() {
+        if (!running.exchange(false)) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(idleMutex);
+            stopping = true;
+        }
+        stopRequested.notify_all();
+        if (releaseThread.joinable()) {
+            releaseThread.join();
+        }
+        // The workers run what is queued before they leave
+        jobQueued.notify_all();
+        for (auto &worker : workers) {
+            if (worker->thread.joinable()) {
+                worker->thread.join();
+            }
+        }
+    }
+
+    WorkStealingExecutor::Statistics WorkStealingExecutor::getStatistics() const {
+        Statistics statistics;
+        statistics.executed = executed.load(std::memory_order_relaxed);
+        statistics.stolen = stolen.load(std::memory_order_relaxed);
+        statistics.rejected = rejected.load(std::memory_order_relaxed);
+        statistics.overruns = overruns.load(std::memory_order_relaxed);
+        return statistics;
+    }
+
+    void WorkStealingExecutor::releaseLoop() {
+        if (!threadPolicy.isDefault()) {
+            threadPolicy.applyToCurrentThread(name.c_str());
+        }
+        const auto period = std::chrono::milliseconds(periodMs);
+        auto nextRelease = std::chrono::steady_clock::now();
+        while (true) {
+            for (auto &component : components) {
+                if (component->busy.exchange(true, std::memory_order_acq_rel)) {
+                    overruns.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                Component *released = component.get();
+                Job job = [this, released] { runComponent(*released); };
+                const unsigned index =
+                    nextWorker.fetch_add(1, std::memory_order_relaxed) % workerCount;
+                if (!push(index, job)) {
+                    released->busy.store(false, std::memory_order_release);
+                    rejected.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            nextRelease += period;
+            const auto now = std::chrono::steady_clock::now();
+            if (nextRelease <= now) {
+                // Overran by more than a period, do not release the missed ones back to back
+                nextRelease = now + period;
+            }
+            std::unique_lock<std::mutex> lock(idleMutex);
+            if (stopRequested.wait_until(lock, nextRelease, [this] { return stopping.load(); })) {
+                return;
+            }
+        }
+    }
+
+    void WorkStealingExecutor::workerLoop(unsigned index) {
+        currentExecutor = this;
+        currentWorker = index;
+        if (!threadPolicy.isDefault()) {
+            threadPolicy.applyToCurrentThread(name.c_str());
+        }
+        Job job;
+        while (true) {
+            if (pop(index, job) || steal(index, job)) {
+                job();
+                job = nullptr;
+                executed.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(idleMutex);
+            jobQueued.wait(lock, [this] { return queuedJobs.load() > 0 || stopping.load(); });
+            if (stopping && queuedJobs.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    bool WorkStealingExecutor::push(unsigned index, Job &job) {
+        Worker &worker = *workers[index];
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (worker.jobs.size() >= MAX_QUEUED_JOBS) {
+                return false;
+            }
+            worker.jobs.push_back(std::move(job));
+            queuedJobs.fetch_add(1);
+        }
+        {
+            // Pairs with the predicate check of a worker about to sleep
+            std::lock_guard<std::mutex> lock(idleMutex);
+        }
+        jobQueued.notify_one();
+        return true;
+    }
+
+    bool WorkStealingExecutor::pop(unsigned index, Job &job) {
+        // Oldest first, a component's offloaded jobs start in the order they were submitted
+        Worker &worker = *workers[index];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.jobs.empty()) {
+            return false;
+        }
+        job = std::move(worker.jobs.front());
+        worker.jobs.pop_front();
+        queuedJobs.fetch_sub(1);
+        return true;
+    }
+
+    bool WorkStealingExecutor::steal(unsigned thief, Job &job) {
+        // Skip busy deques first. If one of them held the queued job, wait for its lock instead
+        // of returning: queuedJobs stays above zero, so the worker loop would spin.
+        bool contended = false;
+        for (int pass = 0; pass < 2; pass++) {
+            for (unsigned offset = 1; offset < workerCount; offset++) {
+                Worker &victim = *workers[(thief + offset) % workerCount];
+                std::unique_lock<std::mutex> lock(victim.mutex, std::defer_lock);
+                if (pass == 0) {
+                    if (!lock.try_lock()) {
+                        contended = true;
+                        continue;
+                    }
+                } else {
+                    lock.lock();
+                }
+                if (victim.jobs.empty()) {
+                    continue;
+                }
+                job = std::move(victim.jobs.front());
+                victim.jobs.pop_front();
+                queuedJobs.fetch_sub(1);
+                stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+            if (!contended) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    void WorkStealingExecutor::runComponent(Component &component) {
+        for (uint8_t opCode : component.opCodes) {
+            component.object->performOperation(opCode);
+        }
+        component.busy.store(false, std::memory_order_release);
+    }
+
+}  // namespace tasks
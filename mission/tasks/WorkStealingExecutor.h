@@ -0,0 +1,139 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <fsfw/objectmanager/SystemObjectIF.h>
+#include <fsfw/tasks/ExecutableObjectIF.h>
+#include <fsfw/tasks/PeriodicTaskIF.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ThreadPolicy.h"
+
+namespace tasks {
+
+    /*
+     * Thread pool for components without real time requirements. Every period each added
+     * component is released as a job, and the jobs run in parallel on the workers. Each
+     * worker has its own deque. An idle worker steals from the other deques, so one long
+     * job, e.g. a TM burst, does not hold up the remaining components. A component runs on
+     * one worker at a time. It calls its steps in the order added. If it is still busy at
+     * the next release, that release is skipped and counted as an overrun.
+     *
+     * Components may also offload jobs with submit(), e.g. formatting or file output. A job
+     * submitted from a worker goes to that worker's deque. Jobs from other threads are spread
+     * round robin. The deques are bounded: submit() rejects a job instead of blocking.
+     * Each deque is taken from the front, by its owner and by thieves, so jobs start in the
+     * order they were queued there. Jobs taken by different workers run concurrently, so
+     * completion order is not guaranteed; a job that depends on another must be submitted by it.
+     */
+    class WorkStealingExecutor : public PeriodicTaskIF {
+    public:
+        using Job = std::function<void()>;
+
+        static constexpr size_t MAX_QUEUED_JOBS = 256;
+
+        struct Statistics {
+            uint64_t executed = 0;
+            // Jobs a worker took from the deque of another worker
+            uint64_t stolen = 0;
+            uint64_t rejected = 0;
+            // Releases skipped because the component was still running
+            uint64_t overruns = 0;
+        };
+
+        // One worker less than cores, the real time tasks keep a core of their own
+        static unsigned defaultWorkerCount();
+
+        WorkStealingExecutor(std::string name, TaskPeriod periodSeconds,
+                             unsigned workerCount = defaultWorkerCount());
+        ~WorkStealingExecutor() override;
+
+        WorkStealingExecutor(const WorkStealingExecutor &) = delete;
+        WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;
+
+        ReturnValue_t addComponent(object_id_t object, uint8_t opCode = 0) override;
+        ReturnValue_t addComponent(ExecutableObjectIF *object, uint8_t opCode = 0) override;
+        ReturnValue_t startTask() override;
+        ReturnValue_t sleepFor(uint32_t ms) override;
+        [[nodiscard]] uint32_t getPeriodMs() const override;
+        [[nodiscard]] bool isEmpty() const override;
+
+        // Workers and the release thread apply it when they start, set before startTask()
+        void setThreadPolicy(const ThreadPolicy &policy);
+        // False if the executor is not running or the deque is full
+        bool submit(Job job);
+        // Stops the release thread, runs the queued jobs and joins the workers
+        void stop();
+
+        [[nodiscard]] unsigned getWorkerCount() const { return workerCount; }
+        [[nodiscard]] Statistics getStatistics() const;
+
+    private:
+        // All steps of one object, released together so they never run concurrently
+        struct Component {
+            ExecutableObjectIF *object;
+            std::vector<uint8_t> opCodes;
+            std::atomic<bool> busy{false};
+        };
+
+        struct Worker {
+            std::mutex mutex;
+            std::deque<Job> jobs;
+            std::thread thread;
+        };
+
+        void releaseLoop();
+        void workerLoop(unsigned index);
+        bool push(unsigned index, Job &job);
+        bool pop(unsigned index, Job &job);
+        bool steal(unsigned thief, Job &job);
+        void runComponent(Component &component);
+
+        std::string name;
+        uint32_t periodMs;
+        const unsigned workerCount;
+        std::vector<std::unique_ptr<Component>> components;
+        std::vector<std::unique_ptr<Worker>> workers;
+        std::thread releaseThread;
+        ThreadPolicy threadPolicy;
+
+        std::atomic<bool> running{false};
+        std::atomic<bool> stopping{false};
+        std::atomic<unsigned> nextWorker{0};
+        // Jobs in all deques, workers sleep while it is zero
+        std::atomic<size_t> queuedJobs{0};
+        std::mutex idleMutex;
+        std::condition_variable jobQueued;
+        std::condition_variable stopRequested;
+
+        std::atomic<uint64_t> executed{0};
+        std::atomic<uint64_t> stolen{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> overruns{0};
+    };
+
+}  // namespace tasks
@@ -0,0 +1,112 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "ExecutionTiming.h"
+
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#include <utility>
+
+namespace timing {
+
+    ExecutionTiming::ExecutionTiming(std::string name, uint32_t periodMs, uint32_t budgetUs)
+        : name(std::move(name)), periodMs(periodMs), budgetUs(budgetUs) {}
+
+    void ExecutionTiming::record(uint64_t startUs, uint64_t endUs) {
+        const uint64_t executionUs = endUs >= startUs ? endUs - startUs : 0;
+        execution.record(executionUs);
+        if (budgetUs != 0 && executionUs > budgetUs) {
+            deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (periodMs != 0 && lastStartUs != 0 && startUs >= lastStartUs) {
+            const uint64_t distanceUs = startUs - lastStartUs;
+            const uint64_t periodUs = static_cast<uint64_t>(periodMs) * 1000;
+            jitter.record(distanceUs >= periodUs ? distanceUs - periodUs : periodUs - distanceUs);
+            // Woken so late that a whole period was skipped
+            if (distanceUs >= 2 * periodUs) {
+                deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        lastStartUs = startUs;
+    }
+
+    ExecutionTiming::Summary ExecutionTiming::summary() const {
+        const LatencyHistogram::Snapshot executionSnapshot = execution.snapshot();
+        const LatencyHistogram::Snapshot jitterSnapshot = jitter.snapshot();
+        Summary result;
+        result.count = executionSnapshot.count;
+        result.minUs = executionSnapshot.minUs;
+        result.meanUs = executionSnapshot.meanUs;
+        result.maxUs = executionSnapshot.maxUs;
+        result.p99Us = executionSnapshot.percentileUs(99);
+        result.deadlineMisses = deadlineMisses.load(std::memory_order_relaxed);
+        result.jitterP99Us = jitterSnapshot.percentileUs(99);
+        result.jitterMaxUs = jitterSnapshot.maxUs;
+        return result;
+    }
+
+    const std::string &ExecutionTiming::getName() const { return name; }
+
+    uint32_t ExecutionTiming::getPeriodMs() const { return periodMs; }
+
+    void ExecutionTiming::reset() {
+        execution.reset();
+        jitter.reset();
+        deadlineMisses.store(0, std::memory_order_relaxed);
+    }
+
+    ExecutionTimingRegistry &ExecutionTimingRegistry::instance() {
+        static ExecutionTimingRegistry registry;
+        return registry;
+    }
+
+    ExecutionTiming *ExecutionTimingRegistry::add(std::string name, uint32_t periodMs,
+                                                  uint32_t budgetUs) {
+        std::lock_guard<std::mutex> lock(addMutex);
+        const size_t index = count.load(std::memory_order_relaxed);
+        if (index >= MAX_ENTRIES) {
+            sif::printWarning("ExecutionTimingRegistry: Full, %s is not instrumented\n",
+                              name.c_str());
+            return nullptr;
+        }
+        entries[index] = std::make_unique<ExecutionTiming>(std::move(name), periodMs, budgetUs);
+        // Publishes the entry to the lock-free readers
+        count.store(index + 1, std::memory_order_release);
+        return entries[index].get();
+    }
+
+    size_t ExecutionTimingRegistry::size() const { return count.load(std::memory_order_acquire); }
+
+    const ExecutionTiming &ExecutionTimingRegistry::at(size_t index) const {
+        return *entries[index];
+    }
+
+    void ExecutionTimingRegistry::logSummary() const {
+        const size_t entryCount = size();
+        for (size_t index = 0; index < entryCount; index++) {
+            const ExecutionTiming::Summary summary = entries[index]->summary();
+            sif::printInfo(
+                "Task timing %s: %u runs, min/mean/max/p99 %u/%u/%u/%u us, %u deadline misses, "
+                "jitter p99/max %u/%u us\n",
+                entries[index]->getName().c_str(), static_cast<unsigned int>(summary.count),
+                static_cast<unsigned int>(summary.minUs), static_cast<unsigned int>(summary.meanUs),
+                static_cast<unsigned int>(summary.maxUs), static_cast<unsigned int>(summary.p99Us),
+                static_cast<unsigned int>(summary.deadlineMisses),
+                static_cast<unsigned int>(summary.jitterP99Us),
+                static_cast<unsigned int>(summary.jitterMaxUs));
+        }
+    }
+
+}  // namespace timing
@@ -0,0 +1,92 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "LatencyHistogram.h"
+
+namespace timing {
+
+    /*
+     * Execution statistics of one scheduled component: execution time, deadline misses and
+     * wake-up jitter, i.e. how far the distance between two starts is off the period.
+     * Recorded by the task thread only, readable from any thread without locking.
+     */
+    class ExecutionTiming {
+    public:
+        struct Summary {
+            uint32_t count = 0;
+            uint32_t minUs = 0;
+            uint32_t meanUs = 0;
+            uint32_t maxUs = 0;
+            uint32_t p99Us = 0;
+            uint32_t deadlineMisses = 0;
+            uint32_t jitterP99Us = 0;
+            uint32_t jitterMaxUs = 0;
+        };
+
+        // A period of 0 skips the jitter (event driven components), a budget of 0 the deadline
+        ExecutionTiming(std::string name, uint32_t periodMs, uint32_t budgetUs);
+
+        void record(uint64_t startUs, uint64_t endUs);
+        [[nodiscard]] Summary summary() const;
+        [[nodiscard]] const std::string &getName() const;
+        [[nodiscard]] uint32_t getPeriodMs() const;
+        void reset();
+
+    private:
+        std::string name;
+        uint32_t periodMs;
+        uint64_t budgetUs;
+        LatencyHistogram execution;
+        LatencyHistogram jitter;
+        std::atomic<uint32_t> deadlineMisses{0};
+        uint64_t lastStartUs = 0;  // task thread only
+    };
+
+    /*
+     * All instrumented components. Entries are added during startup and live until exit, so
+     * readers only need the published count.
+     */
+    class ExecutionTimingRegistry {
+    public:
+        static constexpr size_t MAX_ENTRIES = 32;
+
+        static ExecutionTimingRegistry &instance();
+
+        // nullptr once the registry is full
+        ExecutionTiming *add(std::string name, uint32_t periodMs, uint32_t budgetUs);
+        [[nodiscard]] size_t size() const;
+        [[nodiscard]] const ExecutionTiming &at(size_t index) const;
+        // One line per component
+        void logSummary() const;
+
+    private:
+        ExecutionTimingRegistry() = default;
+
+        std::mutex addMutex;
+        std::array<std::unique_ptr<ExecutionTiming>, MAX_ENTRIES> entries;
+        std::atomic<size_t> count{0};
+    };
+
+}  // namespace timing
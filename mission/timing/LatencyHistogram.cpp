@@ -0,0 +1,108 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "LatencyHistogram.h"
+
+#include <time.h>
+
+namespace timing {
+
+    uint64_t monotonicTimeUs() {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return static_cast<uint64_t>(now.tv_sec) * 1000000ULL +
+               static_cast<uint64_t>(now.tv_nsec) / 1000ULL;
+    }
+
+    uint64_t LatencyHistogram::bucketUpperBoundUs(size_t bucket) {
+        if (bucket == 0) {
+            return 0;
+        }
+        if (bucket >= BUCKET_COUNT - 1) {
+            return UINT32_MAX;
+        }
+        return (1ULL << bucket) - 1;
+    }
+
+    void LatencyHistogram::record(uint64_t latencyUs) {
+        const uint32_t value =
+            latencyUs > UINT32_MAX ? UINT32_MAX : static_cast<uint32_t>(latencyUs);
+        // Index of the highest set bit + 1, 0 for 0 us
+        size_t bucket = value == 0 ? 0 : 32 - static_cast<size_t>(__builtin_clz(value));
+        if (bucket >= BUCKET_COUNT) {
+            bucket = BUCKET_COUNT - 1;
+        }
+        buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        sumUs.fetch_add(value, std::memory_order_relaxed);
+
+        uint32_t current = minUs.load(std::memory_order_relaxed);
+        while (value < current &&
+               !minUs.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+        current = maxUs.load(std::memory_order_relaxed);
+        while (value > current &&
+               !maxUs.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+        // Last, so a reader never sees a count without its sample
+        count.fetch_add(1, std::memory_order_release);
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::snapshot() const {
+        Snapshot result;
+        result.count = count.load(std::memory_order_acquire);
+        if (result.count == 0) {
+            return result;
+        }
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            result.buckets[i] = buckets[i].load(std::memory_order_relaxed);
+        }
+        result.minUs = minUs.load(std::memory_order_relaxed);
+        result.maxUs = maxUs.load(std::memory_order_relaxed);
+        result.meanUs = static_cast<uint32_t>(sumUs.load(std::memory_order_relaxed) / result.count);
+        return result;
+    }
+
+    void LatencyHistogram::reset() {
+        count.store(0, std::memory_order_relaxed);
+        for (auto &bucket : buckets) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        sumUs.store(0, std::memory_order_relaxed);
+        minUs.store(UINT32_MAX, std::memory_order_relaxed);
+        maxUs.store(0, std::memory_order_relaxed);
+    }
+
+    uint32_t LatencyHistogram::Snapshot::percentileUs(uint32_t percent) const {
+        if (count == 0) {
+            return 0;
+        }
+        uint64_t total = 0;
+        for (uint32_t bucketCount : buckets) {
+            total += bucketCount;
+        }
+        // Rank of the sample, rounded up
+        const uint64_t rank = (total * percent + 99) / 100;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += buckets[i];
+            if (seen >= rank && seen > 0) {
+                const uint64_t bound = bucketUpperBoundUs(i);
+                return bound < maxUs ? static_cast<uint32_t>(bound) : maxUs;
+            }
+        }
+        return maxUs;
+    }
+
+}  // namespace timing
@@ -0,0 +1,63 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace timing {
+
+    // CLOCK_MONOTONIC in microseconds, the clock V4L2 uses for its buffer timestamps
+    uint64_t monotonicTimeUs();
+
+    /*
+     * Lock-free latency histogram with power of two buckets in microseconds. Bucket 0 counts
+     * 0 us, bucket i counts [2^(i-1), 2^i) us and the last bucket everything above. Any thread
+     * may record while another one reads a snapshot; the snapshot is not atomic as a whole,
+     * the counters may be off by the samples recorded while it was taken.
+     */
+    class LatencyHistogram {
+    public:
+        static constexpr size_t BUCKET_COUNT = 24;  // the last regular bucket ends at ~4.2 s
+
+        struct Snapshot {
+            uint32_t count = 0;
+            uint32_t minUs = 0;
+            uint32_t maxUs = 0;
+            uint32_t meanUs = 0;
+            std::array<uint32_t, BUCKET_COUNT> buckets{};
+
+            // Upper bound of the bucket holding the given percentile, capped at maxUs
+            [[nodiscard]] uint32_t percentileUs(uint32_t percent) const;
+        };
+
+        static uint64_t bucketUpperBoundUs(size_t bucket);
+
+        void record(uint64_t latencyUs);
+        [[nodiscard]] Snapshot snapshot() const;
+        void reset();
+
+    private:
+        std::array<std::atomic<uint32_t>, BUCKET_COUNT> buckets{};
+        std::atomic<uint32_t> count{0};
+        std::atomic<uint64_t> sumUs{0};
+        std::atomic<uint32_t> minUs{UINT32_MAX};
+        std::atomic<uint32_t> maxUs{0};
+    };
+
+}  // namespace timing
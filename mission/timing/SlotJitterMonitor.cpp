@@ -0,0 +1,71 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "SlotJitterMonitor.h"
+
+namespace timing {
+
+    void SlotJitterMonitor::configure(uint32_t periodMs, const uint32_t *offsetsMs,
+                                      size_t slotCount) {
+        this->slotCount = periodMs == 0 || offsetsMs == nullptr
+                              ? 0
+                              : (slotCount < MAX_SLOTS ? slotCount : MAX_SLOTS);
+        periodUs = static_cast<uint64_t>(periodMs) * 1000;
+        for (size_t slot = 0; slot < this->slotCount; slot++) {
+            offsetsUs[slot] = static_cast<uint64_t>(offsetsMs[slot]) * 1000;
+        }
+        reset();
+    }
+
+    bool SlotJitterMonitor::isConfigured() const { return slotCount > 0; }
+
+    size_t SlotJitterMonitor::getSlotCount() const { return slotCount; }
+
+    void SlotJitterMonitor::record(uint8_t slot, uint64_t nowUs) {
+        if (slot >= slotCount) {
+            return;
+        }
+        if (!epochValid) {
+            if (slot != 0) {
+                return;
+            }
+            // Slot 0 defines the grid, its own jitter is measured from the next cycle on
+            epochUs = nowUs - offsetsUs[0];
+            epochValid = true;
+            return;
+        }
+        const uint64_t slotBaseUs = epochUs + offsetsUs[slot];
+        if (nowUs < slotBaseUs) {
+            jitter[slot].record(slotBaseUs - nowUs);
+            return;
+        }
+        // Nearest cycle of the grid, a slot late by more than half a period counts as early
+        const uint64_t cycle = (nowUs - slotBaseUs + periodUs / 2) / periodUs;
+        const uint64_t expectedUs = slotBaseUs + cycle * periodUs;
+        jitter[slot].record(nowUs >= expectedUs ? nowUs - expectedUs : expectedUs - nowUs);
+    }
+
+    const LatencyHistogram &SlotJitterMonitor::getJitter(size_t slot) const {
+        return jitter[slot < MAX_SLOTS ? slot : MAX_SLOTS - 1];
+    }
+
+    void SlotJitterMonitor::reset() {
+        for (LatencyHistogram &histogram : jitter) {
+            histogram.reset();
+        }
+        epochValid = false;
+    }
+
+}  // namespace timing
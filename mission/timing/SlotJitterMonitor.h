@@ -0,0 +1,57 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "LatencyHistogram.h"
+
+namespace timing {
+
+    /*
+     * Release jitter of the slots of a fixed timeslot schedule, recorded by the scheduled
+     * object itself when a slot starts. The first start of slot 0 fixes the time grid, a slot
+     * is expected at epoch + k * period + offset with k of the nearest cycle; the histogram of
+     * the slot gets |actual - expected|. Slots are the execution steps passed to the object,
+     * e.g. the DeviceHandlerIF communication steps. Recording is single threaded, reading is
+     * safe from any thread.
+     */
+    class SlotJitterMonitor {
+    public:
+        static constexpr size_t MAX_SLOTS = 8;
+
+        // A period of 0 or no slots disables the monitor
+        void configure(uint32_t periodMs, const uint32_t *offsetsMs, size_t slotCount);
+        [[nodiscard]] bool isConfigured() const;
+        [[nodiscard]] size_t getSlotCount() const;
+
+        void record(uint8_t slot, uint64_t nowUs);
+        [[nodiscard]] const LatencyHistogram &getJitter(size_t slot) const;
+        // The grid is fixed again by the next start of slot 0
+        void reset();
+
+    private:
+        uint64_t periodUs = 0;
+        size_t slotCount = 0;
+        std::array<uint64_t, MAX_SLOTS> offsetsUs{};
+        std::array<LatencyHistogram, MAX_SLOTS> jitter{};
+        uint64_t epochUs = 0;
+        bool epochValid = false;
+    };
+
+}  // namespace timing
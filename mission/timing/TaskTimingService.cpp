@@ -0,0 +1,126 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+
+#include "TaskTimingService.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "FSFWConfig.h"
+
+#include <fsfw/serialize/SerializeAdapter.h>
+
+#include "ExecutionTiming.h"
+
+namespace timing {
+    namespace {
+        // first index, entry count and total count, then per entry the name, period and
+        // count, min, mean, max, p99, deadline misses, jitter p99 and max as uint32_t
+        constexpr size_t HEADER_SIZE = 3;
+        constexpr size_t ENTRY_SIZE = TaskTimingService::NAME_SIZE + 9 * sizeof(uint32_t);
+    }
+
+    TaskTimingService::TaskTimingService(object_id_t objectId, uint16_t apid, VerificationReporterIF* reporter)
+        : CommandingServiceBase(objectId, apid, SERVICE_ID, fsfwconfig::FSFW_CSB_FIFO_DEPTH, 60, 20, reporter) {}
+
+    ReturnValue_t TaskTimingService::isValidSubservice(uint8_t subservice) {
+        if (static_cast<Subservice>(subservice) == Subservice::TASK_TIMING_DUMP) {
+            return returnvalue::OK;
+        }
+        return AcceptsTelecommandsIF::INVALID_SUBSERVICE;
+    }
+
+    ReturnValue_t TaskTimingService::getMessageQueueAndObject(uint8_t, const uint8_t*, size_t,
+                                                              MessageQueueId_t* id, object_id_t* objectId) {
+        // Answered by the service itself, there is no target object
+        *id = getRequestQueue();
+        *objectId = getObjectId();
+        return returnvalue::OK;
+    }
+
+    ReturnValue_t TaskTimingService::prepareCommand(CommandMessage*, uint8_t subservice, const uint8_t*,
+                                                    size_t tcDataLen, uint32_t*, object_id_t) {
+        if (static_cast<Subservice>(subservice) != Subservice::TASK_TIMING_DUMP || tcDataLen != 0) {
+            return CommandingServiceBase::INVALID_TC;
+        }
+        const ReturnValue_t result = sendTaskTiming();
+        return result == returnvalue::OK ? CommandingServiceBase::EXECUTION_COMPLETE : result;
+    }
+
+    ReturnValue_t TaskTimingService::handleReply(const CommandMessage*, Command_t, uint32_t*,
+                                                 CommandMessage*, object_id_t, bool*) {
+        // Every command completes in prepareCommand()
+        return CommandingServiceBase::INVALID_REPLY;
+    }
+
+    void TaskTimingService::doPeriodicOperation() {
+        const ExecutionTimingRegistry& registry = ExecutionTimingRegistry::instance();
+        if (registry.size() == 0) {
+            return;
+        }
+        const uint64_t nowUs = monotonicTimeUs();
+        if (nowUs - lastHkUs >= static_cast<uint64_t>(HK_INTERVAL_MS) * 1000) {
+            lastHkUs = nowUs;
+            (void)sendTaskTiming();
+        }
+        if (nowUs - lastLogUs >= static_cast<uint64_t>(LOG_INTERVAL_MS) * 1000) {
+            lastLogUs = nowUs;
+            registry.logSummary();
+        }
+    }
+
+    ReturnValue_t TaskTimingService::sendTaskTiming() {
+        const ExecutionTimingRegistry& registry = ExecutionTimingRegistry::instance();
+        const size_t total = registry.size();
+        for (size_t first = 0; first < total; first += ENTRIES_PER_PACKET) {
+            const size_t entries = std::min(total - first, ENTRIES_PER_PACKET);
+            uint8_t buffer[HEADER_SIZE + ENTRIES_PER_PACKET * ENTRY_SIZE] = {};
+            uint8_t* cursor = buffer;
+            size_t serializedSize = 0;
+            const uint8_t header[HEADER_SIZE] = {static_cast<uint8_t>(first), static_cast<uint8_t>(entries),
+                                                 static_cast<uint8_t>(total)};
+            std::memcpy(cursor, header, sizeof(header));
+            cursor += sizeof(header);
+            serializedSize += sizeof(header);
+            ReturnValue_t result = returnvalue::OK;
+            for (size_t index = first; index < first + entries; index++) {
+                const ExecutionTiming& entry = registry.at(index);
+                // Zero padded, cut off at the field size
+                std::strncpy(reinterpret_cast<char*>(cursor), entry.getName().c_str(), NAME_SIZE);
+                cursor += NAME_SIZE;
+                serializedSize += NAME_SIZE;
+                const ExecutionTiming::Summary summary = entry.summary();
+                const uint32_t values[] = {entry.getPeriodMs(),    summary.count,          summary.minUs,
+                                           summary.meanUs,         summary.maxUs,          summary.p99Us,
+                                           summary.deadlineMisses, summary.jitterP99Us,    summary.jitterMaxUs};
+                for (uint32_t value : values) {
+                    if (result == returnvalue::OK) {
+                        result = SerializeAdapter::serialize(&value, &cursor, &serializedSize, sizeof(buffer),
+                                                             SerializeIF::Endianness::BIG);
+                    }
+                }
+            }
+            if (result == returnvalue::OK) {
+                result = sendTmPacket(static_cast<uint8_t>(Subservice::TM_TASK_TIMING), buffer, serializedSize);
+            }
+            if (result != returnvalue::OK) {
+                return result;
+            }
+        }
+        return returnvalue::OK;
+    }
+
+}  // namespace timing
@@ -0,0 +1,69 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+
+#pragma once
+
+#include <fsfw/tmtcservices/CommandingServiceBase.h>
+
+#include <cstddef>
+#include <cstdint>
+
+class CommandMessage;
+
+namespace timing {
+
+    /*
+     * Publishes the entries of ExecutionTimingRegistry: as housekeeping TM every
+     * HK_INTERVAL_MS, on request and as a log dump every LOG_INTERVAL_MS. Commands nothing,
+     * so it works without any camera or device handler.
+     */
+    class TaskTimingService : public CommandingServiceBase {
+    public:
+        static constexpr uint8_t SERVICE_ID = 201;
+
+        enum class Subservice : uint8_t {
+            // No application data, answered with TM_TASK_TIMING
+            TASK_TIMING_DUMP = 1,
+            TM_TASK_TIMING = 129,
+        };
+
+        static constexpr uint32_t HK_INTERVAL_MS = 10000;
+        static constexpr uint32_t LOG_INTERVAL_MS = 60000;
+        static constexpr size_t ENTRIES_PER_PACKET = 16;
+        static constexpr size_t NAME_SIZE = 24;
+
+        TaskTimingService(object_id_t objectId, uint16_t apid, VerificationReporterIF* reporter = nullptr);
+
+    protected:
+        ReturnValue_t isValidSubservice(uint8_t subservice) override;
+        ReturnValue_t getMessageQueueAndObject(uint8_t subservice, const uint8_t* tcData, size_t tcDataLen,
+                                               MessageQueueId_t* id, object_id_t* objectId) override;
+        ReturnValue_t prepareCommand(CommandMessage* message, uint8_t subservice, const uint8_t* tcData,
+                                     size_t tcDataLen, uint32_t* state, object_id_t objectId) override;
+        ReturnValue_t handleReply(const CommandMessage* reply, Command_t previousCommand, uint32_t* state,
+                                  CommandMessage* optionalNextCommand, object_id_t objectId,
+                                  bool* isStep) override;
+        void doPeriodicOperation() override;
+
+    private:
+        // All entries of the registry as TM_TASK_TIMING packets
+        ReturnValue_t sendTaskTiming();
+
+        uint64_t lastHkUs = 0;
+        uint64_t lastLogUs = 0;
+    };
+
+}  // namespace timing
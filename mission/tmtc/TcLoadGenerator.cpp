@@ -0,0 +1,282 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+
+#include "TcLoadGenerator.h"
+
+#include <fsfw/serviceinterface/ServiceInterface.h>
+#include <fsfw/tmtcservices/VerificationCodes.h>
+
+#include <chrono>
+#include <thread>
+
+#include "mission/tmtc/TmtcInfrastructure.h"
+
+namespace webcam {
+
+TcLoadGenerator::TcLoadGenerator(StubPusDistributor& distributor,
+                                 StubVerificationReceiver& verificationReceiver,
+                                 StubTelemetrySink& telemetrySink)
+    : distributor(distributor),
+      verificationReceiver(verificationReceiver),
+      telemetrySink(telemetrySink),
+      slots(SEQUENCE_COUNT) {
+  verificationReceiver.setVerificationCallback(
+      [this](uint8_t reportId, uint16_t tcSequenceControl) { onVerification(reportId, tcSequenceControl); });
+  telemetrySink.setTmCallback([this](uint8_t service, uint8_t subservice) { onTm(service, subservice); });
+}
+
+TcLoadGenerator::~TcLoadGenerator() {
+  verificationReceiver.setVerificationCallback(nullptr);
+  telemetrySink.setTmCallback(nullptr);
+}
+
+std::vector<TcLoadGenerator::MixEntry> TcLoadGenerator::defaultMix() {
+  using Subservice = WebcamCommandingService::Subservice;
+  return {{Subservice::COMMAND_GET_FRAME_RATE, 4, {}},
+          {Subservice::LATENCY_DUMP, 3, {}},
+          {Subservice::PARAMETER_DUMP, 2, {}}};
+}
+
+uint8_t TcLoadGenerator::replySubservice(WebcamCommandingService::Subservice subservice) {
+  using Subservice = WebcamCommandingService::Subservice;
+  switch (subservice) {
+    case Subservice::COMMAND_GET_FRAME_RATE:
+      return static_cast<uint8_t>(Subservice::TM_COMMAND_DATA_REPLY);
+    case Subservice::PARAMETER_DUMP:
+      return static_cast<uint8_t>(Subservice::TM_PARAMETER_DUMP);
+    case Subservice::LATENCY_DUMP:
+      return static_cast<uint8_t>(Subservice::TM_LATENCY_DUMP);
+    default:
+      return 0;
+  }
+}
+
+std::vector<TcLoadGenerator::StepResult> TcLoadGenerator::run(const Config& config) {
+  const std::vector<MixEntry> mix = config.mix.empty() ? defaultMix() : config.mix;
+  uint64_t totalWeight = 0;
+  for (const MixEntry& entry : mix) {
+    totalWeight += entry.weight;
+  }
+  std::vector<StepResult> results;
+  if (totalWeight == 0 || config.stepDurationMs == 0) {
+    sif::printWarning("TcLoadGenerator: Empty mix or step duration, nothing to do\n");
+    return results;
+  }
+  verificationReceiver.setConsoleOutput(false);
+  telemetrySink.setConsoleOutput(false);
+  sif::printInfo("TcLoadGenerator: %zu steps of %u ms, %zu subservices in the mix\n",
+                 config.ratesPerSecond.size(), static_cast<unsigned int>(config.stepDurationMs),
+                 mix.size());
+
+  const StepResult* saturation = nullptr;
+  const StepResult* best = nullptr;
+  results.reserve(config.ratesPerSecond.size());
+  for (uint32_t rate : config.ratesPerSecond) {
+    results.push_back(runStep(static_cast<uint32_t>(results.size()), rate, config, mix));
+    const StepResult& result = results.back();
+    printStep(result);
+    if (best == nullptr || result.throughput > best->throughput) {
+      best = &result;
+    }
+    if (result.saturated && saturation == nullptr) {
+      saturation = &result;
+      if (config.stopAtSaturation) {
+        break;
+      }
+    }
+  }
+
+  if (saturation != nullptr) {
+    sif::printInfo("TcLoadGenerator: Saturated at %u TC/s offered, highest sustained throughput %.0f TC/s\n",
+                   static_cast<unsigned int>(saturation->offeredRate), best->throughput);
+  } else if (best != nullptr) {
+    sif::printInfo("TcLoadGenerator: No saturation up to %u TC/s, highest sustained throughput %.0f TC/s\n",
+                   static_cast<unsigned int>(results.back().offeredRate), best->throughput);
+  }
+  verificationReceiver.setConsoleOutput(true);
+  telemetrySink.setConsoleOutput(true);
+  return results;
+}
+
+TcLoadGenerator::StepResult TcLoadGenerator::runStep(uint32_t step, uint32_t rate, const Config& config,
+                                                     const std::vector<MixEntry>& mix) {
+  StepData* data = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    steps.push_back(std::make_unique<StepData>());
+    data = steps.back().get();
+    data->sending = true;
+  }
+  std::vector<uint64_t> cumulativeWeights;
+  uint64_t totalWeight = 0;
+  for (const MixEntry& entry : mix) {
+    totalWeight += entry.weight;
+    cumulativeWeights.push_back(totalWeight);
+  }
+  // xorshift32, the same mix sequence in every run
+  uint32_t random = 0x9E3779B9u ^ step;
+
+  StepResult result;
+  result.offeredRate = rate;
+  const uint64_t durationUs = static_cast<uint64_t>(config.stepDurationMs) * 1000;
+  const uint64_t startUs = timing::monotonicTimeUs();
+  uint64_t elapsedUs = 0;
+  while ((elapsedUs = timing::monotonicTimeUs() - startUs) < durationUs) {
+    const uint64_t due = elapsedUs * rate / 1000000;
+    while (result.sent + result.rejected < due) {
+      random ^= random << 13;
+      random ^= random >> 17;
+      random ^= random << 5;
+      const uint64_t pick = random % totalWeight;
+      size_t index = 0;
+      while (cumulativeWeights[index] <= pick) {
+        index++;
+      }
+      const MixEntry& entry = mix[index];
+      // Held across the send, the reports of the TC may arrive before sendCommand returns
+      std::lock_guard<std::mutex> lock(mutex);
+      uint16_t sequenceCount = 0;
+      const uint64_t sendUs = timing::monotonicTimeUs();
+      if (distributor.sendCommand(static_cast<uint8_t>(entry.subservice),
+                                  entry.appData.empty() ? nullptr : entry.appData.data(),
+                                  entry.appData.size(), &sequenceCount) != returnvalue::OK) {
+        result.rejected++;
+        continue;
+      }
+      result.sent++;
+      slots[sequenceCount] = Slot{sendUs, step, TcState::sent};
+      const uint8_t reply = replySubservice(entry.subservice);
+      if (reply != 0) {
+        pendingReplies[reply].push_back(sequenceCount);
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::microseconds(PACING_INTERVAL_US));
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    data->sending = false;
+  }
+
+  // Wait for the outstanding reports, at most the drain time
+  const uint64_t drainEndUs = timing::monotonicTimeUs() + static_cast<uint64_t>(config.drainTimeMs) * 1000;
+  while (timing::monotonicTimeUs() < drainEndUs) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (data->completed + data->failed >= result.sent) {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+
+  std::lock_guard<std::mutex> lock(mutex);
+  result.completed = data->completed;
+  result.failed = data->failed;
+  result.lost = result.sent - result.completed - result.failed;
+  result.tmReceived = data->tmReceived;
+  result.throughput = static_cast<double>(data->completedInWindow) * 1000.0 / config.stepDurationMs;
+  result.startLatency = data->startLatency.snapshot();
+  result.completionLatency = data->completionLatency.snapshot();
+  result.tmLatency = data->tmLatency.snapshot();
+  result.saturated = result.throughput < config.saturationRatio * rate || result.rejected > 0 ||
+                     result.failed > 0 || result.lost > 0;
+  // Replies of lost TCs would be matched to the next step
+  for (auto& pending : pendingReplies) {
+    pending.clear();
+  }
+  return result;
+}
+
+void TcLoadGenerator::onVerification(uint8_t reportId, uint16_t tcSequenceControl) {
+  const uint64_t nowUs = timing::monotonicTimeUs();
+  std::lock_guard<std::mutex> lock(mutex);
+  Slot& slot = slots[tcSequenceControl & StubPusDistributor::SEQUENCE_COUNT_MASK];
+  if (slot.state != TcState::sent && slot.state != TcState::started) {
+    return;
+  }
+  StepData& data = *steps[slot.step];
+  switch (reportId) {
+    case tcverif::START_SUCCESS:
+      if (slot.state == TcState::sent) {
+        data.startLatency.record(nowUs - slot.sendUs);
+        slot.state = TcState::started;
+      }
+      break;
+    case tcverif::COMPLETION_SUCCESS:
+      // Commands answered by the service itself complete without a start report
+      data.completionLatency.record(nowUs - slot.sendUs);
+      data.completed++;
+      if (data.sending) {
+        data.completedInWindow++;
+      }
+      slot.state = TcState::completed;
+      break;
+    case tcverif::ACCEPTANCE_FAILURE:
+    case tcverif::START_FAILURE:
+    case tcverif::PROGRESS_FAILURE:
+    case tcverif::COMPLETION_FAILURE:
+      data.failed++;
+      slot.state = TcState::failed;
+      break;
+    default:
+      break;
+  }
+}
+
+void TcLoadGenerator::onTm(uint8_t service, uint8_t subservice) {
+  if (service != WebcamCommandingService::SERVICE_ID) {
+    return;
+  }
+  const uint64_t nowUs = timing::monotonicTimeUs();
+  std::lock_guard<std::mutex> lock(mutex);
+  std::deque<uint16_t>& pending = pendingReplies[subservice];
+  while (!pending.empty()) {
+    const Slot& slot = slots[pending.front()];
+    pending.pop_front();
+    // A failed TC sends no reply, the TM belongs to the next one
+    if (slot.state == TcState::failed || slot.state == TcState::free) {
+      continue;
+    }
+    StepData& data = *steps[slot.step];
+    data.tmLatency.record(nowUs - slot.sendUs);
+    data.tmReceived++;
+    return;
+  }
+}
+
+void TcLoadGenerator::printStep(const StepResult& result) {
+  sif::printInfo(
+      "TcLoadGenerator: %u TC/s offered, %u sent, %u rejected, %u completed (%.0f TC/s), %u failed, "
+      "%u lost%s\n",
+      static_cast<unsigned int>(result.offeredRate), static_cast<unsigned int>(result.sent),
+      static_cast<unsigned int>(result.rejected), static_cast<unsigned int>(result.completed),
+      result.throughput, static_cast<unsigned int>(result.failed), static_cast<unsigned int>(result.lost),
+      result.saturated ? ", saturated" : "");
+  const timing::LatencyHistogram::Snapshot* latencies[] = {&result.startLatency, &result.completionLatency,
+                                                          &result.tmLatency};
+  const char* names[] = {"start", "completion", "reply TM"};
+  for (size_t index = 0; index < 3; index++) {
+    const timing::LatencyHistogram::Snapshot& latency = *latencies[index];
+    sif::printInfo("TcLoadGenerator:   %-10s %6u samples, min %u us, mean %u us, p50 %u us, p99 %u us, max %u us\n",
+                   names[index], static_cast<unsigned int>(latency.count),
+                   static_cast<unsigned int>(latency.minUs), static_cast<unsigned int>(latency.meanUs),
+                   static_cast<unsigned int>(latency.percentileUs(50)),
+                   static_cast<unsigned int>(latency.percentileUs(99)),
+                   static_cast<unsigned int>(latency.maxUs));
+  }
+}
+
+}  // namespace webcam
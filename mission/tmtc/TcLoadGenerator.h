@@ -0,0 +1,140 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "mission/timing/LatencyHistogram.h"
+#include "mission/tmtc/WebcamCommandingService.h"
+
+namespace webcam {
+
+class StubPusDistributor;
+class StubTelemetrySink;
+class StubVerificationReceiver;
+
+/*
+ * Drives the PUS distributor with a weighted mix of service 200 TCs at increasing rates, one
+ * step per rate, and reports per step: sustained throughput, TCs rejected at ingestion,
+ * failed and lost TCs, start and completion latency as seen by the verification receiver and
+ * reply TM latency as seen by the telemetry sink. The first step which does not keep up is
+ * the saturation point of the commanding chain.
+ *
+ * TCs are matched to their verification by the packet sequence count and to their reply TM in
+ * order, per reply subservice. It installs the callbacks of the sinks, so construct it before
+ * the TMTC task starts and keep it until the task stopped. run() must be the only sender of TCs.
+ */
+class TcLoadGenerator {
+ public:
+  struct MixEntry {
+    WebcamCommandingService::Subservice subservice;
+    uint32_t weight = 1;
+    std::vector<uint8_t> appData;
+  };
+
+  struct Config {
+    std::vector<uint32_t> ratesPerSecond = {100, 250, 500, 1000, 2000, 5000, 10000};
+    uint32_t stepDurationMs = 5000;
+    // Time after the last TC of a step for the outstanding reports, counted as lost afterwards
+    uint32_t drainTimeMs = 2000;
+    // Empty uses defaultMix()
+    std::vector<MixEntry> mix;
+    // A step is saturated below this share of the offered rate or when TCs are rejected or lost
+    double saturationRatio = 0.95;
+    bool stopAtSaturation = true;
+  };
+
+  struct StepResult {
+    uint32_t offeredRate = 0;
+    uint32_t sent = 0;
+    uint32_t rejected = 0;  // sendCommand failed, TC store or service queue full
+    uint32_t completed = 0;
+    uint32_t failed = 0;  // start or completion failure
+    uint32_t lost = 0;    // no completion report within the drain time
+    uint32_t tmReceived = 0;
+    // Completions within the sending window per second
+    double throughput = 0.0;
+    bool saturated = false;
+    timing::LatencyHistogram::Snapshot startLatency;
+    timing::LatencyHistogram::Snapshot completionLatency;
+    timing::LatencyHistogram::Snapshot tmLatency;
+  };
+
+  TcLoadGenerator(StubPusDistributor& distributor, StubVerificationReceiver& verificationReceiver,
+                  StubTelemetrySink& telemetrySink);
+  ~TcLoadGenerator();
+
+  TcLoadGenerator(const TcLoadGenerator&) = delete;
+  TcLoadGenerator& operator=(const TcLoadGenerator&) = delete;
+
+  // Commands answered by the handler and by the service itself, all with a reply TM. No
+  // commands which change the camera setup.
+  static std::vector<MixEntry> defaultMix();
+  // Reply TM subservice of a TC subservice, 0 if it has none
+  static uint8_t replySubservice(WebcamCommandingService::Subservice subservice);
+
+  // Runs the steps and blocks until the last one drained. The console output of the sinks is
+  // off meanwhile, a line per step and the saturation point are printed.
+  std::vector<StepResult> run(const Config& config);
+
+ private:
+  static constexpr size_t SEQUENCE_COUNT = 16384;
+  static constexpr uint32_t PACING_INTERVAL_US = 200;
+
+  enum class TcState : uint8_t { free, sent, started, completed, failed };
+
+  struct Slot {
+    uint64_t sendUs = 0;
+    uint32_t step = 0;
+    TcState state = TcState::free;
+  };
+
+  struct StepData {
+    uint32_t completed = 0;
+    uint32_t completedInWindow = 0;
+    uint32_t failed = 0;
+    uint32_t tmReceived = 0;
+    bool sending = false;
+    timing::LatencyHistogram startLatency;
+    timing::LatencyHistogram completionLatency;
+    timing::LatencyHistogram tmLatency;
+  };
+
+  void onVerification(uint8_t reportId, uint16_t tcSequenceControl);
+  void onTm(uint8_t service, uint8_t subservice);
+  StepResult runStep(uint32_t step, uint32_t rate, const Config& config,
+                     const std::vector<MixEntry>& mix);
+  static void printStep(const StepResult& result);
+
+  StubPusDistributor& distributor;
+  StubVerificationReceiver& verificationReceiver;
+  StubTelemetrySink& telemetrySink;
+
+  std::mutex mutex;
+  std::vector<Slot> slots;
+  std::vector<std::unique_ptr<StepData>> steps;
+  // Sequence counts of the TCs waiting for their reply TM, per reply subservice
+  std::array<std::deque<uint16_t>, 256> pendingReplies;
+};
+
+}  // namespace webcam
@@ -15,14 +15,19 @@
 
 #include "TmtcInfrastructure.h"
 
+#include <cstddef>
 #include <cstdio>
 #include <cstring>
+#include <utility>
 
+#include <fsfw/globalfunctions/CRC.h>
 #include <fsfw/ipc/MessageQueueIF.h>
 #include <fsfw/ipc/MessageQueueMessage.h>
 #include <fsfw/ipc/MessageQueueSenderIF.h>
+#include <fsfw/ipc/MutexIF.h>
 #include <fsfw/ipc/QueueFactory.h>
 #include <fsfw/objectmanager/ObjectManager.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
 #include <fsfw/storagemanager/StorageManagerIF.h>
 #include <fsfw/timemanager/CdsShortTimeStamper.h>
 #include <fsfw/timemanager/TimeReaderIF.h>
@@ -34,11 +39,12 @@
 #include <fsfw/tmtcservices/PusVerificationReport.h>
 #include <fsfw/tmtcservices/TmTcMessage.h>
 
+#include "mission/tasks/WorkStealingExecutor.h"
 #include "mission/webcam/WebcamDefinitions.h"
 
 namespace webcam {
 namespace {
-constexpr size_t MAX_TM_PRINT_BYTES = 32;
+constexpr size_t PRIMARY_HEADER_SIZE = 6;
 }
 
 StubTelemetrySink::StubTelemetrySink(object_id_t objectId) : SystemObject(objectId) {}
@@ -66,17 +72,16 @@ ReturnValue_t StubTelemetrySink::performOperation(uint8_t) {
     const uint8_t* data = nullptr;
     size_t size = 0;
     if (tmStore->getData(storeId, &data, &size) == returnvalue::OK) {
-      PusTmReader reader(timeReader, data, size);
-      if (reader.parseDataWithoutCrcCheck() == returnvalue::OK) {
-        printf("[TM] service %u subservice %u, %zu bytes\n", reader.getService(), reader.getSubService(),
-               reader.getUserDataLen());
-      } else {
-        const size_t bytesToPrint = size < MAX_TM_PRINT_BYTES ? size : MAX_TM_PRINT_BYTES;
-        printf("[TM] Received %zu bytes of telemetry (first %zu bytes): ", size, bytesToPrint);
-        for (size_t idx = 0; idx < bytesToPrint; idx++) {
-          printf("%02x", data[idx]);
+      if (tmCallback) {
+        PusTmReader reader(timeReader, data, size);
+        if (reader.parseDataWithoutCrcCheck() == returnvalue::OK) {
+          tmCallback(reader.getService(), reader.getSubService());
         }
-        printf("\n");
+      }
+      if (consoleOutput.load(std::memory_order_relaxed)) {
+        char line[REPORT_LINE_SIZE];
+        formatReport(timeReader, data, size, line, sizeof(line));
+        report(line);
       }
       tmStore->deleteData(storeId);
     }
@@ -84,6 +89,84 @@ ReturnValue_t StubTelemetrySink::performOperation(uint8_t) {
   return returnvalue::OK;
 }
 
+size_t StubTelemetrySink::formatReport(TimeReaderIF* timeReader, const uint8_t* data, size_t size,
+                                       char* line, size_t lineSize) {
+  if (line == nullptr || lineSize == 0) {
+    return 0;
+  }
+  line[0] = '\0';
+  PusTmReader reader(timeReader, data, size);
+  int length = 0;
+  if (reader.parseDataWithoutCrcCheck() == returnvalue::OK) {
+    length = snprintf(line, lineSize, "[TM] service %u subservice %u, %zu bytes\n", reader.getService(),
+                      reader.getSubService(), reader.getUserDataLen());
+  } else {
+    const size_t bytesToPrint = size < MAX_TM_PRINT_BYTES ? size : MAX_TM_PRINT_BYTES;
+    length = snprintf(line, lineSize, "[TM] Received %zu bytes of telemetry (first %zu bytes): ", size,
+                      bytesToPrint);
+    // Room for two digits and the line end
+    for (size_t idx = 0; idx < bytesToPrint && length > 0 && length + 4 <= static_cast<int>(lineSize);
+         idx++) {
+      length += snprintf(line + length, lineSize - length, "%02x", data[idx]);
+    }
+    if (length > 0 && length + 2 <= static_cast<int>(lineSize)) {
+      length += snprintf(line + length, lineSize - length, "\n");
+    }
+  }
+  if (length < 0) {
+    return 0;
+  }
+  return static_cast<size_t>(length) < lineSize ? static_cast<size_t>(length) : lineSize - 1;
+}
+
+void StubTelemetrySink::setExecutor(tasks::WorkStealingExecutor* executor) {
+  this->executor = executor;
+}
+
+void StubTelemetrySink::setTmCallback(TmCallback callback) { tmCallback = std::move(callback); }
+
+void StubTelemetrySink::setConsoleOutput(bool enabled) {
+  consoleOutput.store(enabled, std::memory_order_relaxed);
+}
+
+void StubTelemetrySink::report(std::string line) {
+  if (executor == nullptr) {
+    fputs(line.c_str(), stdout);
+    return;
+  }
+  std::lock_guard<std::mutex> lock(reportMutex);
+  pendingReports.push_back(std::move(line));
+  if (reportJobQueued) {
+    return;
+  }
+  reportJobQueued = executor->submit([this] { writeReports(); });
+  if (!reportJobQueued) {
+    // Executor saturated or stopped, the next report tries again
+    for (const std::string& pending : pendingReports) {
+      fputs(pending.c_str(), stdout);
+    }
+    pendingReports.clear();
+  }
+}
+
+void StubTelemetrySink::writeReports() {
+  std::vector<std::string> reports;
+  while (true) {
+    {
+      std::lock_guard<std::mutex> lock(reportMutex);
+      if (pendingReports.empty()) {
+        reportJobQueued = false;
+        return;
+      }
+      reports.swap(pendingReports);
+    }
+    for (const std::string& line : reports) {
+      fputs(line.c_str(), stdout);
+    }
+    reports.clear();
+  }
+}
+
 MessageQueueId_t StubTelemetrySink::getReportReceptionQueue(uint8_t) {
   if (queue == nullptr) {
     return MessageQueueIF::NO_QUEUE;
@@ -112,12 +195,25 @@ ReturnValue_t StubVerificationReceiver::performOperation(uint8_t) {
   }
   PusVerificationMessage message;
   while (queue->receiveMessage(&message) == returnvalue::OK) {
-    printf("[TMTC] Verification report %u ack 0x%02x step %u error %d\n", message.getReportId(),
-           message.getAckFlags(), message.getStep(), static_cast<int>(message.getErrorCode()));
+    if (verificationCallback) {
+      verificationCallback(message.getReportId(), message.getTcSequenceControl());
+    }
+    if (consoleOutput.load(std::memory_order_relaxed)) {
+      printf("[TMTC] Verification report %u ack 0x%02x step %u error %d\n", message.getReportId(),
+             message.getAckFlags(), message.getStep(), static_cast<int>(message.getErrorCode()));
+    }
   }
   return returnvalue::OK;
 }
 
+void StubVerificationReceiver::setVerificationCallback(VerificationCallback callback) {
+  verificationCallback = std::move(callback);
+}
+
+void StubVerificationReceiver::setConsoleOutput(bool enabled) {
+  consoleOutput.store(enabled, std::memory_order_relaxed);
+}
+
 MessageQueueId_t StubVerificationReceiver::getVerificationQueue() {
   if (queue == nullptr) {
     queue = QueueFactory::instance()->createMessageQueue(QUEUE_DEPTH, MessageQueueMessage::MAX_MESSAGE_SIZE);
@@ -128,52 +224,243 @@ MessageQueueId_t StubVerificationReceiver::getVerificationQueue() {
   return queue->getId();
 }
 
-StubPusDistributor::StubPusDistributor(object_id_t objectId) : SystemObject(objectId) {}
+TcPoolManager::TcPoolManager(object_id_t objectId, const LocalPoolConfig& poolConfig)
+    : PoolManager(objectId, poolConfig) {}
+
+ReturnValue_t TcPoolManager::getFreeElements(const size_t* sizes, size_t count,
+                                             store_address_t* storeIds, uint8_t** elements,
+                                             size_t* reserved) {
+  *reserved = 0;
+  ReturnValue_t result = lockMutex(MutexIF::TimeoutType::WAITING, mutexTimeoutMs);
+  if (result != returnvalue::OK) {
+    return result;
+  }
+  // The LocalPool versions skip the locking of PoolManager, the mutex is held already
+  for (; *reserved < count; (*reserved)++) {
+    result = LocalPool::reserveSpace(sizes[*reserved], &storeIds[*reserved]);
+    if (result != returnvalue::OK) {
+      break;
+    }
+    size_t size = 0;
+    result = LocalPool::modifyData(storeIds[*reserved], &elements[*reserved], &size);
+    if (result != returnvalue::OK) {
+      (void)LocalPool::deleteData(storeIds[*reserved]);
+      break;
+    }
+  }
+  (void)unlockMutex();
+  return result;
+}
+
+StubPusDistributor::StubPusDistributor(object_id_t objectId, uint16_t apid)
+    : SystemObject(objectId), apid(apid) {}
 
 ReturnValue_t StubPusDistributor::initialize() {
   tcStore = ObjectManager::instance()->get<StorageManagerIF>(objects::TC_STORE);
+  batchStore = dynamic_cast<TcPoolManager*>(tcStore);
   return SystemObject::initialize();
 }
 
 ReturnValue_t StubPusDistributor::registerService(AcceptsTelecommandsIF* service) {
-  if (service == nullptr) {
+  return registerService(service, apid);
+}
+
+ReturnValue_t StubPusDistributor::registerService(AcceptsTelecommandsIF* service, uint16_t serviceApid) {
+  if (service == nullptr || service->getIdentifier() >= routes.size()) {
+    return returnvalue::FAILED;
+  }
+  const auto serviceId = static_cast<uint8_t>(service->getIdentifier());
+  if (services[serviceId] != nullptr && services[serviceId] != service) {
+    sif::printWarning("StubPusDistributor: Service %u is already registered\n",
+                      static_cast<unsigned int>(serviceId));
     return returnvalue::FAILED;
   }
-  registeredService = service;
-  registeredServiceId = service->getIdentifier();
-  serviceRequestQueue = service->getRequestQueue();
+  services[serviceId] = service;
+  routes[serviceId].queue = service->getRequestQueue();
+  routes[serviceId].apid = serviceApid;
   return returnvalue::OK;
 }
 
-ReturnValue_t StubPusDistributor::sendCommand(uint8_t subservice, const uint8_t* data, size_t dataLen) {
-  if (registeredService == nullptr || tcStore == nullptr) {
+const StubPusDistributor::Route* StubPusDistributor::routeOf(uint8_t service, uint16_t packetApid) const {
+  const Route& route = routes[service];
+  if (route.queue == MessageQueueIF::NO_QUEUE || route.apid != packetApid) {
+    return nullptr;
+  }
+  return &route;
+}
+
+ReturnValue_t StubPusDistributor::sendCommand(uint8_t subservice, const uint8_t* data, size_t dataLen,
+                                              uint16_t* sequenceCount) {
+  const Telecommand command{subservice, data, dataLen};
+  size_t queued = 0;
+  const ReturnValue_t result = sendCommands(&command, 1, &queued, sequenceCount);
+  return queued == 1 ? returnvalue::OK : result;
+}
+
+ReturnValue_t StubPusDistributor::sendCommands(const Telecommand* commands, size_t count, size_t* queued,
+                                               uint16_t* firstSequenceCount) {
+  if (queued != nullptr) {
+    *queued = 0;
+  }
+  if (tcStore == nullptr || (commands == nullptr && count > 0)) {
     return returnvalue::FAILED;
   }
+  // Serialize everything first, the service queue only sees complete packets
+  batchSizes.clear();
+  ReturnValue_t result = returnvalue::OK;
+  for (size_t index = 0; index < count; index++) {
+    const uint8_t service = commands[index].service != 0 ? commands[index].service : DEFAULT_SERVICE;
+    if (routeOf(service, apid) == nullptr) {
+      result = returnvalue::FAILED;
+      break;
+    }
+    batchSizes.push_back(MIN_TC_SIZE + (commands[index].data != nullptr ? commands[index].dataLen : 0));
+  }
+  const size_t reserved = reserveBatch(result);
+  size_t serialized = 0;
+  for (; serialized < reserved; serialized++) {
+    const auto sequenceCount = static_cast<uint16_t>((sequenceCounter + serialized) & SEQUENCE_COUNT_MASK);
+    const ReturnValue_t serializeResult = serializeCommand(
+        commands[serialized], sequenceCount, batchElements[serialized], batchSizes[serialized]);
+    if (serializeResult != returnvalue::OK) {
+      result = serializeResult;
+      break;
+    }
+  }
+  size_t sent = 0;
+  for (; sent < serialized; sent++) {
+    const uint8_t service = commands[sent].service != 0 ? commands[sent].service : DEFAULT_SERVICE;
+    TmTcMessage message(batchStoreIds[sent]);
+    const ReturnValue_t sendResult = MessageQueueSenderIF::sendMessage(routes[service].queue, &message);
+    if (sendResult != returnvalue::OK) {
+      result = sendResult;
+      break;
+    }
+  }
+  // Not queued, nobody else frees the elements of the TCs left over
+  for (size_t index = sent; index < reserved; index++) {
+    tcStore->deleteData(batchStoreIds[index]);
+  }
+  if (firstSequenceCount != nullptr) {
+    *firstSequenceCount = sequenceCounter;
+  }
+  // The TCs left over get their sequence counts when they are resent
+  sequenceCounter = static_cast<uint16_t>((sequenceCounter + sent) & SEQUENCE_COUNT_MASK);
+  if (queued != nullptr) {
+    *queued = sent;
+  }
+  return sent == count ? returnvalue::OK : result;
+}
+
+size_t StubPusDistributor::reserveBatch(ReturnValue_t& result) {
+  const size_t count = batchSizes.size();
+  batchStoreIds.resize(count);
+  batchElements.resize(count);
+  size_t reserved = 0;
+  ReturnValue_t reserveResult = returnvalue::OK;
+  if (batchStore != nullptr) {
+    reserveResult = batchStore->getFreeElements(batchSizes.data(), count, batchStoreIds.data(),
+                                                batchElements.data(), &reserved);
+  } else {
+    for (; reserved < count; reserved++) {
+      reserveResult = tcStore->getFreeElement(&batchStoreIds[reserved], batchSizes[reserved],
+                                              &batchElements[reserved]);
+      if (reserveResult != returnvalue::OK) {
+        break;
+      }
+    }
+  }
+  if (reserveResult != returnvalue::OK) {
+    result = reserveResult;
+  }
+  return reserved;
+}
+
+ReturnValue_t StubPusDistributor::serializeCommand(const Telecommand& command, uint16_t sequenceCount,
+                                                   uint8_t* element, size_t size) const {
   PacketId packetId(ccsds::PacketType::TC, true, apid);
-  PacketSeqCtrl seqCtrl(ccsds::SequenceFlags::UNSEGMENTED, sequenceCounter++);
+  PacketSeqCtrl seqCtrl(ccsds::SequenceFlags::UNSEGMENTED, sequenceCount);
   SpacePacketParams spParams(packetId, seqCtrl, 0);
-  PusTcParams pusParams(registeredServiceId, subservice);
-  if (data != nullptr && dataLen > 0) {
-    pusParams.setRawAppData(data, dataLen);
+  PusTcParams pusParams(command.service != 0 ? command.service : DEFAULT_SERVICE, command.subservice);
+  if (command.data != nullptr && command.dataLen > 0) {
+    pusParams.setRawAppData(command.data, command.dataLen);
   }
   PusTcCreator creator(spParams, pusParams);
   creator.updateSpLengthField();
-  const size_t serializedSize = creator.getSerializedSize();
+  // The element is sized by MIN_TC_SIZE plus the application data
+  size_t serializedSize = 0;
+  return creator.serializeBe(&element, &serializedSize, size);
+}
+
+void StubPusDistributor::ingestStream(const uint8_t* data, size_t size) {
+  if (data == nullptr || size == 0) {
+    return;
+  }
+  if (streamBuffer.empty()) {
+    // Common case, whole packets per chunk: routed straight from the caller's buffer
+    const size_t consumed = ingestPackets(data, size);
+    streamBuffer.assign(data + consumed, data + size);
+    return;
+  }
+  streamBuffer.insert(streamBuffer.end(), data, data + size);
+  const size_t consumed = ingestPackets(streamBuffer.data(), streamBuffer.size());
+  streamBuffer.erase(streamBuffer.begin(), streamBuffer.begin() + static_cast<std::ptrdiff_t>(consumed));
+}
+
+StubPusDistributor::StreamStatistics StubPusDistributor::getStreamStatistics() const {
+  return streamStatistics;
+}
+
+size_t StubPusDistributor::ingestPackets(const uint8_t* data, size_t size) {
+  size_t offset = 0;
+  while (size - offset >= PRIMARY_HEADER_SIZE) {
+    const uint8_t* packet = data + offset;
+    // Version 0, TC, secondary header present
+    const bool plausibleHeader = (packet[0] & 0xF8) == 0x18;
+    const size_t packetSize = ((static_cast<size_t>(packet[4]) << 8) | packet[5]) + PRIMARY_HEADER_SIZE + 1;
+    if (!plausibleHeader || packetSize < MIN_TC_SIZE || packetSize > MAX_TC_SIZE) {
+      streamStatistics.syncErrors++;
+      offset++;
+      continue;
+    }
+    if (size - offset < packetSize) {
+      break;
+    }
+    streamStatistics.packets++;
+    // The CRC over the whole packet including its CRC field is 0
+    if (CRC::crc16ccitt(packet, packetSize) != 0) {
+      // Most likely a corrupted length or a header lookalike, the real next packet may start
+      // anywhere inside the bytes it claims
+      streamStatistics.crcErrors++;
+      offset++;
+      continue;
+    }
+    routePacket(packet, packetSize);
+    offset += packetSize;
+  }
+  return offset;
+}
+
+void StubPusDistributor::routePacket(const uint8_t* packet, size_t size) {
+  const uint16_t packetApid = static_cast<uint16_t>(((packet[0] & 0x07) << 8) | packet[1]);
+  // Byte 7 is the service ID in the PUS-C secondary header
+  const Route* route = routeOf(packet[7], packetApid);
+  if (route == nullptr || tcStore == nullptr) {
+    streamStatistics.unroutable++;
+    return;
+  }
   store_address_t storeId;
-  uint8_t* storePtr = nullptr;
-  ReturnValue_t result = tcStore->getFreeElement(&storeId, serializedSize, &storePtr);
-  if (result != returnvalue::OK) {
-    return result;
+  if (tcStore->addData(&storeId, packet, size) != returnvalue::OK) {
+    streamStatistics.rejected++;
+    return;
   }
-  uint8_t* writePtr = storePtr;
-  size_t size = 0;
-  result = creator.serializeBe(&writePtr, &size, serializedSize);
-  if (result != returnvalue::OK) {
+  TmTcMessage message(storeId);
+  if (MessageQueueSenderIF::sendMessage(route->queue, &message) != returnvalue::OK) {
     tcStore->deleteData(storeId);
-    return result;
+    streamStatistics.rejected++;
+    return;
   }
-  TmTcMessage message(storeId);
-  return MessageQueueSenderIF::sendMessage(serviceRequestQueue, &message);
+  streamStatistics.routed++;
 }
 
 }  // namespace webcam
@@ -16,20 +16,45 @@
 #pragma once
 
 #include <fsfw/objectmanager/SystemObject.h>
+#include <fsfw/storagemanager/PoolManager.h>
+#include <fsfw/storagemanager/storeAddress.h>
 #include <fsfw/tasks/ExecutableObjectIF.h>
 #include <fsfw/tcdistribution/PUSDistributorIF.h>
 #include <fsfw/tmtcservices/AcceptsTelemetryIF.h>
 #include <fsfw/tmtcservices/AcceptsVerifyMessageIF.h>
 
+#include <array>
+#include <atomic>
 #include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
 
 class MessageQueueIF;
 class StorageManagerIF;
 class TimeReaderIF;
 class CdsShortTimeStamper;
 
+namespace tasks {
+class WorkStealingExecutor;
+}
+
 namespace webcam {
 
+// TC store which reserves the elements of a whole command sequence under one lock of the pool
+// mutex, PoolManager alone takes it once per element
+class TcPoolManager : public PoolManager {
+ public:
+  TcPoolManager(object_id_t objectId, const LocalPoolConfig& poolConfig);
+
+  // Stops at the first size which does not fit, *reserved tells how many elements were
+  // reserved. They are filled and deleted like any other store element.
+  ReturnValue_t getFreeElements(const size_t* sizes, size_t count, store_address_t* storeIds,
+                                uint8_t** elements, size_t* reserved);
+};
+
 class StubTelemetrySink : public SystemObject, public AcceptsTelemetryIF, public ExecutableObjectIF {
  public:
   explicit StubTelemetrySink(object_id_t objectId);
@@ -39,11 +64,39 @@ class StubTelemetrySink : public SystemObject, public AcceptsTelemetryIF, public
   ReturnValue_t performOperation(uint8_t operationCode) override;
   MessageQueueId_t getReportReceptionQueue(uint8_t virtualChannel) override;
 
+  // Console output of the TM reports is handed to the executor, in order, so a slow
+  // terminal does not hold up the TM queue. Without one the sink prints itself.
+  void setExecutor(tasks::WorkStealingExecutor* executor);
+
+  // Called for every TM packet which parses as PUS, from the thread running the sink.
+  // Set before the task starts.
+  using TmCallback = std::function<void(uint8_t service, uint8_t subservice)>;
+  void setTmCallback(TmCallback callback);
+  // Console output of the reports, e.g. off under load
+  void setConsoleOutput(bool enabled);
+
+  static constexpr size_t MAX_TM_PRINT_BYTES = 32;
+  static constexpr size_t REPORT_LINE_SIZE = 64 + 2 * MAX_TM_PRINT_BYTES;
+  // One report line for a TM packet: service, subservice and size if it parses as PUS TM,
+  // otherwise the first bytes as hex. Returns the line length.
+  static size_t formatReport(TimeReaderIF* timeReader, const uint8_t* data, size_t size, char* line,
+                             size_t lineSize);
+
  private:
   static constexpr size_t QUEUE_DEPTH = 10;
+  void report(std::string line);
+  void writeReports();
+
   MessageQueueIF* queue = nullptr;
   StorageManagerIF* tmStore = nullptr;
   TimeReaderIF* timeReader = nullptr;
+  tasks::WorkStealingExecutor* executor = nullptr;
+  TmCallback tmCallback;
+  std::atomic<bool> consoleOutput{true};
+  std::mutex reportMutex;
+  std::vector<std::string> pendingReports;
+  // At most one output job at a time keeps the reports in order
+  bool reportJobQueued = false;
 };
 
 class StubVerificationReceiver : public SystemObject,
@@ -57,27 +110,111 @@ class StubVerificationReceiver : public SystemObject,
   ReturnValue_t performOperation(uint8_t operationCode) override;
   MessageQueueId_t getVerificationQueue() override;
 
+  // Called for every verification report with the packet sequence control of its TC, from the
+  // thread running the receiver. Set before the task starts.
+  using VerificationCallback = std::function<void(uint8_t reportId, uint16_t tcSequenceControl)>;
+  void setVerificationCallback(VerificationCallback callback);
+  void setConsoleOutput(bool enabled);
+
  private:
   static constexpr size_t QUEUE_DEPTH = 10;
   MessageQueueIF* queue = nullptr;
+  VerificationCallback verificationCallback;
+  std::atomic<bool> consoleOutput{true};
 };
 
+/*
+ * PUS TC distributor of the mission. Routes by service ID through a flat table with one entry
+ * per service, the APID of the packet has to match the APID the service was registered for.
+ * TCs are either created from their fields, e.g. by the demo and the load generator, or taken
+ * from a raw CCSDS byte stream with CRC check. Services register during initialization, all
+ * TCs come from one thread.
+ */
 class StubPusDistributor : public SystemObject, public PUSDistributorIF {
  public:
-  explicit StubPusDistributor(object_id_t objectId);
+  // Largest TC, the largest page of the TC store
+  static constexpr size_t MAX_TC_SIZE = 512;
+  // Primary header, PUS-C secondary header and CRC
+  static constexpr size_t MIN_TC_SIZE = 6 + 5 + 2;
+  // TCs created without a service go to this one
+  static constexpr uint8_t DEFAULT_SERVICE = 200;
+
+  struct Telecommand {
+    uint8_t subservice = 0;
+    const uint8_t* data = nullptr;
+    size_t dataLen = 0;
+    // 0 for DEFAULT_SERVICE
+    uint8_t service = 0;
+  };
+
+  struct StreamStatistics {
+    uint32_t packets = 0;      // complete packets with a plausible header
+    uint32_t routed = 0;
+    uint32_t crcErrors = 0;
+    uint32_t syncErrors = 0;   // bytes skipped to find the next header
+    uint32_t unroutable = 0;   // no service for service ID and APID
+    uint32_t rejected = 0;     // TC store or service queue full
+  };
+
+  explicit StubPusDistributor(object_id_t objectId, uint16_t apid = 0x01);
 
   ReturnValue_t initialize() override;
+  // Registers for the APID of the distributor. Registering the same service again is fine,
+  // a different one for a taken service ID is rejected.
   ReturnValue_t registerService(AcceptsTelecommandsIF* service) override;
-
-  ReturnValue_t sendCommand(uint8_t subservice, const uint8_t* data = nullptr, size_t dataLen = 0);
+  ReturnValue_t registerService(AcceptsTelecommandsIF* service, uint16_t serviceApid);
+
+  // The sequence count of the TC is optionally handed back, e.g. to match its verification
+  ReturnValue_t sendCommand(uint8_t subservice, const uint8_t* data = nullptr, size_t dataLen = 0,
+                            uint16_t* sequenceCount = nullptr);
+  // Command sequences: all TCs are serialized into TC store elements first, then queued back
+  // to back in order, so the service picks them up in as few cycles as possible. With a
+  // TcPoolManager as TC store the elements are reserved under a single store lock. Stops at the
+  // first TC which does not fit into the store or the service queue, its element and those of
+  // the following TCs are released. *queued tells how many went out, the rest can be resent
+  // later. The queued TCs have consecutive sequence counts starting at *firstSequenceCount.
+  ReturnValue_t sendCommands(const Telecommand* commands, size_t count, size_t* queued = nullptr,
+                             uint16_t* firstSequenceCount = nullptr);
+
+  // Raw space packets, e.g. from a socket or a serial line, in chunks of any size. A packet
+  // split over chunks is completed with the next one. After an implausible header or a wrong
+  // CRC the stream is searched byte by byte for the next packet, so a corrupted length field
+  // does not swallow the packets behind it.
+  void ingestStream(const uint8_t* data, size_t size);
+  [[nodiscard]] StreamStatistics getStreamStatistics() const;
+
+  // 14 bit packet sequence count
+  static constexpr uint16_t SEQUENCE_COUNT_MASK = 0x3FFF;
 
  private:
-  AcceptsTelecommandsIF* registeredService = nullptr;
-  MessageQueueId_t serviceRequestQueue = MessageQueueIF::NO_QUEUE;
-  uint8_t registeredServiceId = 0;
+  // Hot part of a table entry, the whole table fits into 2 KiB
+  struct Route {
+    MessageQueueId_t queue = MessageQueueIF::NO_QUEUE;
+    uint16_t apid = 0;
+  };
+
+  [[nodiscard]] const Route* routeOf(uint8_t service, uint16_t packetApid) const;
+  // Reserves elements for batchSizes into batchStoreIds and batchElements, returns how many
+  size_t reserveBatch(ReturnValue_t& result);
+  ReturnValue_t serializeCommand(const Telecommand& command, uint16_t sequenceCount,
+                                 uint8_t* element, size_t size) const;
+  // Routes the complete packets at the start of data, returns the bytes consumed
+  size_t ingestPackets(const uint8_t* data, size_t size);
+  void routePacket(const uint8_t* packet, size_t size);
+
+  std::array<Route, 256> routes{};
+  std::array<AcceptsTelecommandsIF*, 256> services{};
   StorageManagerIF* tcStore = nullptr;
+  TcPoolManager* batchStore = nullptr;  // tcStore, if it can reserve a batch at once
   uint16_t sequenceCounter = 0;
-  uint16_t apid = 0x01;
+  uint16_t apid;
+  // Store elements of the batch in flight, kept to avoid an allocation per batch
+  std::vector<size_t> batchSizes;
+  std::vector<store_address_t> batchStoreIds;
+  std::vector<uint8_t*> batchElements;
+  // Start of a packet split over stream chunks
+  std::vector<uint8_t> streamBuffer;
+  StreamStatistics streamStatistics;
 };
 
 }  // namespace webcam
\ No newline at end of file
@@ -15,7 +15,10 @@
 
 #include "WebcamCommandingService.h"
 
+#include <linux/videodev2.h>
+
 #include <cstring>
+#include <string>
 
 #include "FSFWConfig.h"
 
@@ -26,18 +29,35 @@
 #include <fsfw/parameters/ReceivesParameterMessagesIF.h>
 #include <fsfw/pus/servicepackets/Service20Packets.h>
 #include <fsfw/pus/servicepackets/Service8Packets.h>
+#include <fsfw/serialize/SerializeAdapter.h>
 #include <fsfw/serviceinterface/ServiceInterface.h>
 #include <fsfw/storagemanager/StorageManagerIF.h>
 
+#include "mission/imaging/ColorConversion.h"
+#include "mission/imaging/JpegEncoder.h"
+#include "mission/imaging/MjpegPassthrough.h"
 #include "mission/messaging/MessageTypes.h"
+#include "mission/timing/LatencyHistogram.h"
 
 namespace webcam {
 namespace {
 constexpr uint8_t WEBCAM_PARAMETER_DOMAIN = 0;
+// count, min, max, mean, p50, p99 and the buckets, all uint32_t
+constexpr size_t LATENCY_HISTOGRAM_FIELDS = 6 + timing::LatencyHistogram::BUCKET_COUNT;
+constexpr size_t LATENCY_DUMP_SIZE = 3 * LATENCY_HISTOGRAM_FIELDS * sizeof(uint32_t);
+// sequence, subservice, factor, width, height, total size, offset
+constexpr size_t IMAGE_SEGMENT_HEADER_SIZE = 4 + 1 + 1 + 2 + 2 + 4 + 4;
+// x, y, width, height as uint16_t, optionally followed by the factor
+constexpr size_t REGION_TC_SIZE = 4 * sizeof(uint16_t);
 }
 
 WebcamCommandingService::WebcamCommandingService(object_id_t objectId, VerificationReporterIF* reporter)
     : CommandingServiceBase(objectId, APID, SERVICE_ID, fsfwconfig::FSFW_CSB_FIFO_DEPTH, 60, 20, reporter) {}
+void WebcamCommandingService::setBackgroundPolicy(const tasks::ThreadPolicy& policy) {
+  policy.apply(encodeStage.getThreadHandle(), "JPEG encoder");
+  policy.apply(snapshotWriter.getThreadHandle(), "snapshot writer");
+}
+
 ReturnValue_t WebcamCommandingService::initialize() {
   ReturnValue_t result = CommandingServiceBase::initialize();
   if (result != returnvalue::OK) {
@@ -52,6 +72,32 @@ ReturnValue_t WebcamCommandingService::initialize() {
     return returnvalue::FAILED;
   }
 
+  frameStore = ObjectManager::instance()->get<FrameStoreIF>(webcam::objectIdWebcamComIF);
+  if (frameStore == nullptr) {
+    sif::printWarning("WebcamCommandingService::initialize: Frame store unavailable\n");
+  }
+
+  bool anyHandler = false;
+  for (uint8_t camera = 0; camera < MAX_CAMERAS; camera++) {
+    webcamHandlers[camera] =
+        ObjectManager::instance()->get<WebcamDeviceHandler>(handlerObjectId(camera));
+    anyHandler = anyHandler || webcamHandlers[camera] != nullptr;
+  }
+  if (!anyHandler) {
+    sif::printWarning("WebcamCommandingService::initialize: Webcam handler unavailable, no latency data\n");
+  }
+
+  productBuffer.resize(MAX_IMAGE_PRODUCT_SIZE);
+
+  snapshotWriter.setSaturationCallback([](const imaging::SnapshotWriter::Statistics& statistics) {
+    sif::printWarning(
+        "WebcamCommandingService: Snapshot writer saturated, %u queued, %lu rejected, "
+        "slowest write %u us\n",
+        static_cast<unsigned int>(statistics.queueDepth),
+        static_cast<unsigned long>(statistics.rejected),
+        static_cast<unsigned int>(statistics.maxWriteTimeUs));
+  });
+
   return returnvalue::OK;
 }
 
@@ -61,6 +107,13 @@ ReturnValue_t WebcamCommandingService::isValidSubservice(uint8_t subservice) {
     case Subservice::COMMAND_SET_FRAME_RATE:
     case Subservice::COMMAND_GET_FRAME_RATE:
     case Subservice::PARAMETER_DUMP:
+    case Subservice::COMMAND_START_STREAM:
+    case Subservice::COMMAND_STOP_STREAM:
+    case Subservice::COMMAND_BURST:
+    case Subservice::LATENCY_DUMP:
+    case Subservice::COMMAND_THUMBNAIL:
+    case Subservice::COMMAND_REGION_OF_INTEREST:
+    case Subservice::COMMAND_SELECT_CAMERA:
       return returnvalue::OK;
     default:
       return AcceptsTelecommandsIF::INVALID_SUBSERVICE;
@@ -70,11 +123,25 @@ ReturnValue_t WebcamCommandingService::isValidSubservice(uint8_t subservice) {
 ReturnValue_t WebcamCommandingService::getMessageQueueAndObject(uint8_t subservice, const uint8_t* tcData,
                                                                 size_t tcDataLen, MessageQueueId_t* id,
                                                                 object_id_t* objectId) {
-  *objectId = webcam::objectIdWebcamHandler;
+  *objectId = handlerObjectId(selectedCamera);
+  if (static_cast<Subservice>(subservice) == Subservice::COMMAND_SELECT_CAMERA) {
+    // Addressed to the camera to be selected, which must exist
+    if (tcDataLen != 1 || tcData == nullptr || tcData[0] >= MAX_CAMERAS) {
+      return CommandingServiceBase::INVALID_TC;
+    }
+    *objectId = handlerObjectId(tcData[0]);
+  }
   switch (static_cast<Subservice>(subservice)) {
     case Subservice::COMMAND_TAKE_SNAPSHOT:
     case Subservice::COMMAND_SET_FRAME_RATE:
-    case Subservice::COMMAND_GET_FRAME_RATE: {
+    case Subservice::COMMAND_GET_FRAME_RATE:
+    case Subservice::COMMAND_START_STREAM:
+    case Subservice::COMMAND_STOP_STREAM:
+    case Subservice::COMMAND_BURST:
+    case Subservice::LATENCY_DUMP:
+    case Subservice::COMMAND_THUMBNAIL:
+    case Subservice::COMMAND_REGION_OF_INTEREST:
+    case Subservice::COMMAND_SELECT_CAMERA: {
       auto* handler = ObjectManager::instance()->get<DeviceHandlerIF>(*objectId);
       if (handler == nullptr) {
         return CommandingServiceBase::INVALID_OBJECT;
@@ -97,7 +164,14 @@ ReturnValue_t WebcamCommandingService::getMessageQueueAndObject(uint8_t subservi
 
 ReturnValue_t WebcamCommandingService::prepareCommand(CommandMessage* message, uint8_t subservice,
                                                       const uint8_t* tcData, size_t tcDataLen, uint32_t* state,
-                                                      object_id_t) {
+                                                      object_id_t objectId) {
+  // Handed back to handleReply(), tells the snapshot variants apart
+  *state = subservice;
+  const uint8_t camera = cameraOfHandler(objectId);
+  if (camera < MAX_CAMERAS) {
+    // The command is only queued after we return, the handler is woken afterwards
+    wakeupPending[camera] = true;
+  }
   switch (static_cast<Subservice>(subservice)) {
     case Subservice::COMMAND_TAKE_SNAPSHOT:
       return prepareDeviceCommand(message, ::webcam::CommandId::commandTakeSnapshot, tcData, tcDataLen);
@@ -105,18 +179,34 @@ ReturnValue_t WebcamCommandingService::prepareCommand(CommandMessage* message, u
       return prepareDeviceCommand(message, ::webcam::CommandId::commandSetFrameRate, tcData, tcDataLen);
     case Subservice::COMMAND_GET_FRAME_RATE:
       return prepareDeviceCommand(message, ::webcam::CommandId::commandGetFrameRate, tcData, tcDataLen);
+    case Subservice::COMMAND_START_STREAM:
+      return prepareDeviceCommand(message, ::webcam::CommandId::commandStartStream, tcData, tcDataLen);
+    case Subservice::COMMAND_STOP_STREAM:
+      return prepareDeviceCommand(message, ::webcam::CommandId::commandStopStream, tcData, tcDataLen);
+    case Subservice::COMMAND_BURST:
+      return prepareDeviceCommand(message, ::webcam::CommandId::commandBurst, tcData, tcDataLen);
     case Subservice::PARAMETER_DUMP:
       return prepareParameterDump(message, tcData, tcDataLen);
+    case Subservice::LATENCY_DUMP:
+      // Answered by the service itself, no message goes to the handler
+      return dumpFrameLatency(handlerOf(cameraOfHandler(objectId)), tcData, tcDataLen);
+    case Subservice::COMMAND_THUMBNAIL:
+    case Subservice::COMMAND_REGION_OF_INTEREST:
+      return prepareImageProduct(message, static_cast<Subservice>(subservice), tcData, tcDataLen,
+                                 objectId);
+    case Subservice::COMMAND_SELECT_CAMERA:
+      return selectCamera(objectId, tcDataLen);
     default:
       return CommandingServiceBase::INVALID_SUBSERVICE;
   }
 }
 
-ReturnValue_t WebcamCommandingService::handleReply(const CommandMessage* reply, Command_t, uint32_t*,
-                                                   CommandMessage*, object_id_t objectId, bool* isStep) {
+ReturnValue_t WebcamCommandingService::handleReply(const CommandMessage* reply, Command_t,
+                                                   uint32_t* state, CommandMessage*,
+                                                   object_id_t objectId, bool* isStep) {
   switch (reply->getMessageType()) {
     case messagetypes::ACTION:
-      return handleActionReply(reply, isStep);
+      return handleActionReply(reply, *state, objectId, isStep);
     case messagetypes::PARAMETER:
       return handleParameterReply(reply, objectId);
     default:
@@ -132,6 +222,8 @@ ReturnValue_t WebcamCommandingService::prepareDeviceCommand(CommandMessage* mess
   switch (command) {
     case ::webcam::CommandId::commandTakeSnapshot:
     case ::webcam::CommandId::commandGetFrameRate:
+    case ::webcam::CommandId::commandStartStream:
+    case ::webcam::CommandId::commandStopStream:
       if (tcDataLen != 0) {
         return CommandingServiceBase::INVALID_TC;
       }
@@ -144,6 +236,14 @@ ReturnValue_t WebcamCommandingService::prepareDeviceCommand(CommandMessage* mess
       std::memcpy(parameterBuffer, tcData, sizeof(double));
       parameterSize = sizeof(double);
       break;
+    case ::webcam::CommandId::commandBurst:
+      // frame count, uint32_t
+      if (tcDataLen != sizeof(uint32_t) || tcData == nullptr) {
+        return CommandingServiceBase::INVALID_TC;
+      }
+      std::memcpy(parameterBuffer, tcData, sizeof(uint32_t));
+      parameterSize = sizeof(uint32_t);
+      break;
     default:
       return CommandingServiceBase::INVALID_TC;
   }
@@ -169,6 +269,56 @@ ReturnValue_t WebcamCommandingService::prepareDeviceCommand(CommandMessage* mess
   return returnvalue::OK;
 }
 
+ReturnValue_t WebcamCommandingService::prepareImageProduct(CommandMessage* message,
+                                                           Subservice subservice,
+                                                           const uint8_t* tcData, size_t tcDataLen,
+                                                           object_id_t objectId) {
+  const uint8_t camera = cameraOfHandler(objectId);
+  if (camera >= MAX_CAMERAS) {
+    return CommandingServiceBase::INVALID_OBJECT;
+  }
+  ImageProductRequest request;
+  size_t remaining = tcDataLen;
+  if (subservice == Subservice::COMMAND_THUMBNAIL) {
+    // optional factor, uint8_t
+    request.factor = DEFAULT_THUMBNAIL_FACTOR;
+    if (remaining > 1 || (remaining == 1 && tcData == nullptr)) {
+      return CommandingServiceBase::INVALID_TC;
+    }
+  } else {
+    // x, y, width, height as uint16_t and an optional factor, uint8_t
+    if ((remaining != REGION_TC_SIZE && remaining != REGION_TC_SIZE + 1) || tcData == nullptr) {
+      return CommandingServiceBase::INVALID_TC;
+    }
+    uint16_t values[4] = {};
+    for (uint16_t& value : values) {
+      ReturnValue_t result = SerializeAdapter::deSerialize(&value, &tcData, &remaining,
+                                                           SerializeIF::Endianness::BIG);
+      if (result != returnvalue::OK) {
+        return result;
+      }
+    }
+    request.region = imaging::Region{values[0], values[1], values[2], values[3]};
+    if (request.region.width == 0 || request.region.height == 0) {
+      return CommandingServiceBase::INVALID_TC;
+    }
+  }
+  if (remaining == 1) {
+    request.factor = tcData[0];
+    request.automaticFactor = false;
+  }
+  if (request.factor == 0 || request.factor > imaging::ImageScaler::MAX_FACTOR) {
+    return CommandingServiceBase::INVALID_TC;
+  }
+
+  ReturnValue_t result = prepareDeviceCommand(message, ::webcam::CommandId::commandTakeSnapshot,
+                                              nullptr, 0);
+  if (result == returnvalue::OK) {
+    productRequests[camera] = request;
+  }
+  return result;
+}
+
 ReturnValue_t WebcamCommandingService::prepareParameterDump(CommandMessage* message, const uint8_t* tcData,
                                                             size_t tcDataLen) {
   uint8_t parameterRaw = messagetypes::mission::webcam::PARAM_FRAME_RATE;
@@ -184,7 +334,9 @@ ReturnValue_t WebcamCommandingService::prepareParameterDump(CommandMessage* mess
   return returnvalue::OK;
 }
 
-ReturnValue_t WebcamCommandingService::handleActionReply(const CommandMessage* reply, bool* isStep) {
+ReturnValue_t WebcamCommandingService::handleActionReply(const CommandMessage* reply,
+                                                         uint32_t state, object_id_t objectId,
+                                                         bool* isStep) {
   const Command_t replyId = reply->getCommand();
   switch (replyId) {
     case ActionMessage::COMPLETION_SUCCESS:
@@ -194,22 +346,12 @@ ReturnValue_t WebcamCommandingService::handleActionReply(const CommandMessage* r
       return returnvalue::OK;
     case ActionMessage::DATA_REPLY: {
       *isStep = true;
-      store_address_t storeId = ActionMessage::getStoreId(reply);
-      const uint8_t* data = nullptr;
-      size_t size = 0;
-      if (ipcStore == nullptr) {
-        sif::printError("WebcamCommandingService::handleActionReply: IPC store unavailable\n");
-        return returnvalue::FAILED;
-      }
-      ReturnValue_t result = ipcStore->getData(storeId, &data, &size);
-      if (result != returnvalue::OK) {
-        return result;
-      }
-      DataReply dataReply(webcam::objectIdWebcamHandler, ActionMessage::getActionId(reply), data,
-                          static_cast<uint16_t>(size));
-      result = sendTmPacket(static_cast<uint8_t>(Subservice::TM_COMMAND_DATA_REPLY), dataReply);
-      ipcStore->deleteData(storeId);
-      return result;
+      const auto subservice = static_cast<Subservice>(state);
+      const uint8_t camera = cameraOfHandler(objectId);
+      const bool isProduct = camera < MAX_CAMERAS &&
+                             (subservice == Subservice::COMMAND_THUMBNAIL ||
+                              subservice == Subservice::COMMAND_REGION_OF_INTEREST);
+      return handleDataReply(reply, objectId, isProduct ? &productRequests[camera] : nullptr);
     }
     case ActionMessage::STEP_FAILED:
       *isStep = true;
@@ -221,6 +363,53 @@ ReturnValue_t WebcamCommandingService::handleActionReply(const CommandMessage* r
   }
 }
 
+void WebcamCommandingService::handleUnrequestedReply(CommandMessage* reply) {
+  if (reply->getMessageType() == messagetypes::ACTION &&
+      reply->getCommand() == ActionMessage::DATA_REPLY) {
+    (void)handleDataReply(reply, senderOf(reply));
+    return;
+  }
+  CommandingServiceBase::handleUnrequestedReply(reply);
+}
+
+ReturnValue_t WebcamCommandingService::handleDataReply(const CommandMessage* reply,
+                                                       object_id_t objectId,
+                                                       const ImageProductRequest* product) {
+  store_address_t storeId = ActionMessage::getStoreId(reply);
+  const uint8_t* data = nullptr;
+  size_t size = 0;
+  if (ipcStore == nullptr) {
+    sif::printError("WebcamCommandingService::handleDataReply: IPC store unavailable\n");
+    return returnvalue::FAILED;
+  }
+  ReturnValue_t result = ipcStore->getData(storeId, &data, &size);
+  if (result != returnvalue::OK) {
+    return result;
+  }
+  FrameDescriptor descriptor;
+  const bool isSnapshot =
+      ActionMessage::getActionId(reply) == messagetypes::mission::webcam::TAKE_SNAPSHOT;
+  if (isSnapshot) {
+    result = handleSnapshotDescriptor(data, size, descriptor, product);
+    if (result != returnvalue::OK) {
+      ipcStore->deleteData(storeId);
+      return result;
+    }
+    // Downlink the descriptor with our timestamps
+    data = reinterpret_cast<const uint8_t*>(&descriptor);
+  }
+  DataReply dataReply(objectId, ActionMessage::getActionId(reply), data,
+                      static_cast<uint16_t>(size));
+  result = sendTmPacket(static_cast<uint8_t>(Subservice::TM_COMMAND_DATA_REPLY), dataReply);
+  ipcStore->deleteData(storeId);
+  WebcamDeviceHandler* handler = isSnapshot ? handlerOf(descriptor.camera) : nullptr;
+  if (result == returnvalue::OK && handler != nullptr && descriptor.storeTimeUs != 0) {
+    handler->getFrameLatency().storeToTm.record(timing::monotonicTimeUs() -
+                                                descriptor.storeTimeUs);
+  }
+  return result;
+}
+
 ReturnValue_t WebcamCommandingService::handleParameterReply(const CommandMessage* reply, object_id_t objectId) {
   if (reply->getCommand() != ParameterMessage::REPLY_PARAMETER_DUMP) {
     return CommandingServiceBase::INVALID_REPLY;
@@ -242,4 +431,267 @@ ReturnValue_t WebcamCommandingService::handleParameterReply(const CommandMessage
   return result;
 }
 
-}  // namespace webcam
\ No newline at end of file
+ReturnValue_t WebcamCommandingService::handleSnapshotDescriptor(const uint8_t* data, size_t size,
+                                                                FrameDescriptor& descriptor,
+                                                                const ImageProductRequest* product) {
+  if (size != sizeof(FrameDescriptor)) {
+    return CommandingServiceBase::INVALID_REPLY;
+  }
+  std::memcpy(&descriptor, data, sizeof(descriptor));
+  if (frameStore == nullptr) {
+    return returnvalue::OK;
+  }
+  // The handler took a reference for us before reporting, the frame stays in the capture
+  // buffer until it is released below
+  FrameLease lease(descriptor.lease);
+  const uint8_t* frameData = nullptr;
+  ReturnValue_t result = returnvalue::OK;
+  // Keep our descriptor, the one in the store lacks the timestamps added on the way
+  if (frameStore->getFrame(lease, &frameData, nullptr) == returnvalue::OK) {
+    if (product != nullptr) {
+      result = sendImageProduct(descriptor, frameData, *product);
+    } else {
+      persistSnapshot(descriptor, frameData);
+    }
+  } else {
+    sif::printWarning("WebcamCommandingService: Frame %u expired before downlink\n",
+                      static_cast<unsigned int>(descriptor.sequence));
+  }
+  ReturnValue_t releaseResult = frameStore->releaseFrame(lease);
+  return result != returnvalue::OK ? result : releaseResult;
+}
+
+void WebcamCommandingService::persistSnapshot(FrameDescriptor& descriptor,
+                                              const uint8_t* frameData) {
+  // The sequence counts per device, the camera keeps the names apart
+  const std::string baseName = "snapshot_" + std::to_string(descriptor.camera) + "_" +
+                               std::to_string(descriptor.sequence);
+  WebcamDeviceHandler* handler = handlerOf(descriptor.camera);
+  bool queued = false;
+  switch (descriptor.pixelFormat) {
+    case V4L2_PIX_FMT_MJPEG:
+    case V4L2_PIX_FMT_JPEG: {
+      if ((descriptor.flags & FRAME_FLAG_JPEG_NO_HUFFMAN) == 0) {
+        queued = snapshotWriter.submitCopy(baseName + ".jpg", frameData, descriptor.bytesUsed);
+        break;
+      }
+      // The camera left out the Huffman tables, copied once with the standard ones added
+      imaging::MjpegFrameInfo jpeg;
+      jpeg.length = descriptor.bytesUsed;
+      jpeg.scanOffset = descriptor.scanOffset;
+      imaging::SnapshotBuffer file = snapshotWriter.acquireBuffer(jpeg.completedSize());
+      if (!file.isValid()) {
+        return;
+      }
+      imaging::completeMjpeg(frameData, jpeg, file.data());
+      queued = snapshotWriter.submit(baseName + ".jpg", std::move(file));
+      break;
+    }
+    case V4L2_PIX_FMT_YUYV: {
+      if (descriptor.bytesUsed < imaging::yuyvSize(descriptor.width, descriptor.height)) {
+        sif::printWarning("WebcamCommandingService: Frame %u is truncated, not stored\n",
+                          static_cast<unsigned int>(descriptor.sequence));
+        return;
+      }
+      // Copied into the encoder stage, compression runs on its own thread
+      const int quality = handler != nullptr ? handler->getJpegQuality()
+                                             : imaging::JpegEncoder::DEFAULT_QUALITY;
+      queued = encodeStage.submitYuyv(baseName + ".jpg", frameData, descriptor.width,
+                                      descriptor.height, quality);
+      break;
+    }
+    default:
+      queued = snapshotWriter.submitCopy(baseName + ".raw", frameData, descriptor.bytesUsed);
+      break;
+  }
+  if (!queued) {
+    sif::printWarning("WebcamCommandingService: Snapshot %u dropped, writer busy\n",
+                      static_cast<unsigned int>(descriptor.sequence));
+    return;
+  }
+  descriptor.storeTimeUs = timing::monotonicTimeUs();
+  if (handler != nullptr && descriptor.dequeueTimeUs != 0) {
+    handler->getFrameLatency().dequeueToStore.record(descriptor.storeTimeUs -
+                                                     descriptor.dequeueTimeUs);
+  }
+}
+
+ReturnValue_t WebcamCommandingService::sendImageProduct(const FrameDescriptor& descriptor,
+                                                        const uint8_t* frameData,
+                                                        const ImageProductRequest& product) {
+  uint32_t scaleFactor = product.factor;
+  // The TC left the factor open, reduce further until the product fits
+  while (product.automaticFactor && scaleFactor < imaging::ImageScaler::MAX_FACTOR) {
+    const imaging::ScaledImage candidate = imaging::ImageScaler::scaledSize(
+        descriptor.width, descriptor.height, product.region, scaleFactor);
+    if (candidate.size <= productBuffer.size()) {
+      break;
+    }
+    scaleFactor++;
+  }
+  imaging::ScaledImage image;
+  bool scaled = false;
+  switch (descriptor.pixelFormat) {
+    case V4L2_PIX_FMT_YUYV:
+      if (descriptor.bytesUsed >= imaging::yuyvSize(descriptor.width, descriptor.height)) {
+        scaled = imageScaler.scaleYuyv(frameData, descriptor.width, descriptor.height,
+                                       product.region, scaleFactor, productBuffer.data(),
+                                       productBuffer.size(), image);
+      }
+      break;
+    case V4L2_PIX_FMT_MJPEG:
+    case V4L2_PIX_FMT_JPEG:
+      scaled = imageScaler.scaleMjpeg(frameData, descriptor.bytesUsed, product.region, scaleFactor,
+                                      productBuffer.data(), productBuffer.size(), image);
+      break;
+    default:
+      break;
+  }
+  if (!scaled) {
+    const imaging::ScaledImage expected = imaging::ImageScaler::scaledSize(
+        descriptor.width, descriptor.height, product.region, scaleFactor);
+    sif::printWarning(
+        "WebcamCommandingService: No image product for frame %u, %ux%u from a %ux%u frame "
+        "(limit %u bytes)\n",
+        static_cast<unsigned int>(descriptor.sequence), static_cast<unsigned int>(expected.width),
+        static_cast<unsigned int>(expected.height), static_cast<unsigned int>(descriptor.width),
+        static_cast<unsigned int>(descriptor.height),
+        static_cast<unsigned int>(MAX_IMAGE_PRODUCT_SIZE));
+    return returnvalue::FAILED;
+  }
+
+  // Every segment repeats the product header, so the ground can reassemble out of order
+  uint8_t segment[IMAGE_SEGMENT_HEADER_SIZE + IMAGE_SEGMENT_SIZE];
+  const uint8_t subservice = product.region.width == 0
+                                 ? static_cast<uint8_t>(Subservice::COMMAND_THUMBNAIL)
+                                 : static_cast<uint8_t>(Subservice::COMMAND_REGION_OF_INTEREST);
+  const auto factor = static_cast<uint8_t>(scaleFactor);
+  const auto width = static_cast<uint16_t>(image.width);
+  const auto height = static_cast<uint16_t>(image.height);
+  const auto totalSize = static_cast<uint32_t>(image.size);
+  for (uint32_t offset = 0; offset < totalSize; offset += IMAGE_SEGMENT_SIZE) {
+    const size_t dataSize =
+        totalSize - offset < IMAGE_SEGMENT_SIZE ? totalSize - offset : IMAGE_SEGMENT_SIZE;
+    uint8_t* cursor = segment;
+    size_t serializedSize = 0;
+    ReturnValue_t result = SerializeAdapter::serialize(&descriptor.sequence, &cursor,
+                                                       &serializedSize, sizeof(segment),
+                                                       SerializeIF::Endianness::BIG);
+    if (result == returnvalue::OK) {
+      result = SerializeAdapter::serialize(&subservice, &cursor, &serializedSize, sizeof(segment),
+                                           SerializeIF::Endianness::BIG);
+    }
+    if (result == returnvalue::OK) {
+      result = SerializeAdapter::serialize(&factor, &cursor, &serializedSize, sizeof(segment),
+                                           SerializeIF::Endianness::BIG);
+    }
+    if (result == returnvalue::OK) {
+      result = SerializeAdapter::serialize(&width, &cursor, &serializedSize, sizeof(segment),
+                                           SerializeIF::Endianness::BIG);
+    }
+    if (result == returnvalue::OK) {
+      result = SerializeAdapter::serialize(&height, &cursor, &serializedSize, sizeof(segment),
+                                           SerializeIF::Endianness::BIG);
+    }
+    if (result == returnvalue::OK) {
+      result = SerializeAdapter::serialize(&totalSize, &cursor, &serializedSize, sizeof(segment),
+                                           SerializeIF::Endianness::BIG);
+    }
+    if (result == returnvalue::OK) {
+      result = SerializeAdapter::serialize(&offset, &cursor, &serializedSize, sizeof(segment),
+                                           SerializeIF::Endianness::BIG);
+    }
+    if (result != returnvalue::OK) {
+      return result;
+    }
+    std::memcpy(cursor, productBuffer.data() + offset, dataSize);
+    result = sendTmPacket(static_cast<uint8_t>(Subservice::TM_IMAGE_SEGMENT), segment,
+                          serializedSize + dataSize);
+    if (result != returnvalue::OK) {
+      return result;
+    }
+  }
+  return returnvalue::OK;
+}
+
+ReturnValue_t WebcamCommandingService::dumpFrameLatency(WebcamDeviceHandler* handler,
+                                                        const uint8_t* tcData, size_t tcDataLen) {
+  if (tcDataLen > 1 || (tcDataLen == 1 && tcData == nullptr)) {
+    return CommandingServiceBase::INVALID_TC;
+  }
+  if (handler == nullptr) {
+    return CommandingServiceBase::INVALID_OBJECT;
+  }
+  const bool resetAfterDump = tcDataLen == 1 && tcData[0] != 0;
+  WebcamDeviceHandler::FrameLatency& latency = handler->getFrameLatency();
+  timing::LatencyHistogram* histograms[] = {&latency.captureToDequeue, &latency.dequeueToStore,
+                                            &latency.storeToTm};
+
+  uint8_t buffer[LATENCY_DUMP_SIZE];
+  uint8_t* cursor = buffer;
+  size_t serializedSize = 0;
+  ReturnValue_t result = returnvalue::OK;
+  for (timing::LatencyHistogram* histogram : histograms) {
+    const timing::LatencyHistogram::Snapshot snapshot = histogram->snapshot();
+    const uint32_t summary[] = {snapshot.count,  snapshot.minUs,           snapshot.maxUs,
+                                snapshot.meanUs, snapshot.percentileUs(50), snapshot.percentileUs(99)};
+    for (uint32_t value : summary) {
+      if (result == returnvalue::OK) {
+        result = SerializeAdapter::serialize(&value, &cursor, &serializedSize, sizeof(buffer),
+                                             SerializeIF::Endianness::BIG);
+      }
+    }
+    for (uint32_t value : snapshot.buckets) {
+      if (result == returnvalue::OK) {
+        result = SerializeAdapter::serialize(&value, &cursor, &serializedSize, sizeof(buffer),
+                                             SerializeIF::Endianness::BIG);
+      }
+    }
+    if (resetAfterDump) {
+      histogram->reset();
+    }
+  }
+  if (result != returnvalue::OK) {
+    return result;
+  }
+  result = sendTmPacket(static_cast<uint8_t>(Subservice::TM_LATENCY_DUMP), buffer, serializedSize);
+  if (result != returnvalue::OK) {
+    return result;
+  }
+  return CommandingServiceBase::EXECUTION_COMPLETE;
+}
+
+ReturnValue_t WebcamCommandingService::selectCamera(object_id_t objectId, size_t tcDataLen) {
+  const uint8_t camera = cameraOfHandler(objectId);
+  if (tcDataLen != 1 || camera >= MAX_CAMERAS) {
+    return CommandingServiceBase::INVALID_TC;
+  }
+  selectedCamera = camera;
+  sif::printInfo("WebcamCommandingService: Camera %u selected\n", static_cast<unsigned int>(camera));
+  return CommandingServiceBase::EXECUTION_COMPLETE;
+}
+
+void WebcamCommandingService::doPeriodicOperation() {
+  for (uint8_t camera = 0; camera < MAX_CAMERAS; camera++) {
+    if (wakeupPending[camera] && webcamHandlers[camera] != nullptr) {
+      webcamHandlers[camera]->wakeUp();
+    }
+    wakeupPending[camera] = false;
+  }
+}
+
+WebcamDeviceHandler* WebcamCommandingService::handlerOf(uint32_t camera) const {
+  return camera < MAX_CAMERAS ? webcamHandlers[camera] : nullptr;
+}
+
+object_id_t WebcamCommandingService::senderOf(const CommandMessage* reply) const {
+  for (uint8_t camera = 0; camera < MAX_CAMERAS; camera++) {
+    if (webcamHandlers[camera] != nullptr &&
+        webcamHandlers[camera]->getCommandQueue() == reply->getSender()) {
+      return handlerObjectId(camera);
+    }
+  }
+  return objects::NO_OBJECT;
+}
+
+}  // namespace webcam
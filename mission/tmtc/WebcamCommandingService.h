@@ -20,9 +20,17 @@
 #include <fsfw/parameters/ParameterMessage.h>
 #include <fsfw/tmtcservices/CommandingServiceBase.h>
 
+#include <array>
 #include <cstddef>
+#include <vector>
 
+#include "mission/imaging/ImageScaler.h"
+#include "mission/imaging/JpegEncoder.h"
+#include "mission/imaging/SnapshotWriter.h"
+#include "mission/tasks/ThreadPolicy.h"
+#include "mission/webcam/FrameStoreIF.h"
 #include "mission/webcam/WebcamDefinitions.h"
+#include "mission/webcam/WebcamDeviceHandler.h"
 
 class CommandMessage;
 
@@ -38,12 +46,34 @@ namespace webcam {
             COMMAND_SET_FRAME_RATE = 2,
             COMMAND_GET_FRAME_RATE = 3,
             PARAMETER_DUMP = 4,
+            COMMAND_START_STREAM = 5,
+            COMMAND_STOP_STREAM = 6,
+            COMMAND_BURST = 7,
+            LATENCY_DUMP = 8,
+            // Reduced snapshots, computed on the raw frame and downlinked as TM_IMAGE_SEGMENT
+            COMMAND_THUMBNAIL = 9,
+            COMMAND_REGION_OF_INTEREST = 10,
+            // Camera index, uint8_t. All following TCs go to that camera's handler.
+            COMMAND_SELECT_CAMERA = 11,
             TM_PARAMETER_DUMP = 130,
             TM_COMMAND_DATA_REPLY = 131,
+            TM_LATENCY_DUMP = 132,
+            TM_IMAGE_SEGMENT = 133,
           };
 
+        // Without a factor in the TC the smallest one from here (thumbnail) or 1 (ROI) up is
+        // used whose output fits MAX_IMAGE_PRODUCT_SIZE, e.g. 9 for a 1080p thumbnail
+        static constexpr uint8_t DEFAULT_THUMBNAIL_FACTOR = 8;
+        // Image products are YUYV, split into segments which fit the 1 KiB TM store pages
+        static constexpr size_t IMAGE_SEGMENT_SIZE = 960;
+        static constexpr size_t MAX_IMAGE_PRODUCT_SIZE = 64 * IMAGE_SEGMENT_SIZE;
+
         explicit WebcamCommandingService(object_id_t objectId, VerificationReporterIF* reporter = nullptr);
 
+        // JPEG encoder and snapshot writer threads, keeps compression and disk I/O away from
+        // the capture and handler cores
+        void setBackgroundPolicy(const tasks::ThreadPolicy& policy);
+
     protected:
         ReturnValue_t initialize() override;
         ReturnValue_t isValidSubservice(uint8_t subservice) override;
@@ -54,13 +84,59 @@ namespace webcam {
         ReturnValue_t handleReply(const CommandMessage* reply, Command_t previousCommand, uint32_t* state,
                                   CommandMessage* optionalNextCommand, object_id_t objectId,
                                   bool* isStep) override;
+        // Streamed frames and burst reports arrive after their command has completed
+        void handleUnrequestedReply(CommandMessage* reply) override;
+        // Runs after the commands of this cycle went out, wakes the event driven handler tasks
+        void doPeriodicOperation() override;
 
     private:
         ReturnValue_t prepareDeviceCommand(CommandMessage* message, ::webcam::CommandId command,
                                            const uint8_t* tcData, size_t tcDataLen);
         ReturnValue_t prepareParameterDump(CommandMessage* message, const uint8_t* tcData, size_t tcDataLen);
-        ReturnValue_t handleActionReply(const CommandMessage* reply, bool* isStep);
+        // Thumbnail or ROI of the snapshot command in flight, one command per camera at a time
+        struct ImageProductRequest {
+            imaging::Region region;
+            uint32_t factor = 1;
+            // No factor in the TC, factor is the smallest one to try
+            bool automaticFactor = true;
+        };
+
+        ReturnValue_t prepareImageProduct(CommandMessage* message, Subservice subservice,
+                                          const uint8_t* tcData, size_t tcDataLen,
+                                          object_id_t objectId);
+        ReturnValue_t handleActionReply(const CommandMessage* reply, uint32_t state,
+                                        object_id_t objectId, bool* isStep);
+        ReturnValue_t handleDataReply(const CommandMessage* reply, object_id_t objectId,
+                                      const ImageProductRequest* product = nullptr);
         ReturnValue_t handleParameterReply(const CommandMessage* reply, object_id_t objectId);
+        // Fills in the store timestamp of the descriptor
+        ReturnValue_t handleSnapshotDescriptor(const uint8_t* data, size_t size,
+                                               FrameDescriptor& descriptor,
+                                               const ImageProductRequest* product);
+        // Hands the frame to the snapshot writer, the lease can be released right after
+        void persistSnapshot(FrameDescriptor& descriptor, const uint8_t* frameData);
+        // Scales the frame and sends it as TM_IMAGE_SEGMENT packets
+        ReturnValue_t sendImageProduct(const FrameDescriptor& descriptor, const uint8_t* frameData,
+                                       const ImageProductRequest& product);
+        // Sends the frame latency histograms as TM, optionally resets them afterwards
+        ReturnValue_t dumpFrameLatency(WebcamDeviceHandler* handler, const uint8_t* tcData,
+                                       size_t tcDataLen);
+        ReturnValue_t selectCamera(object_id_t objectId, size_t tcDataLen);
+        // nullptr if the camera has no handler
+        WebcamDeviceHandler* handlerOf(uint32_t camera) const;
+        // Object id of the handler which sent the reply, for replies outside of a command
+        object_id_t senderOf(const CommandMessage* reply) const;
+
+        FrameStoreIF* frameStore = nullptr;
+        std::array<WebcamDeviceHandler*, MAX_CAMERAS> webcamHandlers{};
+        uint8_t selectedCamera = 0;
+        std::array<bool, MAX_CAMERAS> wakeupPending{};
+        imaging::SnapshotWriter snapshotWriter;
+        // Declared after the writer, it hands its output to it and must stop first
+        imaging::JpegEncodeStage encodeStage{snapshotWriter};
+        std::array<ImageProductRequest, MAX_CAMERAS> productRequests{};
+        imaging::ImageScaler imageScaler;
+        std::vector<uint8_t> productBuffer;
     };
 
 }  // namespace webcam
\ No newline at end of file
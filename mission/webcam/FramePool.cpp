@@ -0,0 +1,77 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "FramePool.h"
+
+#include <unistd.h>
+
+#include <cstdlib>
+
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+namespace webcam {
+    namespace {
+        size_t pageSize() { return static_cast<size_t>(sysconf(_SC_PAGESIZE)); }
+    }  // namespace
+
+    FramePool::~FramePool() { std::free(arena); }
+
+    size_t FramePool::frameCapacity(uint32_t width, uint32_t height) {
+        const size_t page = pageSize();
+        const size_t bytes = static_cast<size_t>(width) * height * 2;
+        return (bytes + page - 1) / page * page;
+    }
+
+    size_t FramePool::reserve(uint32_t width, uint32_t height, uint32_t bufferCount) {
+        Reservation reservation;
+        if (arena == nullptr) {
+            reservation.offset = arenaSize;
+            reservation.size = frameCapacity(width, height) * bufferCount;
+            arenaSize += reservation.size;
+        }
+        reservations.push_back(reservation);
+        return reservations.size() - 1;
+    }
+
+    ReturnValue_t FramePool::allocate() {
+        if (arena != nullptr) {
+            return returnvalue::OK;
+        }
+        if (arenaSize == 0) {
+            return returnvalue::FAILED;
+        }
+        void *memory = nullptr;
+        if (posix_memalign(&memory, pageSize(), arenaSize) != 0) {
+            sif::printError("FramePool: Allocating %zu bytes failed\n", arenaSize);
+            return returnvalue::FAILED;
+        }
+        arena = static_cast<uint8_t *>(memory);
+        sif::printInfo("FramePool: %zu KiB for %zu cameras\n", arenaSize / 1024,
+                       reservations.size());
+        return returnvalue::OK;
+    }
+
+    bool FramePool::isAllocated() const { return arena != nullptr; }
+
+    FramePool::Slice FramePool::getSlice(size_t index) const {
+        if (arena == nullptr || index >= reservations.size() || reservations[index].size == 0) {
+            return Slice{};
+        }
+        return Slice{arena + reservations[index].offset, reservations[index].size};
+    }
+
+    size_t FramePool::getSize() const { return arenaSize; }
+
+}  // namespace webcam
@@ -0,0 +1,69 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <fsfw/returnvalues/returnvalue.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace webcam {
+
+    /*
+     * Capture memory for all cameras, allocated once at startup as one page aligned arena.
+     * Every camera gets its own slice sized for its resolution and ring, handed to the ComIF
+     * through WebcamCookie::setUserPointerMode(). Slices never share a page, so a camera
+     * that stalls or restarts can not touch the frames of another and nothing allocates
+     * while the cameras stream.
+     */
+    class FramePool {
+    public:
+        struct Slice {
+            uint8_t *start = nullptr;
+            size_t size = 0;
+        };
+
+        FramePool() = default;
+        ~FramePool();
+
+        FramePool(const FramePool &) = delete;
+        FramePool &operator=(const FramePool &) = delete;
+
+        // Page aligned size of one capture buffer, YUYV is the worst case at 2 bytes per pixel
+        static size_t frameCapacity(uint32_t width, uint32_t height);
+
+        // Adds a slice for bufferCount frames and returns its index. Only before allocate().
+        size_t reserve(uint32_t width, uint32_t height, uint32_t bufferCount);
+        ReturnValue_t allocate();
+        [[nodiscard]] bool isAllocated() const;
+
+        // Empty slice if the index is unknown or the pool is not allocated
+        [[nodiscard]] Slice getSlice(size_t index) const;
+        [[nodiscard]] size_t getSize() const;
+
+    private:
+        struct Reservation {
+            size_t offset = 0;
+            size_t size = 0;
+        };
+
+        uint8_t *arena = nullptr;
+        size_t arenaSize = 0;
+        std::vector<Reservation> reservations;
+    };
+
+}  // namespace webcam
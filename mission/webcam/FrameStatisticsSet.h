@@ -0,0 +1,73 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <fsfw/datapoollocal/StaticLocalDataSet.h>
+#include <fsfw/datapoollocal/LocalPoolVariable.h>
+#include <fsfw/datapoollocal/LocalPoolVector.h>
+
+#include "mission/imaging/ImageStatistics.h"
+
+namespace webcam {
+
+    enum PoolIds : lp_id_t {
+        poolFrameSequence = 0,
+        poolFrameWidth,
+        poolFrameHeight,
+        poolLumaMean,
+        poolLumaVariance,
+        poolSaturatedRatio,
+        poolBlackRatio,
+        poolSharpness,
+        poolLumaHistogram,
+        poolExposure,
+        poolGain,
+    };
+
+    inline constexpr uint32_t FRAME_STATISTICS_SET_ID = 1;
+    inline constexpr uint8_t FRAME_STATISTICS_ENTRIES = 11;
+    inline constexpr size_t LUMA_HISTOGRAM_BINS = imaging::ImageStatistics::HISTOGRAM_BINS;
+    // Collection interval of the periodic housekeeping packet
+    inline constexpr float FRAME_STATISTICS_INTERVAL_S = 10.0f;
+
+    /*
+     * Exposure and focus health of the newest frame the handler has seen, see
+     * imaging::ImageStatistics. Width and height are those of the analysed luma plane, MJPEG
+     * frames are analysed at half size. Exposure and gain are the values last confirmed by
+     * the device, 0 until the auto exposure loop ran once.
+     */
+    class FrameStatisticsSet : public StaticLocalDataSet<FRAME_STATISTICS_ENTRIES> {
+    public:
+        explicit FrameStatisticsSet(HasLocalDataPoolIF *owner)
+            : StaticLocalDataSet(owner, FRAME_STATISTICS_SET_ID) {}
+        explicit FrameStatisticsSet(object_id_t objectId)
+            : StaticLocalDataSet(sid_t(objectId, FRAME_STATISTICS_SET_ID)) {}
+
+        lp_var_t<uint32_t> sequence = lp_var_t<uint32_t>(sid.objectId, poolFrameSequence, this);
+        lp_var_t<uint16_t> width = lp_var_t<uint16_t>(sid.objectId, poolFrameWidth, this);
+        lp_var_t<uint16_t> height = lp_var_t<uint16_t>(sid.objectId, poolFrameHeight, this);
+        lp_var_t<float> lumaMean = lp_var_t<float>(sid.objectId, poolLumaMean, this);
+        lp_var_t<float> lumaVariance = lp_var_t<float>(sid.objectId, poolLumaVariance, this);
+        lp_var_t<float> saturatedRatio = lp_var_t<float>(sid.objectId, poolSaturatedRatio, this);
+        lp_var_t<float> blackRatio = lp_var_t<float>(sid.objectId, poolBlackRatio, this);
+        lp_var_t<float> sharpness = lp_var_t<float>(sid.objectId, poolSharpness, this);
+        lp_vec_t<uint32_t, LUMA_HISTOGRAM_BINS> lumaHistogram =
+            lp_vec_t<uint32_t, LUMA_HISTOGRAM_BINS>(sid.objectId, poolLumaHistogram, this);
+        lp_var_t<int32_t> exposure = lp_var_t<int32_t>(sid.objectId, poolExposure, this);
+        lp_var_t<int32_t> gain = lp_var_t<int32_t>(sid.objectId, poolGain, this);
+    };
+
+}  // namespace webcam
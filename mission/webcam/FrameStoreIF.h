@@ -0,0 +1,65 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <fsfw/returnvalues/returnvalue.h>
+
+#include <cstdint>
+
+#include "WebcamDefinitions.h"
+
+namespace webcam {
+
+    /*
+     * Handle to a dequeued capture buffer, used like a store_address_t. The generation
+     * is bumped every time the buffer is handed out again, so stale handles are rejected
+     * instead of pointing at a newer frame.
+     */
+    union FrameLease {
+        static constexpr uint32_t INVALID = 0xffffffff;
+
+        FrameLease() : raw(INVALID) {}
+        explicit FrameLease(uint32_t raw) : raw(raw) {}
+        FrameLease(uint8_t deviceIndex, uint8_t bufferIndex, uint16_t generation)
+            : deviceIndex(deviceIndex), bufferIndex(bufferIndex), generation(generation) {}
+
+        [[nodiscard]] bool isValid() const { return raw != INVALID; }
+
+        struct {
+            uint8_t deviceIndex;
+            uint8_t bufferIndex;
+            uint16_t generation;
+        };
+        uint32_t raw;
+    };
+
+    /*
+     * Reference counted access to frames which are still sitting in the capture buffers.
+     * Every holder of a lease owns one reference. The buffer goes back to the driver when
+     * the last reference is released, no frame data is copied on the way.
+     */
+    class FrameStoreIF {
+    public:
+        virtual ~FrameStoreIF() = default;
+
+        virtual ReturnValue_t getFrame(FrameLease lease, const uint8_t **data,
+                                       FrameDescriptor *descriptor) = 0;
+        // Fails if the lease was already released by all of its holders
+        virtual ReturnValue_t addReference(FrameLease lease) = 0;
+        virtual ReturnValue_t releaseFrame(FrameLease lease) = 0;
+    };
+
+}  // namespace webcam
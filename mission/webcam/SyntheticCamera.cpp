@@ -0,0 +1,596 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#include "SyntheticCamera.h"
+
+#include <linux/videodev2.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iterator>
+
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#include "mission/imaging/JpegEncoder.h"
+#include "mission/imaging/MjpegPassthrough.h"
+
+namespace webcam {
+    namespace {
+        constexpr int32_t EXPOSURE_MIN = 1;
+        constexpr int32_t EXPOSURE_MAX = 10000;
+        constexpr int32_t GAIN_MAX = 255;
+
+        // 75 % colour bars as Y, U, V
+        constexpr uint8_t BARS[8][3] = {{180, 128, 128}, {162, 44, 142}, {131, 156, 44},
+                                        {112, 72, 58},   {84, 184, 198}, {65, 100, 212},
+                                        {35, 212, 114},  {16, 128, 128}};
+
+        uint64_t monotonicNs() {
+            timespec now{};
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            return static_cast<uint64_t>(now.tv_sec) * 1000000000ULL +
+                   static_cast<uint64_t>(now.tv_nsec);
+        }
+
+        int fail(int error) {
+            errno = error;
+            return -1;
+        }
+
+        bool parsePattern(const std::string &name, SyntheticCamera::Pattern &pattern) {
+            if (name == "bars") {
+                pattern = SyntheticCamera::Pattern::bars;
+            } else if (name == "gradient") {
+                pattern = SyntheticCamera::Pattern::gradient;
+            } else if (name == "noise") {
+                pattern = SyntheticCamera::Pattern::noise;
+            } else if (name == "counter") {
+                pattern = SyntheticCamera::Pattern::counter;
+            } else {
+                return false;
+            }
+            return true;
+        }
+    }  // namespace
+
+    std::atomic<SyntheticCamera *> SyntheticCamera::registry[MAX_FD] = {};
+
+    bool SyntheticCamera::isSyntheticPath(const std::string &path) {
+        return path.compare(0, std::strlen(SCHEME), SCHEME) == 0;
+    }
+
+    bool SyntheticCamera::parse(const std::string &path, Config &config) {
+        if (!isSyntheticPath(path)) {
+            return false;
+        }
+        const std::string spec = path.substr(std::strlen(SCHEME));
+        const size_t querySeparator = spec.find('?');
+        const std::string mode = spec.substr(0, querySeparator);
+        const size_t formatSeparator = mode.find('/');
+        if (formatSeparator == std::string::npos) {
+            return false;
+        }
+
+        Config parsed;
+        char trailing = 0;
+        if (std::sscanf(mode.substr(0, formatSeparator).c_str(), "%ux%u@%lf%c", &parsed.width,
+                        &parsed.height, &parsed.frameRate, &trailing) != 3) {
+            return false;
+        }
+        // YUYV carries two pixels per macropixel, the JPEG encoder wants even widths too
+        if (parsed.width == 0 || parsed.height == 0 || parsed.width % 2 != 0 ||
+            !(parsed.frameRate > 0.0)) {
+            return false;
+        }
+        const std::string format = mode.substr(formatSeparator + 1);
+        if (format == "yuyv") {
+            parsed.pixelFormat = V4L2_PIX_FMT_YUYV;
+        } else if (format == "mjpeg") {
+            parsed.pixelFormat = V4L2_PIX_FMT_MJPEG;
+        } else {
+            return false;
+        }
+
+        if (querySeparator != std::string::npos) {
+            size_t start = querySeparator + 1;
+            while (start <= spec.size()) {
+                const size_t end = std::min(spec.find('&', start), spec.size());
+                const std::string option = spec.substr(start, end - start);
+                const size_t equals = option.find('=');
+                if (equals == std::string::npos) {
+                    return false;
+                }
+                const std::string key = option.substr(0, equals);
+                const std::string value = option.substr(equals + 1);
+                if (key == "pattern") {
+                    if (!parsePattern(value, parsed.pattern)) {
+                        return false;
+                    }
+                } else if (key == "replay" && !value.empty()) {
+                    parsed.replayPath = value;
+                } else {
+                    return false;
+                }
+                start = end + 1;
+            }
+        }
+        config = parsed;
+        return true;
+    }
+
+    std::unique_ptr<SyntheticCamera> SyntheticCamera::open(const std::string &path) {
+        Config config;
+        if (!parse(path, config)) {
+            sif::printError("SyntheticCamera: Invalid source %s\n", path.c_str());
+            return nullptr;
+        }
+        const int fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (fd < 0 || fd >= static_cast<int>(MAX_FD)) {
+            sif::printError("SyntheticCamera: timerfd_create failed: %s\n",
+                            fd < 0 ? std::strerror(errno) : "descriptor out of range");
+            if (fd >= 0) {
+                close(fd);
+            }
+            return nullptr;
+        }
+        std::unique_ptr<SyntheticCamera> camera(new SyntheticCamera(config, fd));
+        if (!camera->loadFrames()) {
+            return nullptr;
+        }
+        registry[fd] = camera.get();
+        return camera;
+    }
+
+    SyntheticCamera *SyntheticCamera::fromFd(int fd) {
+        if (fd < 0 || fd >= static_cast<int>(MAX_FD)) {
+            return nullptr;
+        }
+        return registry[fd].load(std::memory_order_acquire);
+    }
+
+    SyntheticCamera::SyntheticCamera(const Config &config, int timerFd)
+        : config(config),
+          timerFd(timerFd),
+          frameSize(static_cast<size_t>(config.width) * config.height * 2) {}
+
+    SyntheticCamera::~SyntheticCamera() {
+        if (fromFd(timerFd) == this) {
+            registry[timerFd] = nullptr;
+        }
+        close(timerFd);
+    }
+
+    bool SyntheticCamera::loadFrames() {
+        if (!config.replayPath.empty()) {
+            return loadReplay();
+        }
+        renderPattern();
+        if (config.pixelFormat != V4L2_PIX_FMT_MJPEG) {
+            return true;
+        }
+        imaging::JpegEncoder encoder;
+        std::vector<uint8_t> scrolled(frameSize);
+        for (size_t index = 0; index < MJPEG_PATTERN_FRAMES; index++) {
+            const auto scrollPixels =
+                static_cast<uint32_t>(index * config.width / MJPEG_PATTERN_FRAMES) & ~1U;
+            copyScrolled(scrolled.data(), scrollPixels);
+            if (!encoder.encodeYuyv(scrolled.data(), config.width, config.height,
+                                    imaging::JpegEncoder::DEFAULT_QUALITY)) {
+                sif::printError("SyntheticCamera: Encoding the pattern failed: %s\n",
+                                encoder.lastError());
+                return false;
+            }
+            frames.emplace_back(encoder.data(), encoder.data() + encoder.size());
+        }
+        return true;
+    }
+
+    bool SyntheticCamera::loadReplay() {
+        std::ifstream file(config.replayPath, std::ios::binary);
+        const std::vector<uint8_t> content((std::istreambuf_iterator<char>(file)),
+                                           std::istreambuf_iterator<char>());
+        if (!file.good() && !file.eof()) {
+            sif::printError("SyntheticCamera: Reading %s failed\n", config.replayPath.c_str());
+            return false;
+        }
+        if (config.pixelFormat == V4L2_PIX_FMT_YUYV) {
+            for (size_t offset = 0; offset + frameSize <= content.size(); offset += frameSize) {
+                frames.emplace_back(content.begin() + offset, content.begin() + offset + frameSize);
+            }
+        } else {
+            // Split at every SOI, whatever lies between EOI and the next SOI is dropped
+            const uint8_t soi[] = {0xff, 0xd8, 0xff};
+            auto start = std::search(content.begin(), content.end(), std::begin(soi), std::end(soi));
+            while (start != content.end()) {
+                const auto next = std::search(start + 2, content.end(), std::begin(soi), std::end(soi));
+                imaging::MjpegFrameInfo info;
+                const size_t available = static_cast<size_t>(next - start);
+                if (imaging::inspectMjpeg(&*start, available, info) == imaging::MjpegCheck::ok) {
+                    frames.emplace_back(start, start + static_cast<std::ptrdiff_t>(info.length));
+                    frameSize = std::max(frameSize, info.length);
+                }
+                start = next;
+            }
+        }
+        if (frames.empty()) {
+            sif::printError("SyntheticCamera: %s holds no complete %ux%u frame\n",
+                            config.replayPath.c_str(), config.width, config.height);
+            return false;
+        }
+        return true;
+    }
+
+    void SyntheticCamera::renderPattern() {
+        pattern.resize(frameSize);
+        const uint32_t width = config.width;
+        const uint32_t height = config.height;
+        uint32_t noise = 0x12345678;
+        for (uint32_t y = 0; y < height; y++) {
+            uint8_t *row = pattern.data() + static_cast<size_t>(y) * width * 2;
+            for (uint32_t x = 0; x < width; x += 2) {
+                uint8_t *macropixel = row + x * 2;
+                switch (config.pattern) {
+                    case Pattern::bars: {
+                        const uint8_t *bar = BARS[x * 8 / width];
+                        macropixel[0] = bar[0];
+                        macropixel[1] = bar[1];
+                        macropixel[2] = bar[0];
+                        macropixel[3] = bar[2];
+                        break;
+                    }
+                    case Pattern::noise:
+                        // xorshift32, the same frame on every run
+                        for (int byte = 0; byte < 4; byte++) {
+                            noise ^= noise << 13;
+                            noise ^= noise >> 17;
+                            noise ^= noise << 5;
+                            macropixel[byte] = static_cast<uint8_t>(noise);
+                        }
+                        break;
+                    default: {
+                        // Diagonal ramp over the full luma range
+                        const uint64_t span = static_cast<uint64_t>(width) + height;
+                        macropixel[0] = static_cast<uint8_t>((x + y) * 255 / span);
+                        macropixel[1] = 128;
+                        macropixel[2] = static_cast<uint8_t>((x + 1 + y) * 255 / span);
+                        macropixel[3] = 128;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    void SyntheticCamera::copyScrolled(uint8_t *destination, uint32_t scrollPixels) const {
+        const size_t rowBytes = static_cast<size_t>(config.width) * 2;
+        const size_t head = static_cast<size_t>(scrollPixels % config.width) * 2;
+        for (uint32_t y = 0; y < config.height; y++) {
+            const uint8_t *source = pattern.data() + y * rowBytes;
+            uint8_t *target = destination + y * rowBytes;
+            std::memcpy(target, source + head, rowBytes - head);
+            std::memcpy(target + rowBytes - head, source, head);
+        }
+    }
+
+    size_t SyntheticCamera::renderFrame(uint8_t *destination, uint32_t frameSequence) const {
+        if (!frames.empty()) {
+            const std::vector<uint8_t> &frame = frames[frameSequence % frames.size()];
+            std::memcpy(destination, frame.data(), frame.size());
+            return frame.size();
+        }
+        if (config.pattern == Pattern::counter) {
+            std::memcpy(destination, pattern.data(), frameSize);
+            // Big endian sequence in the luma bytes of the first two macropixels
+            destination[0] = static_cast<uint8_t>(frameSequence >> 24);
+            destination[2] = static_cast<uint8_t>(frameSequence >> 16);
+            destination[4] = static_cast<uint8_t>(frameSequence >> 8);
+            destination[6] = static_cast<uint8_t>(frameSequence);
+            return frameSize;
+        }
+        const uint64_t scroll = static_cast<uint64_t>(frameSequence) * SCROLL_PIXELS_PER_FRAME;
+        copyScrolled(destination, static_cast<uint32_t>(scroll % config.width) & ~1U);
+        return frameSize;
+    }
+
+    uint8_t *SyntheticCamera::getBuffer(uint32_t index) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index >= buffers.size() || buffers[index].memory.empty()) {
+            return nullptr;
+        }
+        return buffers[index].memory.data();
+    }
+
+    void SyntheticCamera::armTimer() {
+        periodNs = static_cast<uint64_t>(std::llround(1e9 / config.frameRate));
+        if (periodNs == 0) {
+            periodNs = 1;
+        }
+        itimerspec timer{};
+        if (streaming) {
+            timer.it_interval.tv_sec = static_cast<time_t>(periodNs / 1000000000ULL);
+            timer.it_interval.tv_nsec = static_cast<long>(periodNs % 1000000000ULL);
+            timer.it_value = timer.it_interval;
+        }
+        streamStartNs = monotonicNs();
+        ticks = 0;
+        (void)timerfd_settime(timerFd, 0, &timer, nullptr);
+    }
+
+    int SyntheticCamera::ioctl(unsigned long request, void *arg) {
+        if (arg == nullptr) {
+            return fail(EFAULT);
+        }
+        switch (request) {
+            case VIDIOC_G_FMT:
+            case VIDIOC_S_FMT:
+            case VIDIOC_TRY_FMT: {
+                // The mode is fixed by the path, like a driver which adjusts every request
+                auto *format = static_cast<v4l2_format *>(arg);
+                if (format->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+                    return fail(EINVAL);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                v4l2_pix_format &pix = format->fmt.pix;
+                pix = {};
+                pix.width = config.width;
+                pix.height = config.height;
+                pix.pixelformat = config.pixelFormat;
+                pix.field = V4L2_FIELD_NONE;
+                pix.bytesperline = config.pixelFormat == V4L2_PIX_FMT_YUYV ? config.width * 2 : 0;
+                pix.sizeimage = static_cast<uint32_t>(frameSize);
+                pix.colorspace = config.pixelFormat == V4L2_PIX_FMT_YUYV ? V4L2_COLORSPACE_SRGB
+                                                                         : V4L2_COLORSPACE_JPEG;
+                return 0;
+            }
+            case VIDIOC_REQBUFS: {
+                auto *requestBuffers = static_cast<v4l2_requestbuffers *>(arg);
+                if (requestBuffers->type != V4L2_BUF_TYPE_VIDEO_CAPTURE ||
+                    (requestBuffers->memory != V4L2_MEMORY_MMAP &&
+                     requestBuffers->memory != V4L2_MEMORY_USERPTR)) {
+                    return fail(EINVAL);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                if (streaming) {
+                    return fail(EBUSY);
+                }
+                queue.clear();
+                buffers.clear();
+                memory = requestBuffers->memory;
+                if (requestBuffers->count == 0) {
+                    return 0;
+                }
+                requestBuffers->count =
+                    std::clamp<uint32_t>(requestBuffers->count, 2, VIDEO_MAX_FRAME);
+                buffers.resize(requestBuffers->count);
+                for (Buffer &buffer : buffers) {
+                    buffer.length = frameSize;
+                    if (memory == V4L2_MEMORY_MMAP) {
+                        buffer.memory.resize(frameSize);
+                    }
+                }
+                return 0;
+            }
+            case VIDIOC_QUERYBUF: {
+                auto *buffer = static_cast<v4l2_buffer *>(arg);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (buffer->index >= buffers.size()) {
+                    return fail(EINVAL);
+                }
+                buffer->length = static_cast<uint32_t>(frameSize);
+                buffer->m.offset = static_cast<uint32_t>(buffer->index * frameSize);
+                buffer->flags = buffers[buffer->index].queued ? V4L2_BUF_FLAG_QUEUED : 0;
+                return 0;
+            }
+            case VIDIOC_QBUF: {
+                auto *buffer = static_cast<v4l2_buffer *>(arg);
+                std::lock_guard<std::mutex> lock(mutex);
+                if (buffer->index >= buffers.size() || buffer->memory != memory ||
+                    buffers[buffer->index].queued) {
+                    return fail(EINVAL);
+                }
+                Buffer &slot = buffers[buffer->index];
+                if (memory == V4L2_MEMORY_USERPTR) {
+                    if (buffer->m.userptr == 0 || buffer->length < frameSize) {
+                        return fail(EINVAL);
+                    }
+                    slot.userPointer = reinterpret_cast<uint8_t *>(buffer->m.userptr);
+                }
+                slot.queued = true;
+                queue.push_back(buffer->index);
+                return 0;
+            }
+            case VIDIOC_DQBUF:
+                return dequeue(arg);
+            case VIDIOC_STREAMON:
+            case VIDIOC_STREAMOFF: {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (request == VIDIOC_STREAMON) {
+                    if (buffers.empty()) {
+                        return fail(EINVAL);
+                    }
+                    sequence = 0;
+                } else {
+                    // All buffers go back to the application, as with a driver
+                    for (Buffer &buffer : buffers) {
+                        buffer.queued = false;
+                    }
+                    queue.clear();
+                }
+                streaming = request == VIDIOC_STREAMON;
+                armTimer();
+                return 0;
+            }
+            case VIDIOC_S_PARM:
+            case VIDIOC_G_PARM: {
+                auto *parameters = static_cast<v4l2_streamparm *>(arg);
+                if (parameters->type != V4L2_BUF_TYPE_VIDEO_CAPTURE) {
+                    return fail(EINVAL);
+                }
+                std::lock_guard<std::mutex> lock(mutex);
+                v4l2_fract &timePerFrame = parameters->parm.capture.timeperframe;
+                if (request == VIDIOC_S_PARM && timePerFrame.numerator != 0 &&
+                    timePerFrame.denominator != 0) {
+                    // Any rate, there is no sensor to limit it
+                    config.frameRate =
+                        static_cast<double>(timePerFrame.denominator) / timePerFrame.numerator;
+                    if (streaming) {
+                        armTimer();
+                    }
+                }
+                parameters->parm.capture = {};
+                parameters->parm.capture.capability = V4L2_CAP_TIMEPERFRAME;
+                timePerFrame.numerator = 1000;
+                timePerFrame.denominator =
+                    static_cast<uint32_t>(std::llround(config.frameRate * 1000.0));
+                return 0;
+            }
+            case VIDIOC_QUERYCTRL: {
+                auto *query = static_cast<v4l2_queryctrl *>(arg);
+                const uint32_t id = query->id;
+                *query = {};
+                query->id = id;
+                switch (id) {
+                    case V4L2_CID_EXPOSURE_ABSOLUTE:
+                        query->type = V4L2_CTRL_TYPE_INTEGER;
+                        query->minimum = EXPOSURE_MIN;
+                        query->maximum = EXPOSURE_MAX;
+                        query->default_value = 100;
+                        break;
+                    case V4L2_CID_GAIN:
+                        query->type = V4L2_CTRL_TYPE_INTEGER;
+                        query->maximum = GAIN_MAX;
+                        break;
+                    case V4L2_CID_EXPOSURE_AUTO:
+                        query->type = V4L2_CTRL_TYPE_MENU;
+                        query->maximum = V4L2_EXPOSURE_APERTURE_PRIORITY;
+                        query->default_value = V4L2_EXPOSURE_APERTURE_PRIORITY;
+                        break;
+                    case V4L2_CID_AUTOGAIN:
+                        query->type = V4L2_CTRL_TYPE_BOOLEAN;
+                        query->maximum = 1;
+                        query->default_value = 1;
+                        break;
+                    default:
+                        return fail(EINVAL);
+                }
+                query->step = 1;
+                std::snprintf(reinterpret_cast<char *>(query->name), sizeof(query->name),
+                              "Synthetic 0x%08x", id);
+                return 0;
+            }
+            case VIDIOC_G_CTRL:
+            case VIDIOC_S_CTRL: {
+                // Stored only, the frames do not change with exposure or gain
+                auto *control = static_cast<v4l2_control *>(arg);
+                std::lock_guard<std::mutex> lock(mutex);
+                int32_t *value = nullptr;
+                int32_t minimum = 0;
+                int32_t maximum = 1;
+                switch (control->id) {
+                    case V4L2_CID_EXPOSURE_ABSOLUTE:
+                        value = &exposure;
+                        minimum = EXPOSURE_MIN;
+                        maximum = EXPOSURE_MAX;
+                        break;
+                    case V4L2_CID_GAIN:
+                        value = &gain;
+                        maximum = GAIN_MAX;
+                        break;
+                    case V4L2_CID_EXPOSURE_AUTO:
+                        value = &autoExposure;
+                        maximum = V4L2_EXPOSURE_APERTURE_PRIORITY;
+                        break;
+                    case V4L2_CID_AUTOGAIN:
+                        value = &autoGain;
+                        break;
+                    default:
+                        return fail(EINVAL);
+                }
+                if (request == VIDIOC_S_CTRL) {
+                    *value = std::clamp(control->value, minimum, maximum);
+                }
+                control->value = *value;
+                return 0;
+            }
+            default:
+                return fail(ENOTTY);
+        }
+    }
+
+    int SyntheticCamera::dequeue(void *arg) {
+        auto *buffer = static_cast<v4l2_buffer *>(arg);
+        uint64_t expirations = 0;
+        if (read(timerFd, &expirations, sizeof(expirations)) != sizeof(expirations) ||
+            expirations == 0) {
+            return fail(EAGAIN);
+        }
+
+        uint32_t index = 0;
+        uint32_t frameSequence = 0;
+        uint64_t timestampNs = 0;
+        uint8_t *destination = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!streaming) {
+                return fail(EINVAL);
+            }
+            ticks += expirations;
+            // Frames due while the capture thread was late are lost
+            sequence += static_cast<uint32_t>(expirations - 1);
+            if (queue.empty()) {
+                sequence++;
+                return fail(EAGAIN);
+            }
+            index = queue.front();
+            queue.pop_front();
+            Buffer &slot = buffers[index];
+            slot.queued = false;
+            destination = memory == V4L2_MEMORY_MMAP ? slot.memory.data() : slot.userPointer;
+            frameSequence = sequence++;
+            // Exposure time of the frame is its timer expiration, not the dequeue
+            timestampNs = streamStartNs + ticks * periodNs;
+        }
+
+        // The buffer is ours until the next QBUF, render without blocking the consumers
+        const size_t bytesUsed = renderFrame(destination, frameSequence);
+
+        const uint32_t memoryType = buffer->memory;
+        *buffer = {};
+        buffer->type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer->memory = memoryType;
+        buffer->index = index;
+        buffer->bytesused = static_cast<uint32_t>(bytesUsed);
+        buffer->length = static_cast<uint32_t>(frameSize);
+        buffer->field = V4L2_FIELD_NONE;
+        buffer->flags = V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC | V4L2_BUF_FLAG_DONE;
+        buffer->sequence = frameSequence;
+        buffer->timestamp.tv_sec = static_cast<time_t>(timestampNs / 1000000000ULL);
+        buffer->timestamp.tv_usec = static_cast<suseconds_t>((timestampNs % 1000000000ULL) / 1000);
+        if (memoryType == V4L2_MEMORY_USERPTR) {
+            buffer->m.userptr = reinterpret_cast<unsigned long>(destination);
+        } else {
+            buffer->m.offset = static_cast<uint32_t>(index * frameSize);
+        }
+        return 0;
+    }
+
+}  // namespace webcam
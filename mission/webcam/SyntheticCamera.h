@@ -0,0 +1,125 @@
+/**************************************************************
+*  Project      : FSFWWebcamDemo
+ *  Modul        : SW Development for Spacecraft
+ *
+ *  Autor        : Noel Ernsting Luz
+ *  Co-Autor     : GPT-5 (KI-unterstützt)
+ *  Erstellt am  : 2026-10-17
+ *  Version      : 1.0
+ *
+ *  Hinweise     :
+ *   - Teile des Codes wurden von GPT-5 generiert und
+ *     von einem Menschen überprüft, angepasst und erweitert.
+ *
+ **************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace webcam {
+
+    /*
+     * Camera without hardware for load tests, selected with a cookie device path
+     *
+     *   synthetic://<width>x<height>@<fps>/<yuyv|mjpeg>[?pattern=<name>][&replay=<file>]
+     *
+     * e.g. synthetic://1920x1080@120/yuyv?pattern=noise. The ComIF drives it through the
+     * same V4L2 calls as a real device, so frames go through the same buffer ring, leases
+     * and handler/service/TM chain. A timerfd stands in for the device fd and becomes
+     * readable at the frame rate. Frames due while no buffer is queued are dropped and
+     * show up as sequence gaps, as with a driver.
+     *
+     * Patterns are deterministic: bars, gradient and noise scroll by a fixed step per frame.
+     * counter is a static gradient with the frame sequence in the first four luma bytes
+     * (YUYV only). A replay file is loaded at open and cycled. For YUYV it holds raw frames
+     * of width * height * 2 bytes, for MJPEG concatenated JPEG images. MJPEG patterns are
+     * encoded once at open, MJPEG_PATTERN_FRAMES scroll positions.
+     */
+    class SyntheticCamera {
+    public:
+        static constexpr const char *SCHEME = "synthetic://";
+        static constexpr size_t MJPEG_PATTERN_FRAMES = 8;
+
+        enum class Pattern : uint8_t { bars, gradient, noise, counter };
+
+        struct Config {
+            uint32_t width = 0;
+            uint32_t height = 0;
+            double frameRate = 0.0;
+            uint32_t pixelFormat = 0;  // V4L2 FourCC, YUYV or MJPEG
+            Pattern pattern = Pattern::bars;
+            std::string replayPath;
+        };
+
+        static bool isSyntheticPath(const std::string &path);
+        // False if the path is malformed, e.g. odd width or an unknown format or pattern
+        static bool parse(const std::string &path, Config &config);
+        // nullptr if the path is invalid or the replay file can not be used
+        static std::unique_ptr<SyntheticCamera> open(const std::string &path);
+        // Camera behind an fd returned by getFd(), nullptr for every other fd
+        static SyntheticCamera *fromFd(int fd);
+
+        ~SyntheticCamera();
+        SyntheticCamera(const SyntheticCamera &) = delete;
+        SyntheticCamera &operator=(const SyntheticCamera &) = delete;
+
+        [[nodiscard]] int getFd() const { return timerFd; }
+        // The V4L2 ioctls used by the ComIF, returns -1 and sets errno like a driver
+        int ioctl(unsigned long request, void *arg);
+        // Memory of an MMAP buffer, nullptr if there is none
+        [[nodiscard]] uint8_t *getBuffer(uint32_t index);
+
+    private:
+        static constexpr size_t MAX_FD = 1024;
+        static constexpr uint32_t SCROLL_PIXELS_PER_FRAME = 8;
+
+        struct Buffer {
+            std::vector<uint8_t> memory;  // MMAP only
+            uint8_t *userPointer = nullptr;
+            size_t length = 0;
+            bool queued = false;
+        };
+
+        SyntheticCamera(const Config &config, int timerFd);
+        bool loadFrames();
+        bool loadReplay();
+        void renderPattern();
+        // The pattern moved left by scrollPixels, wrapping around per row
+        void copyScrolled(uint8_t *destination, uint32_t scrollPixels) const;
+        size_t renderFrame(uint8_t *destination, uint32_t frameSequence) const;
+        int dequeue(void *arg);
+        void armTimer();
+
+        Config config;
+        int timerFd;
+        size_t frameSize;
+        // Base image of the YUYV patterns, or the encoded/replayed frames that get cycled
+        std::vector<uint8_t> pattern;
+        std::vector<std::vector<uint8_t>> frames;
+
+        std::mutex mutex;
+        uint32_t memory = 0;  // v4l2_memory of the requested buffers
+        std::vector<Buffer> buffers;
+        std::deque<uint32_t> queue;
+        bool streaming = false;
+        uint64_t periodNs = 0;
+        uint64_t streamStartNs = 0;
+        uint64_t ticks = 0;  // timer expirations since STREAMON
+        uint32_t sequence = 0;
+        int32_t exposure = 100;
+        int32_t gain = 0;
+        int32_t autoExposure = 3;  // V4L2_EXPOSURE_APERTURE_PRIORITY
+        int32_t autoGain = 1;
+
+        static std::atomic<SyntheticCamera *> registry[MAX_FD];
+    };
+
+}  // namespace webcam
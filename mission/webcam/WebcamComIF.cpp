@@ -15,31 +15,943 @@
 
 #include "WebcamComIF.h"
 
+#include <fcntl.h>
+#include <linux/videodev2.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 #include <fsfw/returnvalues/returnvalue.h>
+#include <fsfw/serviceinterface/ServiceInterface.h>
+
+#include "SyntheticCamera.h"
+#include "WebcamCookie.h"
+#include "WebcamDefinitions.h"
+#include "mission/imaging/MjpegPassthrough.h"
+#include "mission/timing/LatencyHistogram.h"
+
+namespace {
+    // Events the capture thread handles per wakeup: the device and the control eventfd
+    constexpr int CAPTURE_MAX_EVENTS = 2;
+
+    int xioctl(int fd, unsigned long request, void *arg) {
+        // Synthetic sources emulate the driver behind their timerfd
+        if (webcam::SyntheticCamera *camera = webcam::SyntheticCamera::fromFd(fd)) {
+            return camera->ioctl(request, arg);
+        }
+        int result;
+        do {
+            result = ioctl(fd, request, arg);
+        } while (result < 0 && errno == EINTR);
+        return result;
+    }
+
+    bool isJpegFormat(uint32_t pixelFormat) {
+        return pixelFormat == V4L2_PIX_FMT_MJPEG || pixelFormat == V4L2_PIX_FMT_JPEG;
+    }
+
+    // False if the control does not exist or is currently disabled
+    bool queryControl(int fd, uint32_t id, v4l2_queryctrl &query) {
+        query = {};
+        query.id = id;
+        return xioctl(fd, VIDIOC_QUERYCTRL, &query) == 0 &&
+               (query.flags & V4L2_CTRL_FLAG_DISABLED) == 0;
+    }
+
+    bool setControl(int fd, uint32_t id, int32_t value) {
+        v4l2_control control{};
+        control.id = id;
+        control.value = value;
+        return xioctl(fd, VIDIOC_S_CTRL, &control) == 0;
+    }
+
+    bool getControl(int fd, uint32_t id, int32_t &value) {
+        v4l2_control control{};
+        control.id = id;
+        if (xioctl(fd, VIDIOC_G_CTRL, &control) < 0) {
+            return false;
+        }
+        value = control.value;
+        return true;
+    }
+
+    // Clamped to the range and rounded to the step of the control
+    int32_t fitToControl(const v4l2_queryctrl &query, int32_t value) {
+        if (value < query.minimum) {
+            value = query.minimum;
+        }
+        if (value > query.maximum) {
+            value = query.maximum;
+        }
+        if (query.step > 1) {
+            value = query.minimum + (value - query.minimum) / query.step * query.step;
+        }
+        return value;
+    }
+
+    // Lease word of a buffer slot: generation in the upper, reference count in the lower half
+    constexpr uint32_t LEASE_REFERENCE_MASK = 0xffff;
+
+    constexpr uint32_t packLease(uint16_t generation, uint16_t references) {
+        return static_cast<uint32_t>(generation) << 16 | references;
+    }
+
+    constexpr uint16_t leaseGeneration(uint32_t word) { return static_cast<uint16_t>(word >> 16); }
+
+    constexpr uint16_t leaseReferences(uint32_t word) {
+        return static_cast<uint16_t>(word & LEASE_REFERENCE_MASK);
+    }
+}
+
+struct WebcamComIF::BufferSlot {
+    void *start = nullptr;
+    size_t length = 0;
+    // Lease bookkeeping, a slot with references > 0 is owned by the consumers. Generation and
+    // count share one word, so a stale lease can never count on a reused buffer.
+    std::atomic<uint32_t> lease{0};
+    v4l2_buffer buffer{};
+    webcam::FrameDescriptor descriptor{};
+};
+
+struct WebcamComIF::CaptureDevice {
+    CaptureDevice(WebcamCookie *cookie, uint8_t index) : cookie(cookie), index(index) {}
+
+    WebcamCookie *cookie;
+    uint8_t index;
+    int fd = -1;
+    std::unique_ptr<webcam::SyntheticCamera> synthetic;  // owns fd for synthetic:// paths
+    v4l2_format format{};
+    v4l2_memory memory = V4L2_MEMORY_MMAP;
+    uint8_t *ownedPool = nullptr;  // USERPTR pool allocated by the ComIF itself
+    std::vector<BufferSlot> buffers;
+    // Guards fd and the ring between the teardown and the lease calls of other threads. A
+    // stopped device keeps its buffers mapped (retiring) until the last lease came back.
+    std::mutex bufferMutex;
+    bool retiring = false;
+    // Generations continue across restarts, leases of the previous ring stay invalid
+    uint16_t generationBase = 0;
+    std::thread captureThread;
+    std::atomic<bool> running{false};
+    int controlFd = -1;  // eventfd, wakes the capture thread to stop without a poll timeout
+    tasks::ThreadPolicy policy;
+
+    // Newest dequeued frame, owned by the capture thread until a snapshot picks it up
+    std::mutex frameMutex;
+    bool frameAvailable = false;
+    v4l2_buffer latestFrame{};
+    uint64_t latestDequeueTimeUs = 0;
+    imaging::MjpegFrameInfo latestJpeg{};
+    uint32_t droppedFrames = 0;
+    uint32_t invalidFrames = 0;
+
+    // Reply state, only touched from the handler side
+    bool snapshotPending = false;
+    bool replyPending = false;
+    std::vector<uint8_t> replyBuffer;
+};
 
 WebcamComIF::WebcamComIF(object_id_t objectId) : SystemObject(objectId) {}
 
-ReturnValue_t WebcamComIF::initializeInterface(CookieIF *) { return returnvalue::OK; }
+WebcamComIF::~WebcamComIF() {
+    for (auto &entry : devices) {
+        stopCapture(*entry.second);
+        if (entry.second->retiring) {
+            sif::printWarning("WebcamComIF: Buffers of %s still leased on shutdown\n",
+                              entry.first.c_str());
+            (void)closeDevice(*entry.second, true);
+        }
+    }
+}
+
+void WebcamComIF::setCapturePolicy(const tasks::ThreadPolicy &policy) { capturePolicy = policy; }
 
-ReturnValue_t WebcamComIF::sendMessage(CookieIF *, const uint8_t *, size_t) {
+ReturnValue_t WebcamComIF::initializeInterface(CookieIF *cookie) {
+    auto *webcamCookie = dynamic_cast<WebcamCookie *>(cookie);
+    if (webcamCookie == nullptr) {
+        sif::printError("WebcamComIF::initializeInterface: Invalid cookie\n");
+        return DeviceCommunicationIF::INVALID_COOKIE_TYPE;
+    }
+    // The device itself is only opened on commandStartCapture, during the handler startup
+    const std::string &devicePath = webcamCookie->getDevicePath();
+    if (devices.find(devicePath) == devices.end()) {
+        if (deviceTable.size() > UINT8_MAX) {
+            return returnvalue::FAILED;
+        }
+        auto device = std::make_unique<CaptureDevice>(webcamCookie,
+                                                      static_cast<uint8_t>(deviceTable.size()));
+        deviceTable.push_back(device.get());
+        devices.emplace(devicePath, std::move(device));
+    }
     return returnvalue::OK;
 }
 
+ReturnValue_t WebcamComIF::sendMessage(CookieIF *cookie, const uint8_t *sendData, size_t sendLen) {
+    CaptureDevice *device = findDevice(cookie);
+    if (device == nullptr) {
+        return DeviceCommunicationIF::INVALID_COOKIE_TYPE;
+    }
+    if (sendData == nullptr || sendLen == 0) {
+        return returnvalue::OK;
+    }
+
+    const uint32_t commandId = sendData[0];
+    const uint8_t *payload = sendData + 1;
+    const size_t payloadLen = sendLen - 1;
+    double frameRate = 0.0;
+    webcam::ExposureSetting exposure{};
+    webcam::ExposureControls exposureControls{};
+    ReturnValue_t result = returnvalue::OK;
+
+    switch (static_cast<webcam::CommandId>(commandId)) {
+        case webcam::CommandId::commandStartCapture:
+            result = startCapture(*device);
+            setReply(*device, commandId, result, nullptr, 0);
+            return returnvalue::OK;
+        case webcam::CommandId::commandStopCapture:
+            stopCapture(*device);
+            setReply(*device, commandId, returnvalue::OK, nullptr, 0);
+            return returnvalue::OK;
+        case webcam::CommandId::commandTakeSnapshot:
+            if (!device->running) {
+                setReply(*device, commandId, DeviceCommunicationIF::NOT_ACTIVE, nullptr, 0);
+                return returnvalue::OK;
+            }
+            // Reply is built in readReceivedMessage() as soon as a frame is available
+            device->snapshotPending = true;
+            return returnvalue::OK;
+        case webcam::CommandId::commandStartStream:
+        case webcam::CommandId::commandBurst:
+            // Streaming is driven by the handler, the ring only has to be running
+            setReply(*device, commandId,
+                     !device->running ? DeviceCommunicationIF::NOT_ACTIVE : returnvalue::OK, nullptr,
+                     0);
+            return returnvalue::OK;
+        case webcam::CommandId::commandStopStream:
+            setReply(*device, commandId, returnvalue::OK, nullptr, 0);
+            return returnvalue::OK;
+        case webcam::CommandId::commandSetFrameRate:
+            if (payloadLen < sizeof(double)) {
+                return returnvalue::FAILED;
+            }
+            std::memcpy(&frameRate, payload, sizeof(double));
+            result = setFrameRate(*device, frameRate);
+            if (result == returnvalue::OK) {
+                result = getFrameRate(*device, frameRate);
+            }
+            setReply(*device, commandId, result, reinterpret_cast<const uint8_t *>(&frameRate),
+                     sizeof(frameRate));
+            return returnvalue::OK;
+        case webcam::CommandId::commandGetFrameRate:
+            result = getFrameRate(*device, frameRate);
+            setReply(*device, commandId, result, reinterpret_cast<const uint8_t *>(&frameRate),
+                     sizeof(frameRate));
+            return returnvalue::OK;
+        case webcam::CommandId::commandGetExposure:
+            result = getExposure(*device, exposureControls);
+            setReply(*device, commandId, result,
+                     reinterpret_cast<const uint8_t *>(&exposureControls), sizeof(exposureControls));
+            return returnvalue::OK;
+        case webcam::CommandId::commandSetExposure:
+            if (payloadLen < sizeof(exposure)) {
+                return returnvalue::FAILED;
+            }
+            std::memcpy(&exposure, payload, sizeof(exposure));
+            result = setExposure(*device, exposure, exposureControls);
+            setReply(*device, commandId, result,
+                     reinterpret_cast<const uint8_t *>(&exposureControls), sizeof(exposureControls));
+            return returnvalue::OK;
+        default:
+            sif::printWarning("WebcamComIF::sendMessage: Unknown command 0x%02x\n",
+                              static_cast<unsigned int>(commandId));
+            return returnvalue::FAILED;
+    }
+}
+
 ReturnValue_t WebcamComIF::getSendSuccess(CookieIF *) { return returnvalue::OK; }
 
 ReturnValue_t WebcamComIF::requestReceiveMessage(CookieIF *, size_t) {
     return returnvalue::OK;
 }
 
-ReturnValue_t WebcamComIF::readReceivedMessage(CookieIF *, uint8_t **buffer,
+ReturnValue_t WebcamComIF::readReceivedMessage(CookieIF *cookie, uint8_t **buffer,
                                                     size_t *size) {
-    if (buffer != nullptr) {
-        *buffer = nullptr;
+    if (buffer == nullptr || size == nullptr) {
+        return DeviceCommunicationIF::NULLPOINTER;
+    }
+    *buffer = nullptr;
+    *size = 0;
+    CaptureDevice *device = findDevice(cookie);
+    if (device == nullptr) {
+        return DeviceCommunicationIF::INVALID_COOKIE_TYPE;
+    }
+    if (device->retiring) {
+        (void)closeDevice(*device);
+    }
+    if (!device->replyPending && device->snapshotPending) {
+        // No frame yet: report nothing, the handler keeps waiting for the reply
+        if (!buildSnapshotReply(*device)) {
+            return returnvalue::OK;
+        }
+    }
+    if (device->replyPending) {
+        device->replyPending = false;
+        *buffer = device->replyBuffer.data();
+        *size = device->replyBuffer.size();
+    }
+    return returnvalue::OK;
+}
+
+void WebcamComIF::cancelSnapshot(CookieIF *cookie) {
+    CaptureDevice *device = findDevice(cookie);
+    if (device == nullptr) {
+        return;
+    }
+    device->snapshotPending = false;
+    if (!device->replyPending ||
+        device->replyBuffer.size() < sizeof(webcam::ReplyHeader) + sizeof(webcam::FrameDescriptor)) {
+        return;
+    }
+    webcam::ReplyHeader header;
+    std::memcpy(&header, device->replyBuffer.data(), sizeof(header));
+    if (header.commandId != static_cast<uint32_t>(webcam::CommandId::commandTakeSnapshot) ||
+        header.result != returnvalue::OK) {
+        return;
+    }
+    // Nobody would release the reference of the reply receiver otherwise
+    webcam::FrameDescriptor descriptor;
+    std::memcpy(&descriptor, device->replyBuffer.data() + sizeof(header), sizeof(descriptor));
+    device->replyPending = false;
+    (void)releaseFrame(webcam::FrameLease(descriptor.lease));
+}
+
+WebcamComIF::CaptureDevice *WebcamComIF::findDevice(CookieIF *cookie) {
+    auto *webcamCookie = dynamic_cast<WebcamCookie *>(cookie);
+    if (webcamCookie == nullptr) {
+        return nullptr;
+    }
+    auto iter = devices.find(webcamCookie->getDevicePath());
+    if (iter == devices.end()) {
+        return nullptr;
+    }
+    return iter->second.get();
+}
+
+ReturnValue_t WebcamComIF::startCapture(CaptureDevice &device) {
+    if (device.retiring && !closeDevice(device)) {
+        sif::printWarning("WebcamComIF: Buffers of %s still leased, not restarting yet\n",
+                          device.cookie->getDevicePath().c_str());
+        return returnvalue::FAILED;
+    }
+    if (device.fd >= 0) {
+        return returnvalue::OK;
+    }
+    const WebcamCookie &cookie = *device.cookie;
+    const char *path = cookie.getDevicePath().c_str();
+
+    if (webcam::SyntheticCamera::isSyntheticPath(cookie.getDevicePath())) {
+        device.synthetic = webcam::SyntheticCamera::open(cookie.getDevicePath());
+        if (device.synthetic == nullptr) {
+            return returnvalue::FAILED;
+        }
+        device.fd = device.synthetic->getFd();
+    } else {
+        // Non-blocking, the capture thread polls and must never hang in DQBUF on shutdown
+        device.fd = open(path, O_RDWR | O_NONBLOCK);
+    }
+    if (device.fd < 0) {
+        sif::printError("WebcamComIF: Opening %s failed: %s\n", path, std::strerror(errno));
+        return returnvalue::FAILED;
+    }
+
+    device.format = {};
+    device.format.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(device.fd, VIDIOC_G_FMT, &device.format) < 0) {
+        sif::printError("WebcamComIF: VIDIOC_G_FMT failed: %s\n", std::strerror(errno));
+        stopCapture(device);
+        return returnvalue::FAILED;
+    }
+    device.format.fmt.pix.width = cookie.getWidth();
+    device.format.fmt.pix.height = cookie.getHeight();
+    if (cookie.getPixelFormat() != 0) {
+        device.format.fmt.pix.pixelformat = cookie.getPixelFormat();
+    }
+    // The driver is allowed to adjust the format, the adjusted one is written back
+    if (xioctl(device.fd, VIDIOC_S_FMT, &device.format) < 0) {
+        sif::printWarning("WebcamComIF: VIDIOC_S_FMT failed, keeping driver format\n");
+        (void)xioctl(device.fd, VIDIOC_G_FMT, &device.format);
+    }
+
+    // A synthetic source starts with the rate of its path
+    if (cookie.getInitialFrameRate() > 0.0 && device.synthetic == nullptr) {
+        (void)setFrameRate(device, cookie.getInitialFrameRate());
+    }
+
+    // Buffer ring is requested and mapped exactly once per startup
+    if (requestBuffers(device) != returnvalue::OK) {
+        stopCapture(device);
+        return returnvalue::FAILED;
+    }
+
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(device.fd, VIDIOC_STREAMON, &type) < 0) {
+        sif::printError("WebcamComIF: VIDIOC_STREAMON failed: %s\n", std::strerror(errno));
+        stopCapture(device);
+        return returnvalue::FAILED;
+    }
+
+    // Reserve the reply buffer once so the snapshot path does not allocate
+    device.replyBuffer.reserve(sizeof(webcam::ReplyHeader) + sizeof(webcam::FrameDescriptor));
+    device.frameAvailable = false;
+    device.droppedFrames = 0;
+    device.invalidFrames = 0;
+    device.controlFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (device.controlFd < 0) {
+        sif::printError("WebcamComIF: eventfd failed: %s\n", std::strerror(errno));
+        stopCapture(device);
+        return returnvalue::FAILED;
+    }
+    device.running = true;
+    device.policy = capturePolicy;
+    device.captureThread = std::thread(&WebcamComIF::captureLoop, &device);
+
+    sif::printInfo("WebcamComIF: Streaming %s with %ux%u, %zu %s buffers\n", path,
+                   device.format.fmt.pix.width, device.format.fmt.pix.height,
+                   device.buffers.size(),
+                   device.memory == V4L2_MEMORY_MMAP
+                       ? memoryModeToString(webcam::MemoryMode::mmap)
+                       : memoryModeToString(cookie.getMemoryMode()));
+    return returnvalue::OK;
+}
+
+ReturnValue_t WebcamComIF::requestBuffers(CaptureDevice &device) {
+    const WebcamCookie &cookie = *device.cookie;
+    const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    // USERPTR buffers are page aligned slices of one pool
+    const size_t frameSize =
+        (device.format.fmt.pix.sizeimage + pageSize - 1) / pageSize * pageSize;
+    uint8_t *pool = cookie.getUserPointerPool();
+    uint32_t bufferCount = cookie.getBufferCount();
+
+    switch (cookie.getMemoryMode()) {
+        case webcam::MemoryMode::mmap:
+            device.memory = V4L2_MEMORY_MMAP;
+            break;
+        case webcam::MemoryMode::userPointer:
+            device.memory = V4L2_MEMORY_USERPTR;
+            if (pool != nullptr) {
+                // The ring is sized by the memory we got, not by the configured count
+                if (reinterpret_cast<uintptr_t>(pool) % pageSize != 0) {
+                    sif::printError("WebcamComIF: USERPTR pool is not page aligned\n");
+                    return returnvalue::FAILED;
+                }
+                bufferCount = static_cast<uint32_t>(cookie.getUserPointerPoolSize() / frameSize);
+                if (bufferCount < 2) {
+                    // The slice was reserved for the requested size, the driver negotiated a
+                    // larger one. Driver buffers of the real size keep the camera running.
+                    sif::printWarning("WebcamComIF: Pool slice of %s holds %u frames of %u bytes, "
+                                      "using MMAP buffers\n",
+                                      cookie.getDevicePath().c_str(), bufferCount,
+                                      device.format.fmt.pix.sizeimage);
+                    device.memory = V4L2_MEMORY_MMAP;
+                    pool = nullptr;
+                    bufferCount = cookie.getBufferCount();
+                } else if (bufferCount > VIDEO_MAX_FRAME) {
+                    bufferCount = VIDEO_MAX_FRAME;
+                }
+            }
+            break;
+        case webcam::MemoryMode::dmaBuf:
+            device.memory = V4L2_MEMORY_DMABUF;
+            bufferCount = static_cast<uint32_t>(cookie.getDmaBufFds().size());
+            break;
+    }
+
+    v4l2_requestbuffers request{};
+    request.count = bufferCount;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = device.memory;
+    int requestResult = xioctl(device.fd, VIDIOC_REQBUFS, &request);
+    if (requestResult < 0 && device.memory == V4L2_MEMORY_USERPTR) {
+        // Not every driver can capture into user memory, a camera sharing the frame pool then
+        // falls back to its own driver buffers instead of staying dark
+        sif::printWarning("WebcamComIF: %s does not support USERPTR, using MMAP buffers\n",
+                          cookie.getDevicePath().c_str());
+        device.memory = V4L2_MEMORY_MMAP;
+        pool = nullptr;
+        bufferCount = cookie.getBufferCount();
+        request = v4l2_requestbuffers{};
+        request.count = bufferCount;
+        request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        request.memory = device.memory;
+        requestResult = xioctl(device.fd, VIDIOC_REQBUFS, &request);
+    }
+    if (requestResult < 0 || request.count < 2) {
+        sif::printError("WebcamComIF: VIDIOC_REQBUFS failed for %s buffers\n",
+                        memoryModeToString(cookie.getMemoryMode()));
+        return returnvalue::FAILED;
     }
-    if (size != nullptr) {
-        *size = 0;
+    // The driver may raise the count to its minimum, which external memory can not back
+    if (request.count > bufferCount &&
+        (pool != nullptr || device.memory == V4L2_MEMORY_DMABUF)) {
+        sif::printError("WebcamComIF: Driver needs %u buffers, memory only holds %u\n",
+                        request.count, bufferCount);
+        return returnvalue::FAILED;
+    }
+
+    if (device.memory == V4L2_MEMORY_USERPTR && pool == nullptr) {
+        void *ownedPool = nullptr;
+        if (posix_memalign(&ownedPool, pageSize, request.count * frameSize) != 0) {
+            sif::printError("WebcamComIF: Allocating the USERPTR pool failed\n");
+            return returnvalue::FAILED;
+        }
+        device.ownedPool = static_cast<uint8_t *>(ownedPool);
+        pool = device.ownedPool;
+    }
+
+    device.buffers = std::vector<BufferSlot>(request.count);
+    for (uint32_t index = 0; index < request.count; index++) {
+        BufferSlot &slot = device.buffers[index];
+        v4l2_buffer buffer{};
+        buffer.type = request.type;
+        buffer.memory = request.memory;
+        buffer.index = index;
+        if (xioctl(device.fd, VIDIOC_QUERYBUF, &buffer) < 0) {
+            sif::printError("WebcamComIF: VIDIOC_QUERYBUF failed\n");
+            return returnvalue::FAILED;
+        }
+        switch (device.memory) {
+            case V4L2_MEMORY_USERPTR:
+                slot.start = pool + index * frameSize;
+                slot.length = frameSize;
+                buffer.m.userptr = reinterpret_cast<unsigned long>(slot.start);
+                buffer.length = static_cast<uint32_t>(frameSize);
+                break;
+            case V4L2_MEMORY_DMABUF: {
+                const int dmaBufFd = cookie.getDmaBufFds()[index];
+                // Mapped for CPU access only, the device writes into the imported buffer
+                slot.length = device.format.fmt.pix.sizeimage;
+                slot.start = mmap(nullptr, slot.length, PROT_READ, MAP_SHARED, dmaBufFd, 0);
+                buffer.m.fd = dmaBufFd;
+                break;
+            }
+            default:
+                slot.length = buffer.length;
+                if (device.synthetic != nullptr) {
+                    uint8_t *memory = device.synthetic->getBuffer(index);
+                    slot.start = memory != nullptr ? memory : MAP_FAILED;
+                    break;
+                }
+                slot.start = mmap(nullptr, buffer.length, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                  device.fd, buffer.m.offset);
+                break;
+        }
+        if (slot.start == MAP_FAILED) {
+            slot.start = nullptr;
+            sif::printError("WebcamComIF: mmap failed: %s\n", std::strerror(errno));
+            return returnvalue::FAILED;
+        }
+        slot.lease = packLease(device.generationBase, 0);
+        if (xioctl(device.fd, VIDIOC_QBUF, &buffer) < 0) {
+            sif::printError("WebcamComIF: VIDIOC_QBUF failed: %s\n", std::strerror(errno));
+            return returnvalue::FAILED;
+        }
+    }
+    return returnvalue::OK;
+}
+
+void WebcamComIF::releaseBuffers(CaptureDevice &device) {
+    for (auto &buffer : device.buffers) {
+        const uint32_t word = buffer.lease.load();
+        // invalidates all outstanding leases
+        const uint16_t generation = leaseGeneration(word) + 1;
+        buffer.lease = packLease(generation, 0);
+        if (static_cast<int16_t>(generation - device.generationBase) > 0) {
+            device.generationBase = generation;
+        }
+        if (device.memory != V4L2_MEMORY_USERPTR && device.synthetic == nullptr &&
+            buffer.start != nullptr && buffer.length > 0) {
+            munmap(buffer.start, buffer.length);
+        }
+    }
+    device.buffers.clear();
+    v4l2_requestbuffers request{};
+    request.count = 0;
+    request.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    request.memory = device.memory;
+    (void)xioctl(device.fd, VIDIOC_REQBUFS, &request);
+    std::free(device.ownedPool);
+    device.ownedPool = nullptr;
+}
+
+void WebcamComIF::stopCapture(CaptureDevice &device) {
+    device.running = false;
+    if (device.controlFd >= 0) {
+        const uint64_t increment = 1;
+        (void)write(device.controlFd, &increment, sizeof(increment));
+    }
+    if (device.captureThread.joinable()) {
+        device.captureThread.join();
+    }
+    if (device.controlFd >= 0) {
+        close(device.controlFd);
+        device.controlFd = -1;
+    }
+    if (device.fd < 0) {
+        return;
+    }
+    v4l2_buf_type type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    (void)xioctl(device.fd, VIDIOC_STREAMOFF, &type);
+    device.frameAvailable = false;
+    device.snapshotPending = false;
+    {
+        std::lock_guard<std::mutex> lock(device.bufferMutex);
+        device.retiring = true;
+    }
+    // Leased frames are still read by their holders, the unmap waits for the last release
+    if (!closeDevice(device)) {
+        sif::printInfo("WebcamComIF: %s stopped, closed once all frames are released\n",
+                       device.cookie->getDevicePath().c_str());
+    }
+}
+
+bool WebcamComIF::closeDevice(CaptureDevice &device, bool force) {
+    std::lock_guard<std::mutex> lock(device.bufferMutex);
+    if (!force) {
+        for (const auto &buffer : device.buffers) {
+            if (leaseReferences(buffer.lease.load(std::memory_order_acquire)) > 0) {
+                return false;
+            }
+        }
+    }
+    releaseBuffers(device);
+    if (device.synthetic != nullptr) {
+        device.synthetic.reset();
+    } else {
+        close(device.fd);
+    }
+    device.fd = -1;
+    device.retiring = false;
+    return true;
+}
+
+void WebcamComIF::captureLoop(CaptureDevice *device) {
+    if (!device->policy.isDefault()) {
+        device->policy.applyToCurrentThread(device->cookie->getDevicePath().c_str());
+    }
+    // Sleeps until the driver has a frame or stopCapture() signals the control eventfd
+    const int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd < 0) {
+        sif::printError("WebcamComIF: epoll_create1 failed: %s\n", std::strerror(errno));
+        return;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = device->fd;
+    const bool registered = epoll_ctl(epollFd, EPOLL_CTL_ADD, device->fd, &event) == 0;
+    event.data.fd = device->controlFd;
+    if (!registered || epoll_ctl(epollFd, EPOLL_CTL_ADD, device->controlFd, &event) != 0) {
+        sif::printError("WebcamComIF: epoll_ctl failed: %s\n", std::strerror(errno));
+        close(epollFd);
+        return;
+    }
+
+    epoll_event events[CAPTURE_MAX_EVENTS];
+    while (device->running) {
+        const int count = epoll_wait(epollFd, events, CAPTURE_MAX_EVENTS, -1);
+        bool frameReady = false;
+        for (int index = 0; index < count; index++) {
+            frameReady = frameReady || events[index].data.fd == device->fd;
+        }
+        if (!frameReady) {
+            // Interrupted or the control eventfd, which is only signalled on stop
+            continue;
+        }
+        v4l2_buffer buffer{};
+        buffer.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+        buffer.memory = device->memory;
+        if (xioctl(device->fd, VIDIOC_DQBUF, &buffer) < 0) {
+            if (errno != EAGAIN) {
+                sif::printWarning("WebcamComIF: VIDIOC_DQBUF failed: %s\n", std::strerror(errno));
+            }
+            continue;
+        }
+        const uint64_t dequeueTimeUs = timing::monotonicTimeUs();
+
+        // MJPEG is passed through undecoded, only the markers are checked. A cut off frame
+        // goes straight back to the driver and the previous one stays the newest.
+        imaging::MjpegFrameInfo jpeg{};
+        if (isJpegFormat(device->format.fmt.pix.pixelformat)) {
+            const imaging::MjpegCheck check =
+                (buffer.flags & V4L2_BUF_FLAG_ERROR) != 0
+                    ? imaging::MjpegCheck::noEndOfImage
+                    : imaging::inspectMjpeg(
+                          static_cast<const uint8_t *>(device->buffers[buffer.index].start),
+                          buffer.bytesused, jpeg);
+            if (check != imaging::MjpegCheck::ok) {
+                (void)xioctl(device->fd, VIDIOC_QBUF, &buffer);
+                std::lock_guard<std::mutex> lock(device->frameMutex);
+                if (device->invalidFrames++ == 0) {
+                    sif::printWarning("WebcamComIF: Dropping corrupt MJPEG frame %u (%s)\n",
+                                      buffer.sequence, imaging::mjpegCheckToString(check));
+                }
+                continue;
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(device->frameMutex);
+        if (device->frameAvailable) {
+            // Nobody picked up the previous frame, give it back to the driver
+            (void)xioctl(device->fd, VIDIOC_QBUF, &device->latestFrame);
+            device->droppedFrames++;
+        }
+        device->latestFrame = buffer;
+        device->latestDequeueTimeUs = dequeueTimeUs;
+        device->latestJpeg = jpeg;
+        device->frameAvailable = true;
+        device->cookie->signalFrame();
+    }
+    close(epollFd);
+}
+
+ReturnValue_t WebcamComIF::setFrameRate(CaptureDevice &device, double frameRate) {
+    if (device.fd < 0 || frameRate <= 0.0) {
+        return returnvalue::FAILED;
+    }
+    v4l2_streamparm parm{};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    parm.parm.capture.timeperframe.numerator = 1000;
+    parm.parm.capture.timeperframe.denominator = static_cast<uint32_t>(frameRate * 1000.0);
+    if (xioctl(device.fd, VIDIOC_S_PARM, &parm) < 0) {
+        sif::printWarning("WebcamComIF: VIDIOC_S_PARM failed: %s\n", std::strerror(errno));
+        return returnvalue::FAILED;
+    }
+    return returnvalue::OK;
+}
+
+ReturnValue_t WebcamComIF::getFrameRate(CaptureDevice &device, double &frameRate) {
+    if (device.fd < 0) {
+        return returnvalue::FAILED;
+    }
+    v4l2_streamparm parm{};
+    parm.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    if (xioctl(device.fd, VIDIOC_G_PARM, &parm) < 0) {
+        return returnvalue::FAILED;
+    }
+    const auto &timePerFrame = parm.parm.capture.timeperframe;
+    if (timePerFrame.numerator == 0 || timePerFrame.denominator == 0) {
+        return returnvalue::FAILED;
+    }
+    frameRate = static_cast<double>(timePerFrame.denominator) / timePerFrame.numerator;
+    return returnvalue::OK;
+}
+
+ReturnValue_t WebcamComIF::getExposure(CaptureDevice &device,
+                                       webcam::ExposureControls &controls) {
+    controls = {};
+    v4l2_queryctrl query{};
+    if (device.fd < 0 || !queryControl(device.fd, V4L2_CID_EXPOSURE_ABSOLUTE, query) ||
+        !getControl(device.fd, V4L2_CID_EXPOSURE_ABSOLUTE, controls.current.exposure)) {
+        return returnvalue::FAILED;
+    }
+    controls.exposureMin = query.minimum;
+    controls.exposureMax = query.maximum;
+    // Gain is optional, many UVC cameras only expose the exposure time
+    if (queryControl(device.fd, V4L2_CID_GAIN, query) &&
+        getControl(device.fd, V4L2_CID_GAIN, controls.current.gain)) {
+        controls.gainMin = query.minimum;
+        controls.gainMax = query.maximum;
     }
     return returnvalue::OK;
 }
 
-#include "WebcamComIF.h"
\ No newline at end of file
+ReturnValue_t WebcamComIF::setExposure(CaptureDevice &device,
+                                       const webcam::ExposureSetting &setting,
+                                       webcam::ExposureControls &controls) {
+    v4l2_queryctrl query{};
+    if (device.fd < 0 || !queryControl(device.fd, V4L2_CID_EXPOSURE_ABSOLUTE, query)) {
+        return returnvalue::FAILED;
+    }
+    // The absolute value is ignored while the camera runs its own auto exposure
+    (void)setControl(device.fd, V4L2_CID_EXPOSURE_AUTO, V4L2_EXPOSURE_MANUAL);
+    if (!setControl(device.fd, V4L2_CID_EXPOSURE_ABSOLUTE, fitToControl(query, setting.exposure))) {
+        sif::printWarning("WebcamComIF: Setting the exposure failed: %s\n", std::strerror(errno));
+        return returnvalue::FAILED;
+    }
+    if (queryControl(device.fd, V4L2_CID_GAIN, query)) {
+        (void)setControl(device.fd, V4L2_CID_AUTOGAIN, 0);
+        (void)setControl(device.fd, V4L2_CID_GAIN, fitToControl(query, setting.gain));
+    }
+    return getExposure(device, controls);
+}
+
+bool WebcamComIF::buildSnapshotReply(CaptureDevice &device) {
+    v4l2_buffer buffer{};
+    uint32_t droppedFrames = 0;
+    uint32_t invalidFrames = 0;
+    uint64_t dequeueTimeUs = 0;
+    imaging::MjpegFrameInfo jpeg{};
+    {
+        std::lock_guard<std::mutex> lock(device.frameMutex);
+        if (!device.frameAvailable) {
+            return false;
+        }
+        buffer = device.latestFrame;
+        droppedFrames = device.droppedFrames;
+        invalidFrames = device.invalidFrames;
+        dequeueTimeUs = device.latestDequeueTimeUs;
+        jpeg = device.latestJpeg;
+        device.frameAvailable = false;
+    }
+
+    // Hand out the buffer itself, it is requeued by the last releaseFrame()
+    BufferSlot &slot = device.buffers[buffer.index];
+    const uint16_t generation = leaseGeneration(slot.lease.load(std::memory_order_relaxed)) + 1;
+    webcam::FrameLease lease(device.index, static_cast<uint8_t>(buffer.index), generation);
+    slot.buffer = buffer;
+    webcam::FrameDescriptor &descriptor = slot.descriptor;
+    descriptor.lease = lease.raw;
+    descriptor.bufferIndex = buffer.index;
+    descriptor.bytesUsed = buffer.bytesused;
+    descriptor.width = device.format.fmt.pix.width;
+    descriptor.height = device.format.fmt.pix.height;
+    descriptor.pixelFormat = device.format.fmt.pix.pixelformat;
+    descriptor.sequence = buffer.sequence;
+    descriptor.droppedFrames = droppedFrames;
+    descriptor.invalidFrames = invalidFrames;
+    descriptor.flags = 0;
+    descriptor.scanOffset = 0;
+    if (isJpegFormat(descriptor.pixelFormat)) {
+        // Trailing padding behind the EOI is not part of the frame
+        descriptor.bytesUsed = static_cast<uint32_t>(jpeg.length);
+        descriptor.scanOffset = static_cast<uint32_t>(jpeg.scanOffset);
+        descriptor.flags = webcam::FRAME_FLAG_JPEG_CHECKED;
+        if (!jpeg.hasHuffmanTables) {
+            descriptor.flags |= webcam::FRAME_FLAG_JPEG_NO_HUFFMAN;
+        }
+    }
+    // Only comparable with our own timestamps if the driver stamps with CLOCK_MONOTONIC
+    const bool monotonic = (buffer.flags & V4L2_BUF_FLAG_TIMESTAMP_MASK) ==
+                           V4L2_BUF_FLAG_TIMESTAMP_MONOTONIC;
+    descriptor.timestampUs =
+        monotonic ? static_cast<uint64_t>(buffer.timestamp.tv_sec) * 1000000ULL +
+                        static_cast<uint64_t>(buffer.timestamp.tv_usec)
+                  : 0;
+    descriptor.dequeueTimeUs = dequeueTimeUs;
+    descriptor.processTimeUs = 0;
+    descriptor.storeTimeUs = 0;
+    // Published together with the reference of the reply receiver, the descriptor is complete
+    // before any holder of the new lease can see it
+    slot.lease.store(packLease(generation, 1), std::memory_order_release);
+
+    setReply(device, static_cast<uint32_t>(webcam::CommandId::commandTakeSnapshot),
+             returnvalue::OK, reinterpret_cast<const uint8_t *>(&descriptor), sizeof(descriptor));
+    device.snapshotPending = false;
+    return true;
+}
+
+ReturnValue_t WebcamComIF::getFrame(webcam::FrameLease lease, const uint8_t **data,
+                                    webcam::FrameDescriptor *descriptor) {
+    CaptureDevice *device = findLeaseDevice(lease);
+    if (device == nullptr) {
+        return returnvalue::FAILED;
+    }
+    std::lock_guard<std::mutex> lock(device->bufferMutex);
+    BufferSlot *slot = findSlot(*device, lease);
+    if (slot == nullptr) {
+        return returnvalue::FAILED;
+    }
+    const uint32_t word = slot->lease.load(std::memory_order_acquire);
+    if (leaseGeneration(word) != lease.generation || leaseReferences(word) == 0) {
+        return returnvalue::FAILED;
+    }
+    if (data != nullptr) {
+        *data = static_cast<const uint8_t *>(slot->start);
+    }
+    if (descriptor != nullptr) {
+        *descriptor = slot->descriptor;
+    }
+    return returnvalue::OK;
+}
+
+ReturnValue_t WebcamComIF::addReference(webcam::FrameLease lease) {
+    CaptureDevice *device = findLeaseDevice(lease);
+    if (device == nullptr) {
+        return returnvalue::FAILED;
+    }
+    std::lock_guard<std::mutex> lock(device->bufferMutex);
+    BufferSlot *slot = findSlot(*device, lease);
+    if (slot == nullptr) {
+        return returnvalue::FAILED;
+    }
+    uint32_t word = slot->lease.load(std::memory_order_acquire);
+    do {
+        // Released by all holders, or the slot already carries a newer frame
+        if (leaseGeneration(word) != lease.generation || leaseReferences(word) == 0 ||
+            leaseReferences(word) == LEASE_REFERENCE_MASK) {
+            return returnvalue::FAILED;
+        }
+    } while (!slot->lease.compare_exchange_weak(word, word + 1, std::memory_order_acq_rel));
+    return returnvalue::OK;
+}
+
+ReturnValue_t WebcamComIF::releaseFrame(webcam::FrameLease lease) {
+    CaptureDevice *device = findLeaseDevice(lease);
+    if (device == nullptr) {
+        return returnvalue::FAILED;
+    }
+    std::lock_guard<std::mutex> lock(device->bufferMutex);
+    BufferSlot *slot = findSlot(*device, lease);
+    if (slot == nullptr) {
+        return returnvalue::FAILED;
+    }
+    uint32_t word = slot->lease.load(std::memory_order_acquire);
+    do {
+        if (leaseGeneration(word) != lease.generation || leaseReferences(word) == 0) {
+            return returnvalue::FAILED;
+        }
+    } while (!slot->lease.compare_exchange_weak(word, word - 1, std::memory_order_acq_rel));
+    // A stopped ring is not refilled, the handler closes it once all leases are back
+    if (leaseReferences(word) == 1 && !device->retiring) {
+        (void)xioctl(device->fd, VIDIOC_QBUF, &slot->buffer);
+    }
+    return returnvalue::OK;
+}
+
+WebcamComIF::CaptureDevice *WebcamComIF::findLeaseDevice(webcam::FrameLease lease) {
+    // The table only grows during initializeInterface(), before any lease exists
+    if (!lease.isValid() || lease.deviceIndex >= deviceTable.size()) {
+        return nullptr;
+    }
+    return deviceTable[lease.deviceIndex];
+}
+
+WebcamComIF::BufferSlot *WebcamComIF::findSlot(CaptureDevice &device, webcam::FrameLease lease) {
+    if (device.fd < 0 || lease.bufferIndex >= device.buffers.size()) {
+        return nullptr;
+    }
+    return &device.buffers[lease.bufferIndex];
+}
+
+void WebcamComIF::setReply(CaptureDevice &device, uint32_t commandId, ReturnValue_t result,
+                           const uint8_t *payload, size_t payloadLen) {
+    webcam::ReplyHeader header;
+    header.commandId = commandId;
+    header.result = result;
+    header.payloadLength = static_cast<uint32_t>(payloadLen);
+    device.replyBuffer.resize(sizeof(header) + payloadLen);
+    std::memcpy(device.replyBuffer.data(), &header, sizeof(header));
+    if (payload != nullptr && payloadLen > 0) {
+        std::memcpy(device.replyBuffer.data() + sizeof(header), payload, payloadLen);
+    }
+    device.replyPending = true;
+}
@@ -16,13 +16,31 @@
 #pragma once
 
 #include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <fsfw/devicehandlers/DeviceCommunicationIF.h>
 #include <fsfw/objectmanager/SystemObject.h>
 
-class WebcamComIF : public DeviceCommunicationIF, public SystemObject {
+#include "FrameStoreIF.h"
+#include "WebcamDefinitions.h"
+#include "mission/tasks/ThreadPolicy.h"
+
+class WebcamCookie;
+
+/*
+ * V4L2 capture engine. Each cookie gets a device entry which owns the fd, the MMAP buffer
+ * ring and a capture thread. The capture thread keeps the ring streaming and always holds
+ * on to the newest frame, so a snapshot request only has to pick it up instead of
+ * reopening the device. Snapshot replies only carry a lease to the buffer (FrameStoreIF),
+ * the buffer is requeued once all holders released it.
+ */
+class WebcamComIF : public DeviceCommunicationIF, public webcam::FrameStoreIF, public SystemObject {
 public:
     explicit WebcamComIF(object_id_t objectId);
+    ~WebcamComIF() override;
 
     ReturnValue_t initializeInterface(CookieIF *cookie) override;
     ReturnValue_t sendMessage(CookieIF *cookie, const uint8_t *sendData,
@@ -31,4 +49,50 @@ public:
     ReturnValue_t requestReceiveMessage(CookieIF *cookie, size_t requestLen) override;
     ReturnValue_t readReceivedMessage(CookieIF *cookie, uint8_t **buffer,
                                       size_t *size) override;
+
+    ReturnValue_t getFrame(webcam::FrameLease lease, const uint8_t **data,
+                           webcam::FrameDescriptor *descriptor) override;
+    ReturnValue_t addReference(webcam::FrameLease lease) override;
+    ReturnValue_t releaseFrame(webcam::FrameLease lease) override;
+
+    // The handler gave up waiting for a snapshot reply: no late reply is built, the lease of a
+    // reply which was built but not read yet is released
+    void cancelSnapshot(CookieIF *cookie);
+
+    // Applied by the capture threads started afterwards, e.g. SCHED_FIFO on isolated cores
+    void setCapturePolicy(const tasks::ThreadPolicy &policy);
+
+private:
+    struct CaptureDevice;
+    struct BufferSlot;
+
+    CaptureDevice *findDevice(CookieIF *cookie);
+    ReturnValue_t startCapture(CaptureDevice &device);
+    void stopCapture(CaptureDevice &device);
+    // Closes a stopped device once no lease is left, force skips the check on destruction.
+    // False while frames are still leased.
+    bool closeDevice(CaptureDevice &device, bool force = false);
+    ReturnValue_t requestBuffers(CaptureDevice &device);
+    void releaseBuffers(CaptureDevice &device);
+    static void captureLoop(CaptureDevice *device);
+    ReturnValue_t setFrameRate(CaptureDevice &device, double frameRate);
+    ReturnValue_t getFrameRate(CaptureDevice &device, double &frameRate);
+    // Ranges and current values of V4L2_CID_EXPOSURE_ABSOLUTE / V4L2_CID_GAIN
+    ReturnValue_t getExposure(CaptureDevice &device, webcam::ExposureControls &controls);
+    // Switches the camera to manual exposure, values are clamped to the control ranges
+    ReturnValue_t setExposure(CaptureDevice &device, const webcam::ExposureSetting &setting,
+                              webcam::ExposureControls &controls);
+    bool buildSnapshotReply(CaptureDevice &device);
+    CaptureDevice *findLeaseDevice(webcam::FrameLease lease);
+    // Called with the bufferMutex of the device held. Only resolves the index, the generation
+    // is checked against the lease word of the slot.
+    BufferSlot *findSlot(CaptureDevice &device, webcam::FrameLease lease);
+    void setReply(CaptureDevice &device, uint32_t commandId, ReturnValue_t result,
+                  const uint8_t *payload, size_t payloadLen);
+
+    // keyed by device path
+    std::unordered_map<std::string, std::unique_ptr<CaptureDevice>> devices;
+    // lease device index -> device
+    std::vector<CaptureDevice *> deviceTable;
+    tasks::ThreadPolicy capturePolicy;
 };
\ No newline at end of file
@@ -16,12 +16,72 @@
 
 #include "WebcamCookie.h"
 
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cstdint>
 #include <utility>
 
-WebcamCookie::WebcamCookie(std::string devicePath, double initialFrameRate)
-: SystemObject(webcam::objectIdWebcamCookie),
+WebcamCookie::WebcamCookie(std::string devicePath, double initialFrameRate, uint32_t width,
+                           uint32_t height, uint32_t pixelFormat, uint32_t bufferCount,
+                           object_id_t objectId)
+: SystemObject(objectId),
   devicePath(std::move(devicePath)),
-  initialFrameRate(initialFrameRate) {}
+  initialFrameRate(initialFrameRate),
+  width(width),
+  height(height),
+  pixelFormat(pixelFormat),
+  bufferCount(bufferCount),
+  frameEventFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
+WebcamCookie::~WebcamCookie() {
+    if (frameEventFd >= 0) {
+        close(frameEventFd);
+    }
+}
+
 const std::string &WebcamCookie::getDevicePath() const { return devicePath; }
 
-double WebcamCookie::getInitialFrameRate() const { return initialFrameRate; }
\ No newline at end of file
+double WebcamCookie::getInitialFrameRate() const { return initialFrameRate; }
+
+uint32_t WebcamCookie::getWidth() const { return width; }
+
+uint32_t WebcamCookie::getHeight() const { return height; }
+
+uint32_t WebcamCookie::getPixelFormat() const { return pixelFormat; }
+
+uint32_t WebcamCookie::getBufferCount() const { return bufferCount; }
+
+void WebcamCookie::setUserPointerMode(uint8_t *pool, size_t poolSize) {
+    memoryMode = webcam::MemoryMode::userPointer;
+    userPointerPool = pool;
+    userPointerPoolSize = pool != nullptr ? poolSize : 0;
+}
+
+void WebcamCookie::setDmaBufMode(std::vector<int> fds) {
+    memoryMode = webcam::MemoryMode::dmaBuf;
+    dmaBufFds = std::move(fds);
+}
+
+webcam::MemoryMode WebcamCookie::getMemoryMode() const { return memoryMode; }
+
+uint8_t *WebcamCookie::getUserPointerPool() const { return userPointerPool; }
+
+size_t WebcamCookie::getUserPointerPoolSize() const { return userPointerPoolSize; }
+
+const std::vector<int> &WebcamCookie::getDmaBufFds() const { return dmaBufFds; }
+
+int WebcamCookie::getFrameEventFd() const { return frameEventFd; }
+
+void WebcamCookie::setFrameWakeup(bool enabled) {
+    frameWakeup.store(enabled, std::memory_order_relaxed);
+}
+
+void WebcamCookie::signalFrame() {
+    if (frameEventFd < 0 || !frameWakeup.load(std::memory_order_relaxed)) {
+        return;
+    }
+    const uint64_t increment = 1;
+    // Only fails if the counter is about to overflow, the reader is woken either way
+    (void)write(frameEventFd, &increment, sizeof(increment));
+}
@@ -19,16 +19,55 @@
 #include <fsfw/objectmanager/SystemObject.h>
 #include "WebcamDefinitions.h"
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 
 class WebcamCookie : public CookieIF, public SystemObject {
 public:
-    WebcamCookie(std::string devicePath, double initialFrameRate);
+    // pixelFormat 0 keeps whatever FourCC the driver is currently configured for. Further
+    // cameras need their own object id, see webcam::cookieObjectId().
+    WebcamCookie(std::string devicePath, double initialFrameRate, uint32_t width = 640,
+                 uint32_t height = 480, uint32_t pixelFormat = 0, uint32_t bufferCount = 4,
+                 object_id_t objectId = webcam::objectIdWebcamCookie);
+    ~WebcamCookie() override;
 
     [[nodiscard]] const std::string &getDevicePath() const;
     [[nodiscard]] double getInitialFrameRate() const;
+    [[nodiscard]] uint32_t getWidth() const;
+    [[nodiscard]] uint32_t getHeight() const;
+    [[nodiscard]] uint32_t getPixelFormat() const;
+    [[nodiscard]] uint32_t getBufferCount() const;
+
+    // Capture into memory we control. Without a pool the ComIF allocates one for bufferCount
+    // frames, with a pool the ring is sized to as many frames as fit into it.
+    void setUserPointerMode(uint8_t *pool = nullptr, size_t poolSize = 0);
+    // Capture into imported DMABUFs, one buffer per file descriptor
+    void setDmaBufMode(std::vector<int> dmaBufFds);
+    [[nodiscard]] webcam::MemoryMode getMemoryMode() const;
+    [[nodiscard]] uint8_t *getUserPointerPool() const;
+    [[nodiscard]] size_t getUserPointerPoolSize() const;
+    [[nodiscard]] const std::vector<int> &getDmaBufFds() const;
+
+    // Frame notification for event driven handler tasks: while enabled, the capture thread
+    // signals this eventfd for every dequeued frame. -1 if no eventfd could be created.
+    [[nodiscard]] int getFrameEventFd() const;
+    void setFrameWakeup(bool enabled);
+    void signalFrame();
 
 private:
     std::string devicePath;  // linux device paths. very clever.
     double initialFrameRate; // initial framerate
+    uint32_t width;          // requested resolution, the driver may adjust it
+    uint32_t height;
+    uint32_t pixelFormat;    // requested V4L2 FourCC
+    uint32_t bufferCount;    // size of the capture buffer ring
+    webcam::MemoryMode memoryMode = webcam::MemoryMode::mmap;
+    uint8_t *userPointerPool = nullptr;
+    size_t userPointerPoolSize = 0;
+    std::vector<int> dmaBufFds;
+    int frameEventFd = -1;
+    std::atomic<bool> frameWakeup{false};
 };
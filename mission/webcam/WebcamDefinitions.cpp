@@ -26,6 +26,20 @@ namespace webcam {
                 return "commandSetFrameRate";
             case CommandId::commandGetFrameRate:
                 return "commandGetFrameRate";
+            case CommandId::commandStartStream:
+                return "commandStartStream";
+            case CommandId::commandStopStream:
+                return "commandStopStream";
+            case CommandId::commandBurst:
+                return "commandBurst";
+            case CommandId::commandStartCapture:
+                return "commandStartCapture";
+            case CommandId::commandStopCapture:
+                return "commandStopCapture";
+            case CommandId::commandGetExposure:
+                return "commandGetExposure";
+            case CommandId::commandSetExposure:
+                return "commandSetExposure";
         }
         return "commandUnknown";
     }
@@ -34,8 +48,28 @@ namespace webcam {
         switch (parameter) {
             case ParameterId::parameterFrameRate:
                 return "parameterFrameRate";
+            case ParameterId::parameterJpegQuality:
+                return "parameterJpegQuality";
+            case ParameterId::parameterChangeThreshold:
+                return "parameterChangeThreshold";
+            case ParameterId::parameterAutoExposure:
+                return "parameterAutoExposure";
+            case ParameterId::parameterExposureTarget:
+                return "parameterExposureTarget";
         }
         return "parameterUnknown";
     }
 
+    const char *memoryModeToString(MemoryMode mode) {
+        switch (mode) {
+            case MemoryMode::mmap:
+                return "MMAP";
+            case MemoryMode::userPointer:
+                return "USERPTR";
+            case MemoryMode::dmaBuf:
+                return "DMABUF";
+        }
+        return "unknown";
+    }
+
 }  // namespace webcam
\ No newline at end of file
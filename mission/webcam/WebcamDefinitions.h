@@ -22,6 +22,7 @@
 #include <fsfw/devicehandlers/DeviceHandlerIF.h>
 #include <fsfw/objectmanager/SystemObjectIF.h>
 
+#include <cstddef>
 #include <cstdint>
 
 namespace webcam {
@@ -30,16 +31,105 @@ namespace webcam {
         commandTakeSnapshot = 0x01,
         commandSetFrameRate = 0x02,
         commandGetFrameRate = 0x03,
+        // Streaming: the handler fetches a frame every cycle until stopped or the burst is done
+        commandStartStream = 0x04,
+        commandStopStream = 0x05,
+        commandBurst = 0x06,
+        // Internal transition commands, not reachable via TC
+        commandStartCapture = 0x10,
+        commandStopCapture = 0x11,
+        // Internal commands of the auto exposure loop
+        commandGetExposure = 0x12,
+        commandSetExposure = 0x13,
     };
 
     const char *commandIdToString(CommandId command);
 
     enum class ParameterId : uint8_t {
         parameterFrameRate = 0x01,
+        parameterJpegQuality = 0x02,
+        // Mean luma difference below which streamed frames are dropped, 0 disables the check
+        parameterChangeThreshold = 0x03,
+        // Closed-loop exposure/gain control on the frame statistics, 0 off / 1 on
+        parameterAutoExposure = 0x04,
+        // Mean luma the auto exposure loop converges to
+        parameterExposureTarget = 0x05,
     };
 
     const char *parameterIdToString(ParameterId parameter);
 
+    // Memory type of the capture buffer ring, see the V4L2 streaming I/O modes
+    enum class MemoryMode : uint8_t {
+        mmap = 0,         // driver allocated buffers mapped into our address space
+        userPointer = 1,  // buffers in page aligned memory owned by us
+        dmaBuf = 2,       // imported DMABUF file descriptors
+    };
+
+    const char *memoryModeToString(MemoryMode mode);
+
+    // Command packet as sent by the handler to the WebcamComIF: [commandId][payload...]
+    inline constexpr size_t MAX_COMMAND_SIZE = 16;
+
+    // Every reply of the WebcamComIF starts with this header, followed by payloadLength bytes.
+    struct ReplyHeader {
+        uint32_t commandId = 0;
+        ReturnValue_t result = 0;      // outcome of the operation on the device
+        uint16_t reserved = 0;
+        uint32_t payloadLength = 0;
+    };
+
+    // Payload of a commandTakeSnapshot reply. The frame itself stays in the capture buffer and
+    // is referenced through the lease, see FrameStoreIF.
+    struct FrameDescriptor {
+        uint32_t lease = 0xffffffff;   // raw FrameLease
+        uint32_t bufferIndex = 0;
+        uint32_t bytesUsed = 0;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t pixelFormat = 0;      // V4L2 FourCC
+        uint32_t sequence = 0;
+        uint32_t droppedFrames = 0;    // frames overwritten in the ring since capture start
+        uint32_t invalidFrames = 0;    // corrupt MJPEG frames requeued since capture start
+        uint32_t flags = 0;            // FRAME_FLAG_*
+        uint32_t scanOffset = 0;       // MJPEG: offset of the SOS marker, see MjpegFrameInfo
+        uint32_t camera = 0;           // index of the camera, see handlerObjectId()
+        // Pipeline timestamps, CLOCK_MONOTONIC in microseconds, 0 if not (yet) known
+        uint64_t timestampUs = 0;      // driver timestamp, 0 if the driver uses another clock
+        uint64_t dequeueTimeUs = 0;    // VIDIOC_DQBUF returned
+        uint64_t processTimeUs = 0;    // handler received the frame
+        uint64_t storeTimeUs = 0;      // handed to the snapshot writer
+    };
+
+    // FrameDescriptor::flags
+    // MJPEG frame passed the SOI/EOI check, bytesUsed ends at the EOI marker
+    inline constexpr uint32_t FRAME_FLAG_JPEG_CHECKED = 1U << 0;
+    // MJPEG frame without Huffman tables, imaging::completeMjpeg() adds the standard ones
+    inline constexpr uint32_t FRAME_FLAG_JPEG_NO_HUFFMAN = 1U << 1;
+
+    // Payload of commandSetExposure. Exposure in V4L2_CID_EXPOSURE_ABSOLUTE units (100 us),
+    // gain in the device specific V4L2_CID_GAIN units.
+    struct ExposureSetting {
+        int32_t exposure = 0;
+        int32_t gain = 0;
+    };
+
+    // Reply payload of commandGetExposure and commandSetExposure, values as read back
+    struct ExposureControls {
+        ExposureSetting current{};
+        int32_t exposureMin = 0;
+        int32_t exposureMax = 0;
+        int32_t gainMin = 0;
+        int32_t gainMax = 0;  // equal to gainMin if the device has no gain control
+    };
+
+    // Payload of the commandStopStream reply and of the report at the end of a burst
+    struct StreamStatistics {
+        uint32_t framesDelivered = 0;
+        uint32_t framesDropped = 0;    // gaps in the driver sequence between delivered frames
+        uint32_t ringDrops = 0;        // of those, overwritten because the handler was too slow
+        uint32_t framesUnchanged = 0;  // delivered but not forwarded, see parameterChangeThreshold
+    };
+
     inline constexpr object_id_t objectIdWebcamHandler = static_cast<object_id_t>(0x57000001);
     inline constexpr object_id_t objectIdWebcamCookie = static_cast<object_id_t>(0x57000002);
     inline constexpr object_id_t objectIdWebcamComIF = static_cast<object_id_t>(0x57000003);
@@ -47,6 +137,29 @@ namespace webcam {
     inline constexpr object_id_t objectIdWebcamTcDistributor = static_cast<object_id_t>(0x57000011);
     inline constexpr object_id_t objectIdWebcamTelemetrySink = static_cast<object_id_t>(0x57000012);
     inline constexpr object_id_t objectIdWebcamVerificationSink = static_cast<object_id_t>(0x57000013);
+    inline constexpr object_id_t objectIdTaskTimingService = static_cast<object_id_t>(0x57000014);
+
+    // Every camera has its own cookie, handler and capture thread. Camera 0 keeps the ids above,
+    // camera n is offset by n << 8 so the ids stay clear of the service objects.
+    inline constexpr uint8_t MAX_CAMERAS = 4;
+
+    constexpr object_id_t handlerObjectId(uint8_t camera) {
+        return objectIdWebcamHandler + (static_cast<object_id_t>(camera) << 8);
+    }
+
+    constexpr object_id_t cookieObjectId(uint8_t camera) {
+        return objectIdWebcamCookie + (static_cast<object_id_t>(camera) << 8);
+    }
+
+    // Camera index of a handler object id, MAX_CAMERAS if it is none
+    constexpr uint8_t cameraOfHandler(object_id_t objectId) {
+        for (uint8_t camera = 0; camera < MAX_CAMERAS; camera++) {
+            if (handlerObjectId(camera) == objectId) {
+                return camera;
+            }
+        }
+        return MAX_CAMERAS;
+    }
 
 }  // namespace webcam
 #endif //FSFW_FROM_ZERO_WEBCAMDEFINITIONS_H
@@ -17,18 +17,21 @@
 
 #include <fsfw/devicehandlers/DeviceCommunicationIF.h>
 #include <fsfw/action/ActionMessage.h>
+#include <fsfw/datapool/PoolReadGuard.h>
 #include <fsfw/ipc/CommandMessage.h>
 #include <fsfw/retval.h>
 #include <fsfw/serviceinterface/ServiceInterface.h>
 #include "mission/messaging/MessageTypes.h"
+#include "WebcamComIF.h"
+#include "WebcamCookie.h"
 #include "WebcamDefinitions.h"
+#include <linux/videodev2.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#include <cstdio>
 #include <cstring>
 #include <iomanip>
 
-/*
- * Trivial hacking: remove from cmake.txt to prevent failures!
- */
-
 namespace {
   constexpr uint8_t STREAMING_ENABLED_REPLY_FLAG = 1;
   constexpr uint8_t STREAMING_DISABLED_REPLY_FLAG = 0;
@@ -37,36 +40,127 @@ namespace {
 WebcamDeviceHandler::WebcamDeviceHandler(object_id_t objectId, object_id_t deviceCommunication,
                                          CookieIF *comCookie, FailureIsolationBase *fdirInstance,
                                          size_t cmdQueueSize)
-  // TODO: implement communication object IDs cookie instance and FDIR once handler is scheduled.
     : DeviceHandlerBase(objectId, deviceCommunication, comCookie, fdirInstance, cmdQueueSize),
-      currentFrameRate(0.0), requestedFrameRate(0.0), snapshotRequested(false) {}
+      currentFrameRate(0.0), requestedFrameRate(0.0), snapshotRequested(false),
+      camera(webcam::cameraOfHandler(objectId) < webcam::MAX_CAMERAS
+                 ? webcam::cameraOfHandler(objectId)
+                 : 0),
+      wakeupFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
+WebcamDeviceHandler::~WebcamDeviceHandler() {
+  if (wakeupFd >= 0) {
+    close(wakeupFd);
+  }
+}
+
+void WebcamDeviceHandler::wakeUp() {
+  if (wakeupFd < 0) {
+    return;
+  }
+  const uint64_t increment = 1;
+  (void)write(wakeupFd, &increment, sizeof(increment));
+}
+
+void WebcamDeviceHandler::configureSlotJitter(uint32_t periodMs, const uint32_t *offsetsMs,
+                                              size_t steps) {
+  slotJitter.configure(periodMs, offsetsMs, steps);
+  lastSlotJitterReportUs = timing::monotonicTimeUs();
+}
+
+ReturnValue_t WebcamDeviceHandler::performOperation(uint8_t counter) {
+  if (slotJitter.isConfigured()) {
+    const uint64_t nowUs = timing::monotonicTimeUs();
+    slotJitter.record(counter, nowUs);
+    if (counter == DeviceHandlerIF::PERFORM_OPERATION &&
+        nowUs - lastSlotJitterReportUs >=
+            static_cast<uint64_t>(SLOT_JITTER_REPORT_INTERVAL_MS) * 1000) {
+      lastSlotJitterReportUs = nowUs;
+      reportSlotJitter();
+    }
+  }
+  return DeviceHandlerBase::performOperation(counter);
+}
+
+void WebcamDeviceHandler::reportSlotJitter() {
+  // p99/max in us per communication step
+  char summary[160] = {};
+  size_t length = 0;
+  for (size_t slot = 0; slot < slotJitter.getSlotCount() && length < sizeof(summary); slot++) {
+    const timing::LatencyHistogram::Snapshot snapshot = slotJitter.getJitter(slot).snapshot();
+    const int written = std::snprintf(summary + length, sizeof(summary) - length, "%s%u/%u",
+                                      slot == 0 ? "" : ", ",
+                                      static_cast<unsigned int>(snapshot.percentileUs(99)),
+                                      static_cast<unsigned int>(snapshot.maxUs));
+    if (written < 0) {
+      break;
+    }
+    length += static_cast<size_t>(written);
+  }
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+  sif::info << "[Webcam] Camera " << static_cast<int>(camera)
+            << " slot jitter p99/max us: " << summary << std::endl;
+#else
+  sif::printInfo("[Webcam] Camera %u slot jitter p99/max us: %s\n",
+                 static_cast<unsigned int>(camera), summary);
+#endif
+}
+
+void WebcamDeviceHandler::performOperationHook() {
+  // Frames only matter while one is awaited or the exposure loop meters, otherwise the
+  // task would run a cycle for every frame the camera delivers
+  auto *cookie = dynamic_cast<WebcamCookie *>(comCookie);
+  if (cookie != nullptr) {
+    cookie->setFrameWakeup(streamActive || burstFramesRemaining > 0 || snapshotRequested ||
+                           snapshotInProgress || autoExposure != 0);
+  }
+}
 
 void WebcamDeviceHandler::doStartUp() {
-  // This is called do transition to MODE_ON
-  // TODO: implement calling logic by webcam_test application
-  devicePowered = true;
-  transitionCommandPending = true;
-  setMode(MODE_ON);
+  // Called every cycle while in _MODE_START_UP until the ComIF confirms streaming
+  if (devicePowered) {
+    transitionCommandSent = false;
+    setMode(MODE_ON);
+    return;
+  }
+  if (!transitionCommandSent) {
+    transitionCommandPending = true;
+  }
 }
 
 void WebcamDeviceHandler::doShutDown() {
-  // Release and destroy
-  // TODO: BlackOps everything. Annihilation everywhere!
-  devicePowered = false;
-  transitionCommandPending = true;
-  setMode(MODE_OFF);
+  streamActive = false;
+  burstFramesRemaining = 0;
+  resetExposureControl();
+  // Leases must be given back before the ComIF unmaps the buffers
+  releaseLastFrame();
+  if (!devicePowered) {
+    transitionCommandSent = false;
+    setMode(MODE_OFF);
+    return;
+  }
+  if (!transitionCommandSent) {
+    transitionCommandPending = true;
+  }
 }
 
 uint32_t WebcamDeviceHandler::getTransitionDelayMs(Mode_t, Mode_t) {
-  return 0;
+  return START_UP_TIMEOUT_MS;
 }
 
 ReturnValue_t WebcamDeviceHandler::buildTransitionDeviceCommand(DeviceCommandId_t *deviceCommand) {
-  transitionCommandPending = false;
-  if (deviceCommand != nullptr) {
+  if (deviceCommand == nullptr) {
+    return returnvalue::FAILED;
+  }
+  if (!transitionCommandPending) {
     *deviceCommand = DeviceHandlerIF::NO_COMMAND_ID;
+    return DeviceHandlerBase::NOTHING_TO_SEND;
   }
-  return DeviceHandlerBase::NOTHING_TO_SEND;
+  transitionCommandPending = false;
+  transitionCommandSent = true;
+  const auto command = devicePowered ? webcam::CommandId::commandStopCapture
+                                     : webcam::CommandId::commandStartCapture;
+  *deviceCommand = static_cast<DeviceCommandId_t>(command);
+  return prepareCommandPacket(command);
 }
 
 
@@ -77,82 +171,135 @@ ReturnValue_t WebcamDeviceHandler::buildNormalDeviceCommand(DeviceCommandId_t *d
   if (communicationInterface == nullptr) {
     return returnvalue::FAILED;
   }
-  if (snapshotRequested) {
+  if (snapshotRequested && !snapshotInProgress) {
     snapshotRequested = false;
     snapshotInProgress = true;
     *deviceCommand = static_cast<DeviceCommandId_t>(webcam::CommandId::commandTakeSnapshot);
-    prepareReply(*deviceCommand);
-    return returnvalue::OK;
+    return prepareCommandPacket(webcam::CommandId::commandTakeSnapshot);
   }
-
-  if (frameRateCommandPending) {
-    frameRateCommandPending = false;
-    snapshotInProgress = false;
-    currentFrameRate = requestedFrameRate;
-    *deviceCommand = static_cast<DeviceCommandId_t>(webcam::CommandId::commandSetFrameRate);
-    prepareReply(*deviceCommand);
-    return returnvalue::OK;
+  // Auto exposure: the device state is read once, new settings go out before the next frame
+  if (autoExposure != 0 && !exposureCommandInProgress) {
+    if (!exposureController.isConfigured()) {
+      exposureCommandInProgress = true;
+      *deviceCommand = static_cast<DeviceCommandId_t>(webcam::CommandId::commandGetExposure);
+      return prepareCommandPacket(webcam::CommandId::commandGetExposure);
+    }
+    if (exposureUpdatePending) {
+      exposureUpdatePending = false;
+      exposureCommandInProgress = true;
+      *deviceCommand = static_cast<DeviceCommandId_t>(webcam::CommandId::commandSetExposure);
+      return prepareCommandPacket(webcam::CommandId::commandSetExposure,
+                                  reinterpret_cast<const uint8_t *>(&pendingExposure),
+                                  sizeof(pendingExposure));
+    }
   }
-
-  if (frameRateQueryPending) {
-    frameRateQueryPending = false;
-    snapshotInProgress = false;
-    *deviceCommand = static_cast<DeviceCommandId_t>(webcam::CommandId::commandGetFrameRate);
-    prepareReply(*deviceCommand);
-    return returnvalue::OK;
+  // Streaming: one frame per cycle, the next one is requested when the last reply arrived
+  if ((streamActive || burstFramesRemaining > 0) && !snapshotInProgress) {
+    snapshotInProgress = true;
+    streamFrameInProgress = true;
+    *deviceCommand = static_cast<DeviceCommandId_t>(webcam::CommandId::commandTakeSnapshot);
+    return prepareCommandPacket(webcam::CommandId::commandTakeSnapshot);
+  }
+  // Without a stream the exposure loop meters frames of its own, they are not forwarded
+  const uint64_t nowUs = timing::monotonicTimeUs();
+  if (autoExposure != 0 && exposureController.isConfigured() && !snapshotInProgress &&
+      nowUs - lastMeteringUs >= static_cast<uint64_t>(METERING_INTERVAL_MS) * 1000) {
+    lastMeteringUs = nowUs;
+    snapshotInProgress = true;
+    meteringFrameInProgress = true;
+    *deviceCommand = static_cast<DeviceCommandId_t>(webcam::CommandId::commandTakeSnapshot);
+    return prepareCommandPacket(webcam::CommandId::commandTakeSnapshot);
   }
 
   return DeviceHandlerBase::NOTHING_TO_SEND;
 }
 
 void WebcamDeviceHandler::fillCommandAndReplyMap() {
-  // TODO: Mit konkreten command IDs befüllen
   using webcam::CommandId;
-  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandTakeSnapshot), 0);
-  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandSetFrameRate), 0);
-  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandGetFrameRate), 0);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandTakeSnapshot),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandSetFrameRate),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandGetFrameRate),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandStartStream),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandStopStream),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandBurst),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandStartCapture),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandStopCapture),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandGetExposure),
+                             REPLY_DELAY_CYCLES);
+  insertInCommandAndReplyMap(static_cast<DeviceCommandId_t>(CommandId::commandSetExposure),
+                             REPLY_DELAY_CYCLES);
 }
 
-ReturnValue_t WebcamDeviceHandler::scanForReply(const uint8_t *, size_t,
+ReturnValue_t WebcamDeviceHandler::scanForReply(const uint8_t *data, size_t len,
                                                 DeviceCommandId_t *foundId, size_t *foundLen) {
-  // TODO: Parse incoming telemetry
-  if (replyReady) {
-    if (foundId != nullptr) {
-      *foundId = fabricatedReplyId;
-    }
-    if (foundLen != nullptr) {
-      *foundLen = 0;
-    }
-    if (fabricatedReplyId == static_cast<DeviceCommandId_t>(webcam::CommandId::commandTakeSnapshot)) {
-      snapshotInProgress = false;
-    }
-    replyReady = false;
-    return returnvalue::OK;
+  if (foundId == nullptr || foundLen == nullptr) {
+    return returnvalue::FAILED;
   }
-
-  if (foundId != nullptr) {
-    *foundId = DeviceHandlerIF::NO_COMMAND_ID;
+  *foundId = DeviceHandlerIF::NO_COMMAND_ID;
+  *foundLen = 0;
+  if (data == nullptr || len < sizeof(webcam::ReplyHeader)) {
+    return DeviceCommunicationIF::NO_REPLY_RECEIVED;
   }
-  if (foundLen != nullptr) {
-    *foundLen = 0;
+  webcam::ReplyHeader header;
+  std::memcpy(&header, data, sizeof(header));
+  if (len < sizeof(header) + header.payloadLength) {
+    *foundLen = len;
+    return DeviceHandlerIF::LENGTH_MISSMATCH;
   }
-  return DeviceCommunicationIF::NO_REPLY_RECEIVED;
+  *foundId = header.commandId;
+  *foundLen = sizeof(header) + header.payloadLength;
+  return returnvalue::OK;
 }
 
-ReturnValue_t WebcamDeviceHandler::interpretDeviceReply(DeviceCommandId_t id, const uint8_t *) {
+ReturnValue_t WebcamDeviceHandler::interpretDeviceReply(DeviceCommandId_t id, const uint8_t *packet) {
   using webcam::CommandId;
   auto command = static_cast<CommandId>(id);
+  webcam::ReplyHeader header;
+  std::memcpy(&header, packet, sizeof(header));
+  const uint8_t *payload = packet + sizeof(header);
 
-  switch (command) {
-    case CommandId::commandTakeSnapshot:
+  if (header.result != returnvalue::OK) {
+    if (command == CommandId::commandStartCapture || command == CommandId::commandStopCapture) {
+      // retried with the next transition cycle
+      transitionCommandSent = false;
+    }
+    if (command == CommandId::commandTakeSnapshot) {
       snapshotInProgress = false;
+      streamFrameInProgress = false;
+      meteringFrameInProgress = false;
+    }
+    if (command == CommandId::commandGetExposure || command == CommandId::commandSetExposure) {
+      // No usable exposure control, retrying every cycle would only flood the log
+      autoExposure = 0;
+      resetExposureControl();
+    }
 #if FSFW_CPP_OSTREAM_ENABLED == 1
-      sif::info << "[Webcam] Snapshot request completed." << std::endl;
+    sif::warning << "[Webcam] " << webcam::commandIdToString(command) << " failed with code 0x"
+                 << std::hex << header.result << std::dec << '.' << std::endl;
 #else
-      sif::printInfo("[Webcam] Snapshot request completed.\n");
+    sif::printWarning("[Webcam] %s failed with code 0x%04x.\n", webcam::commandIdToString(command),
+                      static_cast<unsigned int>(header.result));
 #endif
+    return header.result;
+  }
+
+  switch (command) {
+    case CommandId::commandTakeSnapshot:
+      handleSnapshotReply(payload, header.payloadLength);
       break;
     case CommandId::commandSetFrameRate:
+      if (header.payloadLength >= sizeof(double)) {
+        std::memcpy(&currentFrameRate, payload, sizeof(double));
+        exposureController.setFrameRate(currentFrameRate);
+      }
 #if FSFW_CPP_OSTREAM_ENABLED == 1
       sif::info << "[Webcam] Frame rate set to " << std::fixed << std::setprecision(2)
                 << currentFrameRate << " fps." << std::defaultfloat << std::endl;
@@ -161,6 +308,10 @@ ReturnValue_t WebcamDeviceHandler::interpretDeviceReply(DeviceCommandId_t id, co
 #endif
       break;
     case CommandId::commandGetFrameRate:
+      if (header.payloadLength >= sizeof(double)) {
+        std::memcpy(&currentFrameRate, payload, sizeof(double));
+        exposureController.setFrameRate(currentFrameRate);
+      }
 #if FSFW_CPP_OSTREAM_ENABLED == 1
       sif::info << "[Webcam] Current frame rate is " << std::fixed << std::setprecision(2)
                 << currentFrameRate << " fps." << std::defaultfloat << std::endl;
@@ -168,6 +319,27 @@ ReturnValue_t WebcamDeviceHandler::interpretDeviceReply(DeviceCommandId_t id, co
       sif::printInfo("[Webcam] Current frame rate is %.2f fps.\n", currentFrameRate);
 #endif
       break;
+    case CommandId::commandStartStream:
+      startStream(0);
+      break;
+    case CommandId::commandBurst:
+      startStream(requestedBurstFrames);
+      break;
+    case CommandId::commandStopStream:
+      streamActive = false;
+      burstFramesRemaining = 0;
+      reportStreamStatistics(id, true);
+      break;
+    case CommandId::commandGetExposure:
+    case CommandId::commandSetExposure:
+      handleExposureReply(command, payload, header.payloadLength);
+      break;
+    case CommandId::commandStartCapture:
+      devicePowered = true;
+      break;
+    case CommandId::commandStopCapture:
+      devicePowered = false;
+      break;
     default:
 #if FSFW_CPP_OSTREAM_ENABLED == 1
       sif::info << "[Webcam] Reply received for command 0x" << std::hex << id << std::dec << '.'
@@ -178,10 +350,35 @@ ReturnValue_t WebcamDeviceHandler::interpretDeviceReply(DeviceCommandId_t id, co
       break;
   }
 
-  fabricatedReplyId = DeviceHandlerIF::NO_COMMAND_ID;
   return returnvalue::OK;
 }
 
+void WebcamDeviceHandler::missedReply(DeviceCommandId_t id) {
+  using webcam::CommandId;
+  switch (static_cast<CommandId>(id)) {
+    case CommandId::commandTakeSnapshot: {
+      snapshotInProgress = false;
+      streamFrameInProgress = false;
+      meteringFrameInProgress = false;
+      // A reply built after the timeout would be dropped as unrequested with its lease
+      auto *comIF = dynamic_cast<WebcamComIF *>(communicationInterface);
+      if (comIF != nullptr) {
+        comIF->cancelSnapshot(comCookie);
+      }
+      break;
+    }
+    case CommandId::commandGetExposure:
+    case CommandId::commandSetExposure:
+      // Whether the setting was applied is unknown, the controller would wait for it forever.
+      // Reading the device state again restarts the control loop.
+      resetExposureControl();
+      break;
+    default:
+      break;
+  }
+  DeviceHandlerBase::missedReply(id);
+}
+
 ReturnValue_t WebcamDeviceHandler::getParameter(uint8_t domainId, uint8_t parameterId,
                                                 ParameterWrapper *parameterWrapper,
                                                 const ParameterWrapper *newValues,
@@ -231,6 +428,114 @@ ReturnValue_t WebcamDeviceHandler::getParameter(uint8_t domainId, uint8_t parame
     return returnvalue::OK;
   }
 
+  if (parameterId == static_cast<uint8_t>(ParameterId::parameterChangeThreshold)) {
+    if (startAtIndex != 0) {
+      return returnvalue::FAILED;
+    }
+    if (newValues == nullptr) {
+      if (parameterWrapper == nullptr) {
+        return returnvalue::FAILED;
+      }
+      parameterWrapper->set(changeThreshold);
+      return returnvalue::OK;
+    }
+
+    double newThreshold = changeThreshold;
+    ReturnValue_t result = newValues->getElement(&newThreshold);
+    if (result != returnvalue::OK) {
+      return result;
+    }
+    if (newThreshold < 0.0 || newThreshold > 255.0) {
+      return returnvalue::FAILED;
+    }
+    changeThreshold = newThreshold;
+    // Compare the next frame against a fresh reference
+    changeDetector.reset();
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+    sif::info << "[Webcam] Parameter write: change threshold " << changeThreshold << "."
+              << std::endl;
+#else
+    sif::printInfo("[Webcam] Parameter write: change threshold %.2f.\n", changeThreshold);
+#endif
+    return returnvalue::OK;
+  }
+
+  if (parameterId == static_cast<uint8_t>(ParameterId::parameterAutoExposure) ||
+      parameterId == static_cast<uint8_t>(ParameterId::parameterExposureTarget)) {
+    const bool enableParameter =
+        parameterId == static_cast<uint8_t>(ParameterId::parameterAutoExposure);
+    uint8_t &value = enableParameter ? autoExposure : exposureTarget;
+    if (startAtIndex != 0) {
+      return returnvalue::FAILED;
+    }
+    if (newValues == nullptr) {
+      if (parameterWrapper == nullptr) {
+        return returnvalue::FAILED;
+      }
+      parameterWrapper->set(value);
+      return returnvalue::OK;
+    }
+
+    uint8_t newValue = value;
+    ReturnValue_t result = newValues->getElement(&newValue);
+    if (result != returnvalue::OK) {
+      return result;
+    }
+    if (enableParameter) {
+      if (newValue > 1) {
+        return returnvalue::FAILED;
+      }
+      // Enabling reads the device state again, disabling keeps the last manual setting
+      if (newValue != autoExposure) {
+        resetExposureControl();
+      }
+      autoExposure = newValue;
+    } else {
+      exposureController.setTarget(newValue);
+      exposureTarget = exposureController.getTarget();
+    }
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+    sif::info << "[Webcam] Parameter write: auto exposure " << (autoExposure != 0 ? "on" : "off")
+              << ", target " << static_cast<unsigned int>(exposureTarget) << "." << std::endl;
+#else
+    sif::printInfo("[Webcam] Parameter write: auto exposure %s, target %u.\n",
+                   autoExposure != 0 ? "on" : "off", static_cast<unsigned int>(exposureTarget));
+#endif
+    return returnvalue::OK;
+  }
+
+  if (parameterId == static_cast<uint8_t>(ParameterId::parameterJpegQuality)) {
+    if (startAtIndex != 0) {
+      return returnvalue::FAILED;
+    }
+    if (newValues == nullptr) {
+      if (parameterWrapper == nullptr) {
+        return returnvalue::FAILED;
+      }
+      parameterWrapper->set(jpegQuality);
+      return returnvalue::OK;
+    }
+
+    uint8_t newQuality = jpegQuality;
+    ReturnValue_t result = newValues->getElement(&newQuality);
+    if (result != returnvalue::OK) {
+      return result;
+    }
+    if (newQuality < 1 || newQuality > 100) {
+      return returnvalue::FAILED;
+    }
+    jpegQuality = newQuality;
+    jpegQualityShared.store(newQuality, std::memory_order_relaxed);
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+    sif::info << "[Webcam] Parameter write: JPEG quality " << static_cast<unsigned int>(jpegQuality)
+              << "." << std::endl;
+#else
+    sif::printInfo("[Webcam] Parameter write: JPEG quality %u.\n",
+                   static_cast<unsigned int>(jpegQuality));
+#endif
+    return returnvalue::OK;
+  }
+
   return DeviceHandlerBase::getParameter(domainId, parameterId, parameterWrapper, newValues,
                                          startAtIndex);
 }
@@ -250,6 +555,12 @@ ReturnValue_t WebcamDeviceHandler::letChildHandleMessage(CommandMessage *message
     return returnvalue::OK;
   }
 
+  if (command == ::webcam::CommandId::commandStartStream ||
+      command == ::webcam::CommandId::commandBurst) {
+    // Streamed frames are not replies to a pending command, they go to whoever started the stream
+    streamReceiver = message->getSender();
+  }
+
   store_address_t storeId(message->getParameter());
   ActionMessage::setCommand(message, static_cast<ActionId_t>(rawCommand), storeId);
   ReturnValue_t result = actionHelper.handleActionMessage(message);
@@ -267,34 +578,369 @@ ReturnValue_t WebcamDeviceHandler::buildCommandFromCommand(DeviceCommandId_t dev
 
   switch (command) {
     case CommandId::commandTakeSnapshot:
-      snapshotRequested = true;
-      return returnvalue::OK;
+      snapshotInProgress = true;
+      return prepareCommandPacket(command);
     case CommandId::commandSetFrameRate:
       if (commandData != nullptr && commandDataLen >= sizeof(double)) {
         double newFrameRate = 0.0;
         std::memcpy(&newFrameRate, commandData, sizeof(double));
         requestedFrameRate = newFrameRate;
       }
-      frameRateCommandPending = true;
-      return returnvalue::OK;
+      return prepareCommandPacket(command, reinterpret_cast<const uint8_t *>(&requestedFrameRate),
+                                  sizeof(requestedFrameRate));
     case CommandId::commandGetFrameRate:
-      frameRateQueryPending = true;
-      return returnvalue::OK;
+    case CommandId::commandStartStream:
+    case CommandId::commandStopStream:
+      return prepareCommandPacket(command);
+    case CommandId::commandBurst: {
+      uint32_t frameCount = 0;
+      if (commandData == nullptr || commandDataLen < sizeof(frameCount)) {
+        return DeviceHandlerIF::INVALID_NUMBER_OR_LENGTH_OF_PARAMETERS;
+      }
+      std::memcpy(&frameCount, commandData, sizeof(frameCount));
+      if (frameCount == 0) {
+        return DeviceHandlerIF::INVALID_NUMBER_OR_LENGTH_OF_PARAMETERS;
+      }
+      requestedBurstFrames = frameCount;
+      return prepareCommandPacket(command, reinterpret_cast<const uint8_t *>(&frameCount),
+                                  sizeof(frameCount));
+    }
     default:
       return DeviceHandlerBase::COMMAND_NOT_SUPPORTED;
   }
 }
 
-void WebcamDeviceHandler::prepareReply(DeviceCommandId_t commandId) {
-  if (communicationInterface == nullptr) {
-    fabricatedReplyId = DeviceHandlerIF::NO_COMMAND_ID;
-    replyReady = false;
-    rawPacket = nullptr;
-    rawPacketLen = 0;
+ReturnValue_t WebcamDeviceHandler::prepareCommandPacket(webcam::CommandId command,
+                                                       const uint8_t *payload, size_t payloadLen) {
+  if (payloadLen + 1 > commandBuffer.size()) {
+    return DeviceHandlerIF::INVALID_NUMBER_OR_LENGTH_OF_PARAMETERS;
+  }
+  commandBuffer[0] = static_cast<uint8_t>(command);
+  if (payload != nullptr && payloadLen > 0) {
+    std::memcpy(commandBuffer.data() + 1, payload, payloadLen);
+  }
+  rawPacket = commandBuffer.data();
+  rawPacketLen = payloadLen + 1;
+  return returnvalue::OK;
+}
+
+void WebcamDeviceHandler::handleSnapshotReply(const uint8_t *payload, size_t payloadLen) {
+  snapshotInProgress = false;
+  const bool streamedFrame = streamFrameInProgress;
+  const bool meteringFrame = meteringFrameInProgress;
+  streamFrameInProgress = false;
+  meteringFrameInProgress = false;
+  if (payloadLen < sizeof(webcam::FrameDescriptor)) {
     return;
   }
-  fabricatedReplyId = commandId;
-  replyReady = true;
-  rawPacket = dummyCommandBuffer.data();
-  rawPacketLen = 0;
-}
\ No newline at end of file
+  releaseLastFrame();
+  std::memcpy(&lastFrame, payload, sizeof(lastFrame));
+  lastFrame.camera = camera;
+  lastFrame.processTimeUs = timing::monotonicTimeUs();
+  if (lastFrame.timestampUs != 0 && lastFrame.dequeueTimeUs >= lastFrame.timestampUs) {
+    frameLatency.captureToDequeue.record(lastFrame.dequeueTimeUs - lastFrame.timestampUs);
+  }
+  updateFrameStatistics(lastFrame);
+  if (meteringFrame) {
+    // Only fetched for the exposure loop
+    return;
+  }
+  // Forward our copy, it carries the processing timestamp
+  if (streamedFrame) {
+    updateStreamStatistics(lastFrame);
+    if (!streamFrameChanged(lastFrame)) {
+      // Static scene, the frame never reaches encoding or storage
+      streamStatistics.framesUnchanged++;
+    } else if (streamReceiver != MessageQueueIF::NO_QUEUE) {
+      forwardFrame(streamReceiver);
+    }
+    if (burstFramesRemaining > 0 && --burstFramesRemaining == 0) {
+      reportStreamStatistics(static_cast<DeviceCommandId_t>(webcam::CommandId::commandBurst),
+                             false);
+    }
+    return;
+  }
+  // A snapshot requested through the parameter service has no commander to forward it to
+  auto reply =
+      deviceReplyMap.find(static_cast<DeviceCommandId_t>(webcam::CommandId::commandTakeSnapshot));
+  if (reply != deviceReplyMap.end() && reply->second.command != deviceCommandMap.end() &&
+      reply->second.command->second.sendReplyTo != MessageQueueIF::NO_QUEUE) {
+    forwardFrame(reply->second.command->second.sendReplyTo);
+  }
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+  sif::info << "[Webcam] Snapshot completed: frame " << lastFrame.sequence << ", "
+            << lastFrame.width << "x" << lastFrame.height << ", " << lastFrame.bytesUsed
+            << " bytes." << std::endl;
+#else
+  sif::printInfo("[Webcam] Snapshot completed: frame %u, %ux%u, %u bytes.\n", lastFrame.sequence,
+                 lastFrame.width, lastFrame.height, lastFrame.bytesUsed);
+#endif
+}
+
+void WebcamDeviceHandler::forwardFrame(MessageQueueId_t receiver) {
+  // The reference is taken before the descriptor leaves, otherwise the buffer could be requeued
+  // while the report still sits in the queue of the receiver. Sent directly instead of through
+  // handleDeviceTm(), so a report which does not go out gives its reference back.
+  webcam::FrameStoreIF *frameStore = getFrameStore();
+  webcam::FrameLease lease(lastFrame.lease);
+  if (frameStore == nullptr || frameStore->addReference(lease) != returnvalue::OK) {
+    return;
+  }
+  ReturnValue_t result = actionHelper.reportData(
+      receiver, static_cast<ActionId_t>(webcam::CommandId::commandTakeSnapshot),
+      reinterpret_cast<const uint8_t *>(&lastFrame), sizeof(lastFrame));
+  if (result != returnvalue::OK) {
+    (void)frameStore->releaseFrame(lease);
+  }
+}
+
+void WebcamDeviceHandler::releaseLastFrame() {
+  webcam::FrameLease lease(lastFrame.lease);
+  if (!lease.isValid()) {
+    return;
+  }
+  webcam::FrameStoreIF *frameStore = getFrameStore();
+  if (frameStore != nullptr) {
+    (void)frameStore->releaseFrame(lease);
+  }
+  lastFrame.lease = webcam::FrameLease::INVALID;
+}
+
+webcam::FrameStoreIF *WebcamDeviceHandler::getFrameStore() {
+  return dynamic_cast<webcam::FrameStoreIF *>(communicationInterface);
+}
+
+void WebcamDeviceHandler::startStream(uint32_t burstFrames) {
+  streamActive = burstFrames == 0;
+  burstFramesRemaining = burstFrames;
+  streamStatistics = {};
+  streamHasFrame = false;
+  changeDetector.reset();
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+  if (streamActive) {
+    sif::info << "[Webcam] Stream started." << std::endl;
+  } else {
+    sif::info << "[Webcam] Burst of " << burstFrames << " frames started." << std::endl;
+  }
+#else
+  if (streamActive) {
+    sif::printInfo("[Webcam] Stream started.\n");
+  } else {
+    sif::printInfo("[Webcam] Burst of %u frames started.\n", burstFrames);
+  }
+#endif
+}
+
+void WebcamDeviceHandler::updateStreamStatistics(const webcam::FrameDescriptor &frame) {
+  if (!streamHasFrame) {
+    streamHasFrame = true;
+    streamStartRingDrops = frame.droppedFrames;
+  } else if (frame.sequence > lastStreamSequence + 1) {
+    streamStatistics.framesDropped += frame.sequence - lastStreamSequence - 1;
+  }
+  lastStreamSequence = frame.sequence;
+  streamStatistics.framesDelivered++;
+  streamStatistics.ringDrops = frame.droppedFrames - streamStartRingDrops;
+
+  if (streamStatistics.framesDelivered % STREAM_REPORT_INTERVAL_FRAMES == 0) {
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+    sif::info << "[Webcam] Stream: " << streamStatistics.framesDelivered << " frames, "
+              << streamStatistics.framesDropped << " dropped (" << streamStatistics.ringDrops
+              << " in ring), " << streamStatistics.framesUnchanged << " unchanged." << std::endl;
+#else
+    sif::printInfo("[Webcam] Stream: %u frames, %u dropped (%u in ring), %u unchanged.\n",
+                   streamStatistics.framesDelivered, streamStatistics.framesDropped,
+                   streamStatistics.ringDrops, streamStatistics.framesUnchanged);
+#endif
+  }
+}
+
+void WebcamDeviceHandler::reportStreamStatistics(DeviceCommandId_t command, bool toCommander) {
+  const auto *data = reinterpret_cast<const uint8_t *>(&streamStatistics);
+  if (toCommander) {
+    handleDeviceTm(data, sizeof(streamStatistics), command);
+  } else if (streamReceiver != MessageQueueIF::NO_QUEUE) {
+    // End of a burst, the burst command itself has completed long ago
+    (void)actionHelper.reportData(streamReceiver, static_cast<ActionId_t>(command), data,
+                                  sizeof(streamStatistics));
+  }
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+  sif::info << "[Webcam] Stream finished: " << streamStatistics.framesDelivered << " frames, "
+            << streamStatistics.framesDropped << " dropped (" << streamStatistics.ringDrops
+            << " in ring), " << streamStatistics.framesUnchanged << " unchanged." << std::endl;
+#else
+  sif::printInfo("[Webcam] Stream finished: %u frames, %u dropped (%u in ring), %u unchanged.\n",
+                 streamStatistics.framesDelivered, streamStatistics.framesDropped,
+                 streamStatistics.ringDrops, streamStatistics.framesUnchanged);
+#endif
+}
+
+bool WebcamDeviceHandler::streamFrameChanged(const webcam::FrameDescriptor &frame) {
+  if (changeThreshold <= 0.0) {
+    return true;
+  }
+  const uint8_t *data = getFrameData(frame);
+  if (data == nullptr) {
+    return true;
+  }
+  // Frames which can not be evaluated are always forwarded
+  imaging::ChangeDetector::Result result;
+  switch (frame.pixelFormat) {
+    case V4L2_PIX_FMT_YUYV:
+      if (frame.bytesUsed >= static_cast<size_t>(frame.width) * frame.height * 2) {
+        (void)changeDetector.evaluateYuyv(data, frame.width, frame.height, changeThreshold,
+                                          result);
+      }
+      break;
+    case V4L2_PIX_FMT_MJPEG:
+    case V4L2_PIX_FMT_JPEG:
+      (void)changeDetector.evaluateMjpeg(data, frame.bytesUsed, changeThreshold, result);
+      break;
+    default:
+      break;
+  }
+  return result.changed;
+}
+
+void WebcamDeviceHandler::updateFrameStatistics(const webcam::FrameDescriptor &frame) {
+  const uint8_t *data = getFrameData(frame);
+  if (data == nullptr) {
+    return;
+  }
+  imaging::ImageStatistics::Result result;
+  bool analysed = false;
+  switch (frame.pixelFormat) {
+    case V4L2_PIX_FMT_YUYV:
+      if (frame.bytesUsed >= static_cast<size_t>(frame.width) * frame.height * 2) {
+        analysed = imageStatistics.analyzeYuyv(data, frame.width, frame.height, result);
+      }
+      break;
+    case V4L2_PIX_FMT_MJPEG:
+    case V4L2_PIX_FMT_JPEG:
+      analysed = imageStatistics.analyzeMjpeg(data, frame.bytesUsed, result);
+      break;
+    default:
+      break;
+  }
+
+  if (analysed) {
+    updateExposure(frame, result);
+  }
+
+  PoolReadGuard readGuard(&frameStatisticsSet);
+  if (readGuard.getReadResult() != returnvalue::OK) {
+    return;
+  }
+  // A frame which can not be analysed invalidates the previous values
+  if (!analysed) {
+    frameStatisticsSet.setValidity(false, true);
+    return;
+  }
+  frameStatisticsSet.sequence.value = frame.sequence;
+  frameStatisticsSet.width.value = static_cast<uint16_t>(result.width);
+  frameStatisticsSet.height.value = static_cast<uint16_t>(result.height);
+  frameStatisticsSet.lumaMean.value = result.mean;
+  frameStatisticsSet.lumaVariance.value = result.variance;
+  frameStatisticsSet.saturatedRatio.value = result.saturatedRatio;
+  frameStatisticsSet.blackRatio.value = result.blackRatio;
+  frameStatisticsSet.sharpness.value = result.sharpness;
+  std::memcpy(frameStatisticsSet.lumaHistogram.value, result.histogram.data(),
+              sizeof(frameStatisticsSet.lumaHistogram.value));
+  frameStatisticsSet.exposure.value = exposureController.getSetting().exposure;
+  frameStatisticsSet.gain.value = exposureController.getSetting().gain;
+  frameStatisticsSet.setValidity(true, true);
+}
+
+void WebcamDeviceHandler::updateExposure(const webcam::FrameDescriptor &frame,
+                                         const imaging::ImageStatistics::Result &statistics) {
+  const uint64_t nowUs = timing::monotonicTimeUs();
+  if (autoExposure == 0 || exposureUpdatePending ||
+      nowUs - lastExposureUpdateUs < static_cast<uint64_t>(EXPOSURE_UPDATE_INTERVAL_MS) * 1000) {
+    return;
+  }
+  imaging::ExposureController::Setting next;
+  if (!exposureController.update(frame.sequence, statistics, next)) {
+    return;
+  }
+  lastExposureUpdateUs = nowUs;
+  pendingExposure.exposure = next.exposure;
+  pendingExposure.gain = next.gain;
+  exposureUpdatePending = true;
+}
+
+void WebcamDeviceHandler::handleExposureReply(webcam::CommandId command, const uint8_t *payload,
+                                              size_t payloadLen) {
+  exposureCommandInProgress = false;
+  webcam::ExposureControls controls;
+  if (payloadLen < sizeof(controls)) {
+    // Same as a missed reply, the device state is read again
+    resetExposureControl();
+    return;
+  }
+  std::memcpy(&controls, payload, sizeof(controls));
+  const imaging::ExposureController::Setting setting{controls.current.exposure,
+                                                     controls.current.gain};
+  if (command == webcam::CommandId::commandSetExposure) {
+    // Frames up to the newest one may still carry the old exposure
+    exposureController.applied(setting, lastFrame.sequence);
+    return;
+  }
+  imaging::ExposureController::Limits limits;
+  limits.exposureMin = controls.exposureMin;
+  limits.exposureMax = controls.exposureMax;
+  limits.gainMin = controls.gainMin;
+  limits.gainMax = controls.gainMax;
+  exposureController.configure(limits, setting);
+  exposureController.setFrameRate(currentFrameRate);
+#if FSFW_CPP_OSTREAM_ENABLED == 1
+  sif::info << "[Webcam] Auto exposure: exposure " << setting.exposure << " ("
+            << limits.exposureMin << ".." << limits.exposureMax << "), gain " << setting.gain
+            << " (" << limits.gainMin << ".." << limits.gainMax << ")." << std::endl;
+#else
+  sif::printInfo("[Webcam] Auto exposure: exposure %d (%d..%d), gain %d (%d..%d).\n",
+                 static_cast<int>(setting.exposure), static_cast<int>(limits.exposureMin),
+                 static_cast<int>(limits.exposureMax), static_cast<int>(setting.gain),
+                 static_cast<int>(limits.gainMin), static_cast<int>(limits.gainMax));
+#endif
+}
+
+void WebcamDeviceHandler::resetExposureControl() {
+  exposureController.reset();
+  exposureCommandInProgress = false;
+  exposureUpdatePending = false;
+}
+
+const uint8_t *WebcamDeviceHandler::getFrameData(const webcam::FrameDescriptor &frame) {
+  webcam::FrameStoreIF *frameStore = getFrameStore();
+  const uint8_t *data = nullptr;
+  if (frameStore == nullptr ||
+      frameStore->getFrame(webcam::FrameLease(frame.lease), &data, nullptr) != returnvalue::OK) {
+    return nullptr;
+  }
+  return data;
+}
+
+ReturnValue_t WebcamDeviceHandler::initializeLocalDataPool(localpool::DataPool &localDataPoolMap,
+                                                           LocalDataPoolManager &poolManager) {
+  localDataPoolMap.emplace(webcam::poolFrameSequence, new PoolEntry<uint32_t>({0}));
+  localDataPoolMap.emplace(webcam::poolFrameWidth, new PoolEntry<uint16_t>({0}));
+  localDataPoolMap.emplace(webcam::poolFrameHeight, new PoolEntry<uint16_t>({0}));
+  localDataPoolMap.emplace(webcam::poolLumaMean, new PoolEntry<float>({0.0f}));
+  localDataPoolMap.emplace(webcam::poolLumaVariance, new PoolEntry<float>({0.0f}));
+  localDataPoolMap.emplace(webcam::poolSaturatedRatio, new PoolEntry<float>({0.0f}));
+  localDataPoolMap.emplace(webcam::poolBlackRatio, new PoolEntry<float>({0.0f}));
+  localDataPoolMap.emplace(webcam::poolSharpness, new PoolEntry<float>({0.0f}));
+  localDataPoolMap.emplace(webcam::poolLumaHistogram,
+                           new PoolEntry<uint32_t>(webcam::LUMA_HISTOGRAM_BINS));
+  localDataPoolMap.emplace(webcam::poolExposure, new PoolEntry<int32_t>({0}));
+  localDataPoolMap.emplace(webcam::poolGain, new PoolEntry<int32_t>({0}));
+  return poolManager.subscribeForRegularPeriodicPacket(subdp::RegularHkPeriodicParams(
+      frameStatisticsSet.getSid(), true, webcam::FRAME_STATISTICS_INTERVAL_S));
+}
+
+LocalPoolDataSetBase *WebcamDeviceHandler::getDataSetHandle(sid_t sid) {
+  if (sid.ownerSetId == webcam::FRAME_STATISTICS_SET_ID) {
+    return &frameStatisticsSet;
+  }
+  return nullptr;
+}
@@ -19,7 +19,16 @@
 #include <fsfw/devicehandlers/CookieIF.h>
 #include <fsfw/parameters/ParameterWrapper.h>
 #include <fsfw/returnvalues/returnvalue.h>
+#include "FrameStatisticsSet.h"
+#include "FrameStoreIF.h"
+#include "WebcamDefinitions.h"
+#include "mission/imaging/ChangeDetector.h"
+#include "mission/imaging/ExposureController.h"
+#include "mission/imaging/ImageStatistics.h"
+#include "mission/timing/LatencyHistogram.h"
+#include "mission/timing/SlotJitterMonitor.h"
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 
@@ -31,11 +40,30 @@ public:
     WebcamDeviceHandler(object_id_t objectId, object_id_t deviceCommunication = 0,
                     CookieIF *comCookie = nullptr, FailureIsolationBase *fdirInstance = nullptr,
                     size_t cmdQueueSize = 20);
+    ~WebcamDeviceHandler() override;
     double currentFrameRate = 0.0;   // latest reported framerate
     double requestedFrameRate = 0.0; // framerate to set ie from tmtc
     bool snapshotRequested = false;  //
-    void doStartUp() override; //TODO: implement HW startup logic like getting the webcamhanlder
-    void doShutDown() override; //TODO: implement HW shutdown logic like releasing the webcamhandler
+    void doStartUp() override;   // starts streaming on the ComIF side
+    void doShutDown() override;  // stops streaming and releases the device
+
+    // Frame latency along the pipeline, the later stages are recorded by the frame consumers
+    struct FrameLatency {
+        timing::LatencyHistogram captureToDequeue;
+        timing::LatencyHistogram dequeueToStore;
+        timing::LatencyHistogram storeToTm;
+    };
+    FrameLatency &getFrameLatency() { return frameLatency; }
+    // JPEG quality for YUYV snapshots, read by the frame consumers from their own threads
+    uint8_t getJpegQuality() const { return jpegQualityShared.load(std::memory_order_relaxed); }
+    uint8_t getCamera() const { return camera; }
+    // Event driven tasks wait on this eventfd, wakeUp() is called by whoever queued a command
+    int getWakeupFd() const { return wakeupFd; }
+    void wakeUp();
+    // Slot offsets when scheduled in a fixed timeslot task, enables the jitter measurement
+    void configureSlotJitter(uint32_t periodMs, const uint32_t *offsetsMs, size_t steps);
+    const timing::SlotJitterMonitor &getSlotJitter() const { return slotJitter; }
+    ReturnValue_t performOperation(uint8_t counter) override;
 protected:
     ReturnValue_t buildTransitionDeviceCommand(DeviceCommandId_t *deviceCommand) override;
     ReturnValue_t buildNormalDeviceCommand(DeviceCommandId_t *deviceCommand) override;
@@ -46,14 +74,83 @@ protected:
     ReturnValue_t getParameter(uint8_t domainId, uint8_t parameterId, ParameterWrapper *parameterWrapper, const ParameterWrapper *newValues, uint16_t startAtIndex) override;
     ReturnValue_t buildCommandFromCommand(DeviceCommandId_t deviceCommand, const uint8_t *commandData, size_t commandDataLen) override;
     ReturnValue_t letChildHandleMessage(CommandMessage *message) override;
+    ReturnValue_t initializeLocalDataPool(localpool::DataPool &localDataPoolMap,
+                                          LocalDataPoolManager &poolManager) override;
+    LocalPoolDataSetBase *getDataSetHandle(sid_t sid) override;
+    // Tells the ComIF whether frames should wake our task, see WebcamCookie::setFrameWakeup()
+    void performOperationHook() override;
+    // Clears the in-progress state of the timed out command, otherwise no new one is sent
+    void missedReply(DeviceCommandId_t id) override;
 private:
-    void prepareReply(DeviceCommandId_t commandId);
+    // max. cycles to wait for a reply, a snapshot may have to wait for the next frame
+    static constexpr uint16_t REPLY_DELAY_CYCLES = 5;
+    static constexpr uint32_t START_UP_TIMEOUT_MS = 5000;
+    // dropped-frame report interval while streaming
+    static constexpr uint32_t STREAM_REPORT_INTERVAL_FRAMES = 100;
+    static constexpr uint8_t DEFAULT_JPEG_QUALITY = 85;
+    // Auto exposure: at most one new setting per interval, without a stream the loop fetches
+    // a metering frame of its own every METERING_INTERVAL_MS
+    static constexpr uint32_t EXPOSURE_UPDATE_INTERVAL_MS = 100;
+    static constexpr uint32_t METERING_INTERVAL_MS = 200;
+    static constexpr uint32_t SLOT_JITTER_REPORT_INTERVAL_MS = 60000;
+
+    ReturnValue_t prepareCommandPacket(webcam::CommandId command, const uint8_t *payload = nullptr,
+                                       size_t payloadLen = 0);
+    void handleSnapshotReply(const uint8_t *payload, size_t payloadLen);
+    // Reports lastFrame to the receiver, which owns one reference to the lease from then on
+    void forwardFrame(MessageQueueId_t receiver);
+    void releaseLastFrame();
+    webcam::FrameStoreIF *getFrameStore();
+    void startStream(uint32_t burstFrames);
+    void updateStreamStatistics(const webcam::FrameDescriptor &frame);
+    void reportStreamStatistics(DeviceCommandId_t command, bool toCommander);
+    // False if the streamed frame differs less than changeThreshold from the last forwarded one
+    bool streamFrameChanged(const webcam::FrameDescriptor &frame);
+    // Image quality metrics of every frame the handler receives, published as housekeeping
+    void updateFrameStatistics(const webcam::FrameDescriptor &frame);
+    const uint8_t *getFrameData(const webcam::FrameDescriptor &frame);
+    void updateExposure(const webcam::FrameDescriptor &frame,
+                        const imaging::ImageStatistics::Result &statistics);
+    void handleExposureReply(webcam::CommandId command, const uint8_t *payload, size_t payloadLen);
+    void resetExposureControl();
+    void reportSlotJitter();
+    uint8_t camera;  // index derived from the object id, stamped into every frame descriptor
+    int wakeupFd = -1;
+    timing::SlotJitterMonitor slotJitter;
+    uint64_t lastSlotJitterReportUs = 0;
     bool devicePowered = false;
     bool transitionCommandPending = false;
-    bool frameRateCommandPending = false;
-    bool frameRateQueryPending = false;
+    bool transitionCommandSent = false;
     bool snapshotInProgress = false;
-    bool replyReady = false;
-    DeviceCommandId_t fabricatedReplyId = DeviceHandlerIF::NO_COMMAND_ID;
-    std::array<uint8_t, 1> dummyCommandBuffer{};
+    webcam::FrameDescriptor lastFrame{};  // the handler keeps one lease on the newest snapshot
+    FrameLatency frameLatency;
+    uint8_t jpegQuality = DEFAULT_JPEG_QUALITY;  // parameter value, handler thread only
+    std::atomic<uint8_t> jpegQualityShared{DEFAULT_JPEG_QUALITY};
+    webcam::FrameStatisticsSet frameStatisticsSet{this};
+    imaging::ImageStatistics imageStatistics;
+
+    // Auto exposure loop, see imaging::ExposureController
+    imaging::ExposureController exposureController;
+    uint8_t autoExposure = 0;  // parameter value, 0 off / 1 on
+    uint8_t exposureTarget = imaging::ExposureController::DEFAULT_TARGET;
+    bool exposureCommandInProgress = false;
+    bool exposureUpdatePending = false;
+    webcam::ExposureSetting pendingExposure{};
+    bool meteringFrameInProgress = false;
+    uint64_t lastExposureUpdateUs = 0;
+    uint64_t lastMeteringUs = 0;
+
+    // Streaming / burst state, frames are fetched without per-frame commanding
+    bool streamActive = false;
+    bool streamFrameInProgress = false;
+    uint32_t burstFramesRemaining = 0;
+    uint32_t requestedBurstFrames = 0;
+    MessageQueueId_t streamReceiver = MessageQueueIF::NO_QUEUE;  // gets every streamed frame
+    webcam::StreamStatistics streamStatistics{};
+    bool streamHasFrame = false;
+    uint32_t lastStreamSequence = 0;
+    uint32_t streamStartRingDrops = 0;
+    imaging::ChangeDetector changeDetector;
+    double changeThreshold = 0.0;
+    std::array<uint8_t, webcam::MAX_COMMAND_SIZE> commandBuffer{};
 };
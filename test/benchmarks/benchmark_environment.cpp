@@ -0,0 +1,46 @@
+#include "benchmark_environment.h"
+
+#include <fsfw/objectmanager/ObjectManager.h>
+#include <fsfw/objectmanager/frameworkObjects.h>
+#include <fsfw/storagemanager/PoolManager.h>
+#include <fsfw/timemanager/CdsShortTimeStamper.h>
+
+#include <memory>
+
+#include "ColorConversion.h"
+#include "mission/ObjectFactory.h"
+#include "mission/tmtc/TmtcInfrastructure.h"
+#include "mission/webcam/WebcamDefinitions.h"
+
+namespace bench {
+
+MissionEnvironment& missionEnvironment() {
+    // Lebt bis Programmende, die Objekte sind im ObjectManager eingetragen
+    static MissionEnvironment environment = [] {
+        static auto ipcStore = std::make_unique<PoolManager>(
+            objects::IPC_STORE, ObjectFactory::getStoreConfig(objects::IPC_STORE));
+        static auto tcStore = std::make_unique<webcam::TcPoolManager>(
+            objects::TC_STORE, ObjectFactory::getStoreConfig(objects::TC_STORE));
+        static auto tmStore = std::make_unique<PoolManager>(
+            objects::TM_STORE, ObjectFactory::getStoreConfig(objects::TM_STORE));
+        static auto timeStamper = std::make_unique<CdsShortTimeStamper>(objects::TIME_STAMPER);
+        static auto distributor =
+            std::make_unique<webcam::StubPusDistributor>(webcam::objectIdWebcamTcDistributor);
+        ObjectManager::instance()->initialize();
+        return MissionEnvironment{ipcStore.get(), tcStore.get(), tmStore.get(), timeStamper.get(),
+                                  distributor.get()};
+    }();
+    return environment;
+}
+
+std::vector<uint8_t> makeFrame(uint32_t width, uint32_t height) {
+    std::vector<uint8_t> frame(imaging::yuyvSize(width, height));
+    uint32_t state = 0x12345678u;
+    for (size_t i = 0; i < frame.size(); ++i) {
+        state = state * 1664525u + 1013904223u;
+        frame[i] = (i % 7 == 0) ? static_cast<uint8_t>(i) : static_cast<uint8_t>(state >> 24);
+    }
+    return frame;
+}
+
+}  // namespace bench
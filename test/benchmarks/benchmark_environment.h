@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class PoolManager;
+class CdsShortTimeStamper;
+
+namespace webcam {
+class StubPusDistributor;
+}
+
+/*
+ * Gemeinsame Umgebung der FSFW-Benchmarks: IPC-, TC- und TM-Store mit den Konfigurationen
+ * aus ObjectFactory, Zeitstempel und TC-Verteiler. Ohne Kameras und ohne Tasks, es werden
+ * nur die Objekte angelegt, die die gemessenen Pfade brauchen.
+ */
+namespace bench {
+
+struct MissionEnvironment {
+    PoolManager* ipcStore = nullptr;
+    PoolManager* tcStore = nullptr;
+    PoolManager* tmStore = nullptr;
+    CdsShortTimeStamper* timeStamper = nullptr;
+    webcam::StubPusDistributor* distributor = nullptr;
+};
+
+// Legt die Objekte beim ersten Aufruf an und initialisiert den ObjectManager
+MissionEnvironment& missionEnvironment();
+
+// Objekt-IDs der Benchmark-Objekte, außerhalb der Missions-IDs
+constexpr uint32_t BENCHMARK_OBJECT_BASE = 0x5700F000;
+
+// Deterministisches Testbild wie in conversion_benchmark: Verläufe plus Pseudozufall
+std::vector<uint8_t> makeFrame(uint32_t width, uint32_t height);
+
+}  // namespace bench
@@ -0,0 +1,118 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "ColorConversion.h"
+#include "ParallelConversion.h"
+#include "benchmark_environment.h"
+
+/*
+ * YUYV-Konvertierungen je Backend und Auflösung, einzeln und mit dem Worker-Pool.
+ * Argumente: Backend, Breite, Höhe. Nicht unterstützte Backends werden übersprungen.
+ * Durchsatz: bytes_per_second bezieht sich auf das YUYV-Eingangsbild.
+ */
+
+namespace {
+
+enum class Conversion { rgb24, y8, nv12 };
+
+const uint32_t RESOLUTIONS[][2] = {{640, 480}, {1920, 1080}};
+
+void conversionArguments(benchmark::internal::Benchmark* bm) {
+    bm->ArgNames({"backend", "width", "height"});
+    for (auto backend : {imaging::Backend::scalar, imaging::Backend::sse2, imaging::Backend::avx2,
+                         imaging::Backend::neon}) {
+        for (const auto& resolution : RESOLUTIONS) {
+            bm->Args({static_cast<int64_t>(backend), resolution[0], resolution[1]});
+        }
+    }
+}
+
+void resolutionArguments(benchmark::internal::Benchmark* bm) {
+    bm->ArgNames({"width", "height"});
+    for (const auto& resolution : RESOLUTIONS) {
+        bm->Args({resolution[0], resolution[1]});
+    }
+}
+
+size_t outputSize(Conversion conversion, uint32_t width, uint32_t height) {
+    switch (conversion) {
+        case Conversion::rgb24:
+            return imaging::rgb24Size(width, height);
+        case Conversion::y8:
+            return imaging::y8Size(width, height);
+        case Conversion::nv12:
+        default:
+            return imaging::nv12Size(width, height);
+    }
+}
+
+void setThroughput(benchmark::State& state, uint32_t width, uint32_t height) {
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                            static_cast<int64_t>(imaging::yuyvSize(width, height)));
+    state.counters["MPix/s"] = benchmark::Counter(
+        static_cast<double>(state.iterations()) * width * height / 1e6, benchmark::Counter::kIsRate);
+}
+
+template <Conversion conversion>
+void BM_Conversion(benchmark::State& state) {
+    const auto backend = static_cast<imaging::Backend>(state.range(0));
+    const auto width = static_cast<uint32_t>(state.range(1));
+    const auto height = static_cast<uint32_t>(state.range(2));
+    const imaging::Backend previous = imaging::activeBackend();
+    if (!imaging::setBackend(backend)) {
+        state.SkipWithError("backend not supported");
+        return;
+    }
+    state.SetLabel(imaging::backendToString(backend));
+    const std::vector<uint8_t> yuyv = bench::makeFrame(width, height);
+    std::vector<uint8_t> output(outputSize(conversion, width, height));
+    for (auto _ : state) {
+        if (conversion == Conversion::rgb24) {
+            imaging::yuyvToRgb24(yuyv.data(), output.data(), width, height);
+        } else if (conversion == Conversion::y8) {
+            imaging::yuyvToY8(yuyv.data(), output.data(), width, height);
+        } else {
+            imaging::yuyvToNv12(yuyv.data(), output.data(), width, height);
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    imaging::setBackend(previous);
+    setThroughput(state, width, height);
+}
+
+// Worker-Pool mit dem erkannten Backend, wie im Device Handler
+template <Conversion conversion>
+void BM_ParallelConversion(benchmark::State& state) {
+    const auto width = static_cast<uint32_t>(state.range(0));
+    const auto height = static_cast<uint32_t>(state.range(1));
+    static imaging::ParallelConverter converter;
+    imaging::setBackend(imaging::detectBackend());
+    state.SetLabel(imaging::backendToString(imaging::activeBackend()));
+    const std::vector<uint8_t> yuyv = bench::makeFrame(width, height);
+    std::vector<uint8_t> output(outputSize(conversion, width, height));
+    for (auto _ : state) {
+        if (conversion == Conversion::rgb24) {
+            converter.yuyvToRgb24(yuyv.data(), output.data(), width, height);
+        } else if (conversion == Conversion::y8) {
+            converter.yuyvToY8(yuyv.data(), output.data(), width, height);
+        } else {
+            converter.yuyvToNv12(yuyv.data(), output.data(), width, height);
+        }
+        benchmark::DoNotOptimize(output.data());
+        benchmark::ClobberMemory();
+    }
+    state.counters["workers"] = converter.getWorkerCount() + 1;
+    setThroughput(state, width, height);
+}
+
+}  // namespace
+
+BENCHMARK_TEMPLATE(BM_Conversion, Conversion::rgb24)->Apply(conversionArguments);
+BENCHMARK_TEMPLATE(BM_Conversion, Conversion::y8)->Apply(conversionArguments);
+BENCHMARK_TEMPLATE(BM_Conversion, Conversion::nv12)->Apply(conversionArguments);
+BENCHMARK_TEMPLATE(BM_ParallelConversion, Conversion::rgb24)->Apply(resolutionArguments)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParallelConversion, Conversion::y8)->Apply(resolutionArguments)->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParallelConversion, Conversion::nv12)->Apply(resolutionArguments)->UseRealTime();
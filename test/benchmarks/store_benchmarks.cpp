@@ -0,0 +1,125 @@
+#include <benchmark/benchmark.h>
+
+#include <fsfw/objectmanager/frameworkObjects.h>
+#include <fsfw/storagemanager/LocalPool.h>
+#include <fsfw/storagemanager/PoolManager.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark_environment.h"
+#include "mission/ObjectFactory.h"
+
+/*
+ * Reservieren und Freigeben von Store-Seiten mit den Konfigurationen aus ObjectFactory.
+ * Argumente: Store (0 IPC, 1 TC, 2 TM) und Index der Seitengröße in dessen Konfiguration.
+ * LocalPool ist eine nicht registrierte Kopie ohne Mutex, PoolManager der Store der Mission.
+ */
+
+namespace {
+
+const object_id_t STORES[] = {objects::IPC_STORE, objects::TC_STORE, objects::TM_STORE};
+const char* const STORE_NAMES[] = {"ipc", "tc", "tm"};
+
+void storeArguments(benchmark::internal::Benchmark* bm) {
+    bm->ArgNames({"store", "bucket"});
+    for (int64_t store = 0; store < 3; store++) {
+        const LocalPool::LocalPoolConfig config = ObjectFactory::getStoreConfig(STORES[store]);
+        for (int64_t bucket = 0; bucket < static_cast<int64_t>(config.size()); bucket++) {
+            bm->Args({store, bucket});
+        }
+    }
+}
+
+// Nicht registrierte LocalPools mit derselben Konfiguration, eine pro Store
+LocalPool& localPool(int64_t store) {
+    static std::vector<std::unique_ptr<LocalPool>> pools = [] {
+        std::vector<std::unique_ptr<LocalPool>> result;
+        for (size_t index = 0; index < 3; index++) {
+            result.push_back(std::make_unique<LocalPool>(
+                bench::BENCHMARK_OBJECT_BASE + 0x100 + index, ObjectFactory::getStoreConfig(STORES[index]),
+                false));
+        }
+        return result;
+    }();
+    return *pools[store];
+}
+
+PoolManager& poolManager(int64_t store) {
+    bench::MissionEnvironment& environment = bench::missionEnvironment();
+    PoolManager* const managers[] = {environment.ipcStore, environment.tcStore, environment.tmStore};
+    return *managers[store];
+}
+
+// Seitengröße und -anzahl des Buckets, setzt das Label
+LocalPool::LocalPoolConfig::value_type bucketOf(benchmark::State& state, const char* kind) {
+    const int64_t store = state.range(0);
+    const auto bucket = ObjectFactory::getStoreConfig(STORES[store])[state.range(1)];
+    state.SetLabel(std::string(kind) + " " + STORE_NAMES[store] + " " + std::to_string(bucket.second) + " B x" +
+                   std::to_string(bucket.first));
+    return bucket;
+}
+
+// Eine Seite reservieren, beschreiben und wieder freigeben, wie ein Command- oder TM-Paket
+void getDeleteCycle(benchmark::State& state, StorageManagerIF& pool, size_t pageSize) {
+    store_address_t storeId;
+    uint8_t* data = nullptr;
+    for (auto _ : state) {
+        if (pool.getFreeElement(&storeId, pageSize, &data) != returnvalue::OK) {
+            state.SkipWithError("getFreeElement failed");
+            break;
+        }
+        data[0] = 0xAB;
+        benchmark::DoNotOptimize(data);
+        pool.deleteData(storeId);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Alle Seiten eines Buckets belegen und in derselben Reihenfolge freigeben, misst die
+// Suche nach freien Seiten bei steigendem Füllstand
+void fillDrainCycle(benchmark::State& state, StorageManagerIF& pool, uint16_t pages, size_t pageSize) {
+    std::vector<store_address_t> storeIds(pages);
+    uint8_t* data = nullptr;
+    for (auto _ : state) {
+        for (auto& storeId : storeIds) {
+            if (pool.getFreeElement(&storeId, pageSize, &data) != returnvalue::OK) {
+                state.SkipWithError("getFreeElement failed");
+                return;
+            }
+        }
+        for (const auto& storeId : storeIds) {
+            pool.deleteData(storeId);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * pages);
+}
+
+void BM_LocalPoolGetDelete(benchmark::State& state) {
+    const auto bucket = bucketOf(state, "LocalPool");
+    getDeleteCycle(state, localPool(state.range(0)), bucket.second);
+}
+
+void BM_PoolManagerGetDelete(benchmark::State& state) {
+    const auto bucket = bucketOf(state, "PoolManager");
+    getDeleteCycle(state, poolManager(state.range(0)), bucket.second);
+}
+
+void BM_LocalPoolFillDrain(benchmark::State& state) {
+    const auto bucket = bucketOf(state, "LocalPool");
+    fillDrainCycle(state, localPool(state.range(0)), bucket.first, bucket.second);
+}
+
+void BM_PoolManagerFillDrain(benchmark::State& state) {
+    const auto bucket = bucketOf(state, "PoolManager");
+    fillDrainCycle(state, poolManager(state.range(0)), bucket.first, bucket.second);
+}
+
+}  // namespace
+
+BENCHMARK(BM_LocalPoolGetDelete)->Apply(storeArguments);
+BENCHMARK(BM_PoolManagerGetDelete)->Apply(storeArguments);
+BENCHMARK(BM_LocalPoolFillDrain)->Apply(storeArguments);
+BENCHMARK(BM_PoolManagerFillDrain)->Apply(storeArguments);
@@ -0,0 +1,266 @@
+#include <benchmark/benchmark.h>
+
+#include <fsfw/ipc/CommandMessage.h>
+#include <fsfw/ipc/MessageQueueIF.h>
+#include <fsfw/ipc/MessageQueueMessage.h>
+#include <fsfw/ipc/QueueFactory.h>
+#include <fsfw/storagemanager/PoolManager.h>
+#include <fsfw/tmtcservices/AcceptsTelecommandsIF.h>
+#include <fsfw/tmtcservices/TmTcMessage.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "benchmark_environment.h"
+#include "mission/tmtc/TmtcInfrastructure.h"
+#include "mission/tmtc/WebcamCommandingService.h"
+
+/*
+ * TMTC-Pfade ohne Tasks:
+ *  - StubPusDistributor::sendCommand: TC erzeugen, in den TC-Store schreiben, Nachricht senden
+ *  - StubPusDistributor::sendCommands: dasselbe für eine Kommandosequenz am Stück
+ *  - StubPusDistributor::ingestStream: rohe CCSDS-Pakete mit CRC-Prüfung verteilen
+ *  - WebcamCommandingService: Gerätekommando mit Parametern im IPC-Store vorbereiten
+ *  - StubTelemetrySink: PUS-TM auswerten und die Berichtszeile formatieren
+ */
+
+namespace {
+
+using webcam::WebcamCommandingService;
+using Subservice = WebcamCommandingService::Subservice;
+
+// Nimmt die TCs des Verteilers an Stelle des Webcam-Dienstes entgegen
+class BenchmarkTcSink : public AcceptsTelecommandsIF {
+public:
+    BenchmarkTcSink() : queue(QueueFactory::instance()->createMessageQueue(QUEUE_DEPTH, MessageQueueMessage::MAX_MESSAGE_SIZE)) {}
+    ~BenchmarkTcSink() override { QueueFactory::instance()->deleteMessageQueue(queue); }
+
+    [[nodiscard]] const char* getName() const override { return "benchmark TC sink"; }
+    [[nodiscard]] uint32_t getIdentifier() const override { return WebcamCommandingService::SERVICE_ID; }
+    [[nodiscard]] MessageQueueId_t getRequestQueue() const override { return queue->getId(); }
+
+    // Holt den TC ab und gibt die Store-Seite frei
+    bool drain(StorageManagerIF& tcStore) {
+        TmTcMessage message;
+        if (queue->receiveMessage(&message) != returnvalue::OK) {
+            return false;
+        }
+        tcStore.deleteData(message.getStorageId());
+        return true;
+    }
+
+private:
+    // Platz für die größte Sequenz in BM_SendCommands
+    static constexpr uint32_t QUEUE_DEPTH = 32;
+    MessageQueueIF* queue;
+};
+
+// Macht prepareCommand() zugänglich, ohne den Dienst beim Verteiler anzumelden
+class CommandPreparation : public WebcamCommandingService {
+public:
+    CommandPreparation(object_id_t objectId, StorageManagerIF* store)
+        : WebcamCommandingService(objectId) {
+        ipcStore = store;
+    }
+    using WebcamCommandingService::prepareCommand;
+};
+
+void BM_SendCommand(benchmark::State& state) {
+    bench::MissionEnvironment& environment = bench::missionEnvironment();
+    static BenchmarkTcSink sink;
+    environment.distributor->registerService(&sink);
+    const std::vector<uint8_t> appData(static_cast<size_t>(state.range(0)), 0x5A);
+    for (auto _ : state) {
+        if (environment.distributor->sendCommand(static_cast<uint8_t>(Subservice::COMMAND_SET_FRAME_RATE),
+                                                 appData.data(), appData.size()) != returnvalue::OK ||
+            !sink.drain(*environment.tcStore)) {
+            state.SkipWithError("sendCommand failed");
+            break;
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// Sequenz aus Kommandos mit 8 Byte Nutzdaten, begrenzt durch die Seiten des TC-Stores
+void BM_SendCommands(benchmark::State& state) {
+    bench::MissionEnvironment& environment = bench::missionEnvironment();
+    static BenchmarkTcSink sink;
+    environment.distributor->registerService(&sink);
+    const double frameRate = 30.0;
+    const std::vector<webcam::StubPusDistributor::Telecommand> commands(
+        static_cast<size_t>(state.range(0)),
+        {static_cast<uint8_t>(Subservice::COMMAND_SET_FRAME_RATE),
+         reinterpret_cast<const uint8_t*>(&frameRate), sizeof(frameRate)});
+    for (auto _ : state) {
+        size_t queued = 0;
+        if (environment.distributor->sendCommands(commands.data(), commands.size(), &queued) !=
+            returnvalue::OK) {
+            state.SkipWithError("sendCommands failed");
+            break;
+        }
+        for (size_t index = 0; index < queued; index++) {
+            sink.drain(*environment.tcStore);
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * state.range(0));
+}
+
+void BM_PrepareDeviceCommand(benchmark::State& state) {
+    bench::MissionEnvironment& environment = bench::missionEnvironment();
+    static CommandPreparation service(bench::BENCHMARK_OBJECT_BASE + 0x10, environment.ipcStore);
+    const auto subservice = static_cast<Subservice>(state.range(0));
+    const double frameRate = 30.0;
+    const uint8_t* tcData = nullptr;
+    size_t tcDataLen = 0;
+    if (subservice == Subservice::COMMAND_SET_FRAME_RATE) {
+        tcData = reinterpret_cast<const uint8_t*>(&frameRate);
+        tcDataLen = sizeof(frameRate);
+    }
+    state.SetLabel(subservice == Subservice::COMMAND_SET_FRAME_RATE ? "set frame rate" : "get frame rate");
+    CommandMessage message;
+    uint32_t commandState = 0;
+    for (auto _ : state) {
+        if (service.prepareCommand(&message, static_cast<uint8_t>(subservice), tcData, tcDataLen,
+                                   &commandState, webcam::handlerObjectId(0)) != returnvalue::OK) {
+            state.SkipWithError("prepareCommand failed");
+            break;
+        }
+        // Die Parameter gehören sonst dem Handler, der sie nach dem Auslesen freigibt
+        store_address_t storeId;
+        storeId.raw = message.getParameter();
+        environment.ipcStore->deleteData(storeId);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+
+// CRC-16/CCITT-FALSE über das ganze Paket, wie von PUS verlangt
+uint16_t crc16(const uint8_t* data, size_t size) {
+    uint16_t crc = 0xFFFF;
+    for (size_t index = 0; index < size; index++) {
+        crc ^= static_cast<uint16_t>(data[index] << 8);
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) != 0 ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                                      : static_cast<uint16_t>(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// PUS-C TM des Webcam-Dienstes, von Hand gebaut: Primärkopf, Sekundärkopf mit CDS-Zeit,
+// Nutzdaten und CRC
+std::vector<uint8_t> makeTmPacket(size_t userDataLen) {
+    std::vector<uint8_t> packet;
+    const uint16_t apid = WebcamCommandingService::APID;
+    packet.push_back(static_cast<uint8_t>(0x08 | ((apid >> 8) & 0x07)));  // TM, Sekundärkopf
+    packet.push_back(static_cast<uint8_t>(apid & 0xFF));
+    packet.push_back(0xC0);  // unsegmentiert, Sequenzzähler 0
+    packet.push_back(0x00);
+    packet.push_back(0x00);  // Länge, unten eingetragen
+    packet.push_back(0x00);
+    packet.push_back(0x20);  // PUS-C
+    packet.push_back(WebcamCommandingService::SERVICE_ID);
+    packet.push_back(static_cast<uint8_t>(Subservice::TM_COMMAND_DATA_REPLY));
+    packet.insert(packet.end(), {0x00, 0x01, 0x00, 0x00});           // Nachrichtenzähler, Ziel
+    packet.insert(packet.end(), {0x40, 0x5A, 0x10, 0x01, 0x02, 0x03, 0x04});  // CDS short
+    for (size_t index = 0; index < userDataLen; index++) {
+        packet.push_back(static_cast<uint8_t>(index));
+    }
+    const size_t dataLength = packet.size() + 2 - 6 - 1;
+    packet[4] = static_cast<uint8_t>(dataLength >> 8);
+    packet[5] = static_cast<uint8_t>(dataLength & 0xFF);
+    const uint16_t crc = crc16(packet.data(), packet.size());
+    packet.push_back(static_cast<uint8_t>(crc >> 8));
+    packet.push_back(static_cast<uint8_t>(crc & 0xFF));
+    return packet;
+}
+
+// PUS-C TC an den Webcam-Dienst, wie ihn die Bodenstation schickt
+std::vector<uint8_t> makeTcPacket(uint16_t sequenceCount, size_t appDataLen) {
+    std::vector<uint8_t> packet;
+    const uint16_t apid = WebcamCommandingService::APID;
+    packet.push_back(static_cast<uint8_t>(0x18 | ((apid >> 8) & 0x07)));  // TC, Sekundärkopf
+    packet.push_back(static_cast<uint8_t>(apid & 0xFF));
+    packet.push_back(static_cast<uint8_t>(0xC0 | ((sequenceCount >> 8) & 0x3F)));
+    packet.push_back(static_cast<uint8_t>(sequenceCount & 0xFF));
+    packet.push_back(0x00);  // Länge, unten eingetragen
+    packet.push_back(0x00);
+    packet.push_back(0x2F);  // PUS-C, alle Bestätigungen
+    packet.push_back(WebcamCommandingService::SERVICE_ID);
+    packet.push_back(static_cast<uint8_t>(Subservice::COMMAND_SET_FRAME_RATE));
+    packet.insert(packet.end(), {0x00, 0x00});  // Quell-ID
+    for (size_t index = 0; index < appDataLen; index++) {
+        packet.push_back(static_cast<uint8_t>(index));
+    }
+    const size_t dataLength = packet.size() + 2 - 6 - 1;
+    packet[4] = static_cast<uint8_t>(dataLength >> 8);
+    packet[5] = static_cast<uint8_t>(dataLength & 0xFF);
+    const uint16_t crc = crc16(packet.data(), packet.size());
+    packet.push_back(static_cast<uint8_t>(crc >> 8));
+    packet.push_back(static_cast<uint8_t>(crc & 0xFF));
+    return packet;
+}
+
+// 16 TCs mit 8 Byte Nutzdaten als Bytestrom, in Stücken der angegebenen Größe
+void BM_IngestStream(benchmark::State& state) {
+    constexpr size_t PACKETS = 16;
+    bench::MissionEnvironment& environment = bench::missionEnvironment();
+    static BenchmarkTcSink sink;
+    environment.distributor->registerService(&sink);
+    std::vector<uint8_t> stream;
+    for (uint16_t count = 0; count < PACKETS; count++) {
+        const std::vector<uint8_t> packet = makeTcPacket(count, sizeof(double));
+        stream.insert(stream.end(), packet.begin(), packet.end());
+    }
+    const auto chunkSize = static_cast<size_t>(state.range(0));
+    const uint32_t routedBefore = environment.distributor->getStreamStatistics().routed;
+    for (auto _ : state) {
+        for (size_t offset = 0; offset < stream.size(); offset += chunkSize) {
+            environment.distributor->ingestStream(stream.data() + offset,
+                                                  std::min(chunkSize, stream.size() - offset));
+        }
+        while (sink.drain(*environment.tcStore)) {
+        }
+    }
+    const uint32_t routed = environment.distributor->getStreamStatistics().routed - routedBefore;
+    if (routed != state.iterations() * PACKETS) {
+        state.SkipWithError("not all TCs routed");
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * PACKETS));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * stream.size()));
+}
+
+void BM_FormatTmReport(benchmark::State& state) {
+    bench::MissionEnvironment& environment = bench::missionEnvironment();
+    const std::vector<uint8_t> packet = makeTmPacket(static_cast<size_t>(state.range(0)));
+    char line[webcam::StubTelemetrySink::REPORT_LINE_SIZE];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(webcam::StubTelemetrySink::formatReport(
+            environment.timeStamper, packet.data(), packet.size(), line, sizeof(line)));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(packet.size()));
+}
+
+// Kein PUS-Paket, die Senke gibt die ersten Bytes als Hex aus
+void BM_FormatRawReport(benchmark::State& state) {
+    const std::vector<uint8_t> packet(static_cast<size_t>(state.range(0)), 0xFF);
+    char line[webcam::StubTelemetrySink::REPORT_LINE_SIZE];
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(webcam::StubTelemetrySink::formatReport(
+            nullptr, packet.data(), packet.size(), line, sizeof(line)));
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(packet.size()));
+}
+
+}  // namespace
+
+BENCHMARK(BM_SendCommand)->ArgName("appData")->Arg(0)->Arg(8)->Arg(64)->Arg(200);
+BENCHMARK(BM_SendCommands)->ArgName("batch")->Arg(1)->Arg(8)->Arg(16);
+BENCHMARK(BM_IngestStream)->ArgName("chunk")->Arg(64)->Arg(1024);
+BENCHMARK(BM_PrepareDeviceCommand)
+    ->ArgName("subservice")
+    ->Arg(static_cast<int64_t>(Subservice::COMMAND_SET_FRAME_RATE))
+    ->Arg(static_cast<int64_t>(Subservice::COMMAND_GET_FRAME_RATE));
+BENCHMARK(BM_FormatTmReport)->ArgName("userData")->Arg(8)->Arg(64)->Arg(960);
+BENCHMARK(BM_FormatRawReport)->ArgName("size")->Arg(16)->Arg(256);
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <vector>
+
+#include "ColorConversion.h"
+#include "ParallelConversion.h"
+
+/*
+ * Vergleich der YUYV-Konvertierungen:
+ *  - jede SIMD-Variante muss bitgleich zur skalaren Q14-Variante sein
+ *  - Abweichung zur alten double-Variante aus webcam.cpp wird ausgegeben (max. 1)
+ *  - Durchsatz in Megapixel pro Sekunde, einzeln und mit dem Worker-Pool
+ *
+ * Aufruf: conversion_benchmark [iterationen] [worker]
+ */
+
+// Alte Referenz aus test/webcam.cpp, unverändert übernommen
+static void legacy_yuyv_to_rgb(const uint8_t* in, uint8_t* out, int w, int h) {
+    auto clamp = [](int x) { return static_cast<uint8_t>(std::min(255, std::max(0, x))); };
+    for (int i = 0; i < w * h; i += 2) {
+        int y0 = in[0], u = in[1] - 128, y1 = in[2], v = in[3] - 128;
+        auto conv = [&](int y, int& r, int& g, int& b) {
+            r = (int)(y + 1.402 * v);
+            g = (int)(y - 0.344136 * u - 0.714136 * v);
+            b = (int)(y + 1.772 * u);
+        };
+        int r,g,b;
+        conv(y0, r,g,b); out[0]=clamp(r); out[1]=clamp(g); out[2]=clamp(b);
+        conv(y1, r,g,b); out[3]=clamp(r); out[4]=clamp(g); out[5]=clamp(b);
+        in += 4; out += 6;
+    }
+}
+
+// Deterministisches Testbild: Verläufe plus Pseudozufall, deckt alle Bytewerte ab
+static std::vector<uint8_t> make_frame(uint32_t w, uint32_t h) {
+    std::vector<uint8_t> frame(imaging::yuyvSize(w, h));
+    uint32_t state = 0x12345678u;
+    for (size_t i = 0; i < frame.size(); ++i) {
+        state = state * 1664525u + 1013904223u;
+        frame[i] = (i % 7 == 0) ? static_cast<uint8_t>(i) : static_cast<uint8_t>(state >> 24);
+    }
+    return frame;
+}
+
+static double measure_mpix(const std::function<void()>& run, uint32_t w, uint32_t h, int iterations) {
+    run(); // warm up
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) run();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return (double)w * h * iterations / elapsed.count() / 1e6;
+}
+
+static size_t count_mismatches(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b, int& maxDiff) {
+    size_t mismatches = 0;
+    maxDiff = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        int diff = std::abs(int(a[i]) - int(b[i]));
+        if (diff) ++mismatches;
+        maxDiff = std::max(maxDiff, diff);
+    }
+    return mismatches;
+}
+
+int main(int argc, char** argv) {
+    const int iterations = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 50;
+    const imaging::Backend backends[] = {imaging::Backend::scalar, imaging::Backend::sse2,
+                                         imaging::Backend::avx2, imaging::Backend::neon};
+    const imaging::Backend detected = imaging::detectBackend();
+    const uint32_t sizes[][2] = {{640, 480}, {1920, 1080}, {3840, 2160}, {638, 6}}; // 638: Resteschleifen
+    bool ok = true;
+    const unsigned workerCount = (argc > 2) ? static_cast<unsigned>(std::atoi(argv[2]))
+                                            : imaging::ParallelConverter::defaultWorkerCount();
+    // Schwelle 0: der Pool läuft bei jeder Bildgröße, zum Nachmessen von DEFAULT_MIN_PARALLEL_PIXELS
+    imaging::ParallelConverter converter(workerCount, imaging::ParallelConverter::detectL2CacheSize(), 0);
+
+    std::cout << "=== conversion_benchmark ===\n"
+              << "detected_backend=" << imaging::backendToString(detected)
+              << " iterations=" << iterations << " workers=" << converter.getWorkerCount() << "+1"
+              << " l2=" << imaging::ParallelConverter::detectL2CacheSize() / 1024 << "KiB\n";
+
+    for (auto& size : sizes) {
+        const uint32_t W = size[0], H = size[1];
+        const std::vector<uint8_t> yuyv = make_frame(W, H);
+
+        std::vector<uint8_t> legacy(imaging::rgb24Size(W, H));
+        std::vector<uint8_t> refRgb(imaging::rgb24Size(W, H)), refY8(imaging::y8Size(W, H)),
+            refNv12(imaging::nv12Size(W, H));
+        std::vector<uint8_t> rgb(refRgb.size()), y8(refY8.size()), nv12(refNv12.size());
+
+        imaging::setBackend(imaging::Backend::scalar);
+        imaging::yuyvToRgb24(yuyv.data(), refRgb.data(), W, H);
+        imaging::yuyvToY8(yuyv.data(), refY8.data(), W, H);
+        imaging::yuyvToNv12(yuyv.data(), refNv12.data(), W, H);
+
+        int maxDiff = 0;
+        legacy_yuyv_to_rgb(yuyv.data(), legacy.data(), W, H);
+        size_t legacyMismatches = count_mismatches(refRgb, legacy, maxDiff);
+        std::printf("\n%ux%u legacy_diff: %zu bytes, max %d\n", W, H, legacyMismatches, maxDiff);
+        if (maxDiff > 1) ok = false;
+        std::printf("%-8s %10.1f MPix/s rgb24\n", "legacy",
+                    measure_mpix([&] { legacy_yuyv_to_rgb(yuyv.data(), legacy.data(), W, H); }, W, H, iterations));
+
+        for (imaging::Backend backend : backends) {
+            if (!imaging::setBackend(backend)) continue;
+            std::fill(rgb.begin(), rgb.end(), 0);
+            std::fill(y8.begin(), y8.end(), 0);
+            std::fill(nv12.begin(), nv12.end(), 0);
+            imaging::yuyvToRgb24(yuyv.data(), rgb.data(), W, H);
+            imaging::yuyvToY8(yuyv.data(), y8.data(), W, H);
+            imaging::yuyvToNv12(yuyv.data(), nv12.data(), W, H);
+
+            bool exact = rgb == refRgb && y8 == refY8 && nv12 == refNv12;
+            if (!exact) ok = false;
+
+            double rgbRate = measure_mpix([&] { imaging::yuyvToRgb24(yuyv.data(), rgb.data(), W, H); }, W, H, iterations);
+            double y8Rate = measure_mpix([&] { imaging::yuyvToY8(yuyv.data(), y8.data(), W, H); }, W, H, iterations);
+            double nv12Rate = measure_mpix([&] { imaging::yuyvToNv12(yuyv.data(), nv12.data(), W, H); }, W, H, iterations);
+            std::printf("%-8s %10.1f MPix/s rgb24 %10.1f y8 %10.1f nv12  %s\n",
+                        imaging::backendToString(backend), rgbRate, y8Rate, nv12Rate,
+                        exact ? "bit-exact" : "MISMATCH");
+        }
+
+        imaging::setBackend(detected);
+        bool exact = true;
+        converter.yuyvToRgb24(yuyv.data(), rgb.data(), W, H);
+        exact = exact && rgb == refRgb;
+        converter.yuyvToY8(yuyv.data(), y8.data(), W, H);
+        exact = exact && y8 == refY8;
+        converter.yuyvToNv12(yuyv.data(), nv12.data(), W, H);
+        exact = exact && nv12 == refNv12;
+        if (!exact) ok = false;
+        double rgbRate = measure_mpix([&] { converter.yuyvToRgb24(yuyv.data(), rgb.data(), W, H); }, W, H, iterations);
+        double y8Rate = measure_mpix([&] { converter.yuyvToY8(yuyv.data(), y8.data(), W, H); }, W, H, iterations);
+        double nv12Rate = measure_mpix([&] { converter.yuyvToNv12(yuyv.data(), nv12.data(), W, H); }, W, H, iterations);
+        std::printf("%-8s %10.1f MPix/s rgb24 %10.1f y8 %10.1f nv12  %s (band=%u rows)\n",
+                    "parallel", rgbRate, y8Rate, nv12Rate, exact ? "bit-exact" : "MISMATCH",
+                    converter.getBandRows(static_cast<size_t>(W) * 5));
+    }
+
+    imaging::setBackend(detected);
+    std::cout << "\nresult=" << (ok ? "OK" : "FAILED") << "\n";
+    return ok ? 0 : 1;
+}
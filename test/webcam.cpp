@@ -12,6 +12,11 @@
 #include <algorithm>
 #include <cstdint>
 
+#include "ColorConversion.h"
+#include "MjpegPassthrough.h"    // SOI/EOI prüfen, fehlende DHT ergänzen (ohne Dekodieren)
+#include "ParallelConversion.h" // YUYV -> RGB24 (SIMD + Worker-Pool, siehe mission/imaging)
+#include "SnapshotWriter.h"     // asynchrones Speichern (eigener Thread)
+
 /*
  * GPT5: AI generated
  *
@@ -44,23 +49,6 @@ static std::string fourcc_to_str(uint32_t f) {
     return std::string(s);
 }
 
-// YUYV (4:2:2) -> RGB24 (einfach, lesbar)
-static void yuyv_to_rgb(const uint8_t* in, uint8_t* out, int w, int h) {
-    auto clamp = [](int x) { return static_cast<uint8_t>(std::min(255, std::max(0, x))); };
-    for (int i = 0; i < w * h; i += 2) {
-        int y0 = in[0], u = in[1] - 128, y1 = in[2], v = in[3] - 128;
-        auto conv = [&](int y, int& r, int& g, int& b) {
-            r = (int)(y + 1.402 * v);
-            g = (int)(y - 0.344136 * u - 0.714136 * v);
-            b = (int)(y + 1.772 * u);
-        };
-        int r,g,b;
-        conv(y0, r,g,b); out[0]=clamp(r); out[1]=clamp(g); out[2]=clamp(b);
-        conv(y1, r,g,b); out[3]=clamp(r); out[4]=clamp(g); out[5]=clamp(b);
-        in += 4; out += 6;
-    }
-}
-
 // perror() + false
 static bool fail(const char* msg) { std::perror(msg); return false; }
 
@@ -145,6 +133,12 @@ bool shutdownWebcam(Webcam& cam) {
     return true;
 }
 
+// Schreib-Thread für Snapshots: die Platte hält den V4L2-Puffer nicht mehr fest
+static imaging::SnapshotWriter& snapshotWriter() {
+    static imaging::SnapshotWriter writer;
+    return writer;
+}
+
 // Ein Frame holen und speichern (JPEG direkt; YUYV -> PPM)
 bool takeSnapshot(Webcam& cam, const std::string& path) {
     std::cout << "\n=== takeSnapshot ===\n" << "path=" << path << "\n";
@@ -163,30 +157,44 @@ bool takeSnapshot(Webcam& cam, const std::string& path) {
               << " fourcc=" << fourcc_to_str(fourcc) << " size=" << W << "x" << H << "\n";
 
     bool ok = false;
+    const uint8_t* frame = static_cast<uint8_t*>(cam.bufs[buf.index].start);
 
-    // 2) speichern
+    // 2) in Schreibpuffer übernehmen (Kopie bzw. Konvertierung), Platte kommt später
     if (fourcc == V4L2_PIX_FMT_MJPEG || fourcc == V4L2_PIX_FMT_JPEG) {
-        if (FILE* f = std::fopen(path.c_str(), "wb")) {
-            std::fwrite(cam.bufs[buf.index].start, 1, buf.bytesused, f);
-            std::fclose(f);
-            std::cout << "wrote JPEG\n";
-            ok = true;
+        imaging::MjpegFrameInfo jpeg;
+        imaging::MjpegCheck check = imaging::inspectMjpeg(frame, buf.bytesused, jpeg);
+        if (check != imaging::MjpegCheck::ok) {
+            std::cerr << "corrupt MJPEG frame: " << imaging::mjpegCheckToString(check) << "\n";
+        } else if (jpeg.hasHuffmanTables) {
+            ok = snapshotWriter().submitCopy(path, frame, jpeg.length);
+        } else {
+            // UVC-Kameras lassen die Huffman-Tabellen oft weg -> Standardtabellen einfügen
+            imaging::SnapshotBuffer file = snapshotWriter().acquireBuffer(jpeg.completedSize());
+            if (file.isValid()) {
+                imaging::completeMjpeg(frame, jpeg, file.data());
+                ok = snapshotWriter().submit(path, std::move(file));
+            }
+            std::cout << "inserted standard DHT\n";
+        }
+        if (check == imaging::MjpegCheck::ok) {
+            std::cout << (ok ? "queued JPEG\n" : "writer queue full, JPEG dropped\n");
         }
     } else if (fourcc == V4L2_PIX_FMT_YUYV) {
-        std::vector<uint8_t> rgb(3 * W * H);
-        yuyv_to_rgb(static_cast<uint8_t*>(cam.bufs[buf.index].start), rgb.data(), W, H);
-        if (FILE* f = std::fopen(path.c_str(), "wb")) {
-            std::fprintf(f, "P6\n%d %d\n255\n", W, H);   // PPM-Header
-            std::fwrite(rgb.data(), 1, rgb.size(), f);   // RGB-Daten
-            std::fclose(f);
-            std::cout << "wrote PPM\n";
-            ok = true;
+        imaging::SnapshotBuffer rgb = snapshotWriter().acquireBuffer(imaging::rgb24Size(W, H));
+        if (rgb.isValid()) {
+            // Persistenter Pool: Threads werden nur beim ersten Snapshot erzeugt,
+            // bis 1080p konvertiert der Aufrufer allein (schneller als der Pool)
+            static imaging::ParallelConverter converter;
+            converter.yuyvToRgb24(frame, rgb.data(), W, H);
+            std::string header = "P6\n" + std::to_string(W) + " " + std::to_string(H) + "\n255\n"; // PPM-Header
+            ok = snapshotWriter().submit(path, std::move(rgb), std::move(header));
+            std::cout << (ok ? "queued PPM\n" : "writer queue full, PPM dropped\n");
         }
     } else {
         std::cerr << "unsupported FourCC\n";
     }
 
-    // 3) Puffer zurückgeben
+    // 3) Puffer sofort zurückgeben
     (void)ioctl(cam.fd, VIDIOC_QBUF, &buf);
     std::cout << "requeued index=" << buf.index << "\n";
     return ok;
@@ -231,5 +239,13 @@ int main(int argc, char** argv) {
 
     (void)takeSnapshot(cam, out);
     (void)shutdownWebcam(cam);
+
+    // Auf die Platte warten, bevor das Programm endet
+    snapshotWriter().flush();
+    auto stats = snapshotWriter().getStatistics();
+    std::cout << "\nwriter: written=" << stats.written << " failed=" << stats.failed
+              << " rejected=" << stats.rejected << " high_water=" << stats.highWaterMark
+              << " max_write_us=" << stats.maxWriteTimeUs
+              << " direct_io=" << (stats.directIo ? "yes" : "no") << "\n";
     return 0;
 }